@@ -6,6 +6,7 @@ file(
   include/solarus/containers/Grid.h
   include/solarus/containers/Quadtree.h
   include/solarus/containers/Quadtree.inl
+  include/solarus/containers/VectorPool.h
 
   include/solarus/entities/AnimatedTilePattern.h
   include/solarus/entities/Arrow.h
@@ -27,6 +28,7 @@ file(
   include/solarus/entities/Enemy.h
   include/solarus/entities/EnemyReaction.h
   include/solarus/entities/Entity.h
+  include/solarus/entities/EntityPerformanceStats.h
   include/solarus/entities/EntityPtr.h
   include/solarus/entities/EntityState.h
   include/solarus/entities/EntityType.h
@@ -34,6 +36,7 @@ file(
   include/solarus/entities/Explosion.h
   include/solarus/entities/Fire.h
   include/solarus/entities/Ground.h
+  include/solarus/entities/GroundBitmaps.h
   include/solarus/entities/GroundInfo.h
   include/solarus/entities/Hero.h
   include/solarus/entities/Hookshot.h
@@ -96,21 +99,28 @@ file(
   include/solarus/lowlevel/Color.h
   include/solarus/lowlevel/Debug.h
   include/solarus/lowlevel/FontResource.h
+  include/solarus/lowlevel/FrameStats.h
   include/solarus/lowlevel/Geometry.h
   include/solarus/lowlevel/Hq2xFilter.h
   include/solarus/lowlevel/Hq3xFilter.h
   include/solarus/lowlevel/Hq4xFilter.h
   include/solarus/lowlevel/InputEvent.h
+  include/solarus/lowlevel/InputRecorder.h
+  include/solarus/lowlevel/InputReplayer.h
   include/solarus/lowlevel/ItDecoder.h
+  include/solarus/lowlevel/MemoryStats.h
   include/solarus/lowlevel/Music.h
   include/solarus/lowlevel/PixelBits.h
   include/solarus/lowlevel/PixelFilter.h
   include/solarus/lowlevel/Point.h
   include/solarus/lowlevel/Point.inl
   include/solarus/lowlevel/Output.h
+  include/solarus/lowlevel/Profiler.h
   include/solarus/lowlevel/QuestFiles.h
   include/solarus/lowlevel/Random.h
   include/solarus/lowlevel/Rectangle.h
+  include/solarus/lowlevel/RenderCommandList.h
+  include/solarus/lowlevel/RenderThread.h
   include/solarus/lowlevel/Scale2xFilter.h
   include/solarus/lowlevel/shaders/GL_2DShader.h
   include/solarus/lowlevel/shaders/GL_ARBShader.h
@@ -133,17 +143,23 @@ file(
   include/solarus/lua/LuaContext.h
   include/solarus/lua/LuaData.h
   include/solarus/lua/LuaException.h
+  include/solarus/lua/LuaProfiler.h
   include/solarus/lua/LuaTools.h
   include/solarus/lua/LuaTools.inl
   include/solarus/lua/ScopedLuaRef.h
 
+  include/solarus/movements/AsyncPathFinding.h
   include/solarus/movements/CircleMovement.h
   include/solarus/movements/FallingHeight.h
   include/solarus/movements/FallingOnFloorMovement.h
+  include/solarus/movements/FlowField.h
   include/solarus/movements/JumpMovement.h
   include/solarus/movements/Movement.h
   include/solarus/movements/PathFinding.h
+  include/solarus/movements/PathFindingCache.h
+  include/solarus/movements/PathFindingGraph.h
   include/solarus/movements/PathFindingMovement.h
+  include/solarus/movements/PathFindingSnapshot.h
   include/solarus/movements/PathMovement.h
   include/solarus/movements/PixelMovement.h
   include/solarus/movements/PlayerMovement.h
@@ -230,10 +246,12 @@ file(
   src/entities/Enemy.cpp
   src/entities/EnemyReaction.cpp
   src/entities/Entity.cpp
+  src/entities/EntityPerformanceStats.cpp
   src/entities/EntityState.cpp
   src/entities/EntityTypeInfo.cpp
   src/entities/Explosion.cpp
   src/entities/Fire.cpp
+  src/entities/GroundBitmaps.cpp
   src/entities/GroundInfo.cpp
   src/entities/Hero.cpp
   src/entities/Hookshot.cpp
@@ -293,20 +311,27 @@ file(
   src/lowlevel/Color.cpp
   src/lowlevel/Debug.cpp
   src/lowlevel/FontResource.cpp
+  src/lowlevel/FrameStats.cpp
   src/lowlevel/Geometry.cpp
   src/lowlevel/Hq2xFilter.cpp
   src/lowlevel/Hq3xFilter.cpp
   src/lowlevel/Hq4xFilter.cpp
   src/lowlevel/InputEvent.cpp
+  src/lowlevel/InputRecorder.cpp
+  src/lowlevel/InputReplayer.cpp
   src/lowlevel/ItDecoder.cpp
+  src/lowlevel/MemoryStats.cpp
   src/lowlevel/Music.cpp
   src/lowlevel/Output.cpp
   src/lowlevel/PixelBits.cpp
   src/lowlevel/PixelFilter.cpp
   src/lowlevel/Point.cpp
+  src/lowlevel/Profiler.cpp
   src/lowlevel/QuestFiles.cpp
   src/lowlevel/Random.cpp
   src/lowlevel/Rectangle.cpp
+  src/lowlevel/RenderCommandList.cpp
+  src/lowlevel/RenderThread.cpp
   src/lowlevel/Scale2xFilter.cpp
   src/lowlevel/shaders/GL_2DShader.cpp
   src/lowlevel/shaders/GL_ARBShader.cpp
@@ -334,6 +359,7 @@ file(
   src/lua/LuaContext.cpp
   src/lua/LuaData.cpp
   src/lua/LuaException.cpp
+  src/lua/LuaProfiler.cpp
   src/lua/LuaTools.cpp
   src/lua/MainApi.cpp
   src/lua/MapApi.cpp
@@ -346,12 +372,17 @@ file(
   src/lua/TimerApi.cpp
   src/lua/VideoApi.cpp
 
+  src/movements/AsyncPathFinding.cpp
   src/movements/CircleMovement.cpp
   src/movements/FallingOnFloorMovement.cpp
+  src/movements/FlowField.cpp
   src/movements/JumpMovement.cpp
   src/movements/Movement.cpp
   src/movements/PathFinding.cpp
+  src/movements/PathFindingCache.cpp
+  src/movements/PathFindingGraph.cpp
   src/movements/PathFindingMovement.cpp
+  src/movements/PathFindingSnapshot.cpp
   src/movements/PathMovement.cpp
   src/movements/PixelMovement.cpp
   src/movements/PlayerMovement.cpp
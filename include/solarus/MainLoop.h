@@ -18,7 +18,9 @@
 #define SOLARUS_MAIN_LOOP_H
 
 #include "solarus/Common.h"
+#include "solarus/lowlevel/FrameStats.h"
 #include "solarus/lowlevel/SurfacePtr.h"
+#include <cstdint>
 #include <memory>
 
 namespace Solarus {
@@ -26,6 +28,8 @@ namespace Solarus {
 class Arguments;
 class Game;
 class InputEvent;
+class InputRecorder;
+class InputReplayer;
 class LuaContext;
 
 /**
@@ -42,6 +46,7 @@ class SOLARUS_API MainLoop {
 
     void run();
     void step();
+    void draw();
 
     void set_exiting();
     bool is_exiting();
@@ -51,13 +56,15 @@ class SOLARUS_API MainLoop {
     void set_game(Game* game);
 
     LuaContext& get_lua_context();
+    const FrameStats& get_frame_stats() const;
 
   private:
 
+    void run_turbo();
     void load_quest_properties();
     void check_input();
+    void replay_input();
     void notify_input(const InputEvent& event);
-    void draw();
     void update();
 
     std::unique_ptr<LuaContext>
@@ -66,6 +73,15 @@ class SOLARUS_API MainLoop {
     std::unique_ptr<Game> game;   /**< The current game if any, nullptr otherwise. */
     Game* next_game;              /**< The game to start at next cycle (nullptr means resetting the game). */
     bool exiting;                 /**< Indicates that the program is about to stop. */
+    uint32_t num_steps;           /**< Number of steps simulated so far. */
+    bool turbo;                   /**< Whether run() simulates as fast as possible. */
+    int turbo_draw_interval;      /**< In turbo mode, number of steps between two draws
+                                   * (0 means never). */
+    std::unique_ptr<InputRecorder>
+        input_recorder;           /**< Records input events if requested. */
+    std::unique_ptr<InputReplayer>
+        input_replayer;           /**< Replays recorded input events if requested. */
+    FrameStats frame_stats;       /**< Durations of the frames drawn by run(). */
 
 };
 
@@ -18,6 +18,8 @@
 #define SOLARUS_MAP_H
 
 #include "solarus/Common.h"
+#include "solarus/containers/VectorPool.h"
+#include "solarus/entities/EntityPtr.h"
 #include "solarus/entities/Ground.h"
 #include "solarus/entities/Layer.h"
 #include "solarus/lowlevel/Debug.h"
@@ -144,6 +146,13 @@ class SOLARUS_API Map: public ExportableToLua {
         const Point& point,
         Entity& entity_to_check
     ) const;
+    int get_obstacle_free_distance(
+        Layer layer,
+        const Rectangle& collision_box,
+        const Point& direction,
+        int max_distance,
+        Entity& entity_to_check
+    ) const;
     bool has_empty_ground(
         Layer layer,
         const Rectangle& collision_box
@@ -177,6 +186,17 @@ class SOLARUS_API Map: public ExportableToLua {
     void build_foreground_surface();
     void draw_background();
     void draw_foreground();
+    bool test_collision_with_terrain(
+        Layer layer,
+        const Rectangle& collision_box,
+        const Entity& entity_to_check
+    ) const;
+    bool test_collision_with_ground_bitmaps(
+        Layer layer,
+        const Rectangle& collision_box,
+        const Entity& entity_to_check,
+        bool& decided
+    ) const;
 
     static MapLoader map_loader;  /**< The map file parser. */
 
@@ -229,6 +249,12 @@ class SOLARUS_API Map: public ExportableToLua {
     std::unique_ptr<MapEntities>
         entities;                 /**< The entities on the map. */
     bool suspended;               /**< Whether the game is suspended. */
+
+    // collisions
+    VectorPool<EntityPtr>
+        entities_nearby_pool;     /**< Temporary lists of entities for collision checks. */
+    mutable VectorPool<Entity*>
+        obstacles_nearby_pool;    /**< Temporary lists of obstacles for collision tests. */
 };
 
 /**
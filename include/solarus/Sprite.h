@@ -21,11 +21,15 @@
 #include "solarus/Drawable.h"
 #include "solarus/SpritePtr.h"
 #include <map>
+#include <memory>
 #include <string>
+#include <tuple>
 
 namespace Solarus {
 
 class LuaContext;
+class PixelBits;
+class Rectangle;
 class Size;
 class SpriteAnimation;
 class SpriteAnimationSet;
@@ -51,6 +55,11 @@ class Sprite: public Drawable {
     // initialization
     static void initialize();
     static void quit();
+    static std::shared_ptr<const PixelBits> get_pixel_bits(
+        const std::string& image_id,
+        Surface& image,
+        const Rectangle& frame
+    );
 
     // creation and destruction
     explicit Sprite(const std::string& id);
@@ -128,6 +137,9 @@ class Sprite: public Drawable {
 
     // animation set
     static std::map<std::string, SpriteAnimationSet*> all_animation_sets;
+    static std::map<std::string, std::map<std::tuple<int, int, int, int>, std::shared_ptr<const PixelBits>>>
+        all_pixel_bits;                  /**< pixel collision masks of each frame of each image,
+                                          * shared by all animation sets using this image */
     const std::string animation_set_id;  /**< id of this sprite's animation set */
     SpriteAnimationSet& animation_set;   /**< animation set of this sprite */
 
@@ -21,6 +21,7 @@
 #include "solarus/lowlevel/Debug.h"
 #include "solarus/lowlevel/SurfacePtr.h"
 #include "solarus/SpriteAnimationDirection.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -59,6 +60,8 @@ class SpriteAnimation {
     void enable_pixel_collisions();
     bool are_pixel_collisions_enabled() const;
 
+    int64_t get_memory_size() const;
+
   private:
 
     void do_enable_pixel_collisions();
@@ -67,6 +70,7 @@ class SpriteAnimation {
     SurfacePtr src_image;         /**< image from which the frames are extracted;
                                    * this image is the same for
                                    * all directions of the sprite's animation */
+    std::string src_image_id;     /**< file name of the image relative to the data directory */
     const bool
         src_image_is_tileset;     /**< indicates that the image comes from the tileset */
     std::vector<SpriteAnimationDirection>
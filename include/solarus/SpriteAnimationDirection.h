@@ -21,6 +21,8 @@
 #include "solarus/lowlevel/PixelBits.h"
 #include "solarus/lowlevel/Rectangle.h"
 #include "solarus/lowlevel/Debug.h"
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace Solarus {
@@ -54,7 +56,7 @@ class SpriteAnimationDirection {
         int current_frame, Surface& src_image);
 
     // pixel collisions
-    void enable_pixel_collisions(Surface& src_image);
+    void enable_pixel_collisions(Surface& src_image, const std::string& src_image_id);
     void disable_pixel_collisions();
     bool are_pixel_collisions_enabled() const;
     const PixelBits& get_pixel_bits(int frame) const;
@@ -65,9 +67,10 @@ class SpriteAnimationDirection {
     Point origin;                       /**< coordinates of the sprite's origin from the
                                          * upper-left corner of its image. */
 
-    std::vector<PixelBits>
+    std::vector<std::shared_ptr<const PixelBits>>
         pixel_bits;                    /**< bit masks representing the non-transparent pixels of each frame,
-                                         * computed only if enable_pixel_collisions() is called */
+                                         * computed only if enable_pixel_collisions() is called
+                                         * and shared with other animations using the same image */
 };
 
 /**
@@ -94,7 +97,7 @@ inline const PixelBits& SpriteAnimationDirection::get_pixel_bits(int frame) cons
       "Pixel-precise collisions are not enabled for this sprite");
   SOLARUS_ASSERT(frame >= 0 && frame < get_nb_frames(), "Invalid frame number");
 
-  return pixel_bits[frame];
+  return *pixel_bits[frame];
 }
 
 }
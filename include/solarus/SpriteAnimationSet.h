@@ -20,6 +20,7 @@
 #include "solarus/Common.h"
 #include "solarus/lowlevel/Rectangle.h"
 #include "solarus/lowlevel/Size.h"
+#include <cstdint>
 #include <map>
 #include <string>
 
@@ -44,6 +45,7 @@ class SpriteAnimationSet {
   public:
 
     explicit SpriteAnimationSet(const std::string& id);
+    ~SpriteAnimationSet();
 
     void set_tileset(Tileset& tileset);
 
@@ -72,6 +74,7 @@ class SpriteAnimationSet {
     Rectangle max_bounding_box;              /**< Rectangle big enough to contain any frame.
                                               * Can be larger than max_size if
                                               * the origin changes. */
+    int64_t memory_size;                     /**< Bytes of the images of the animations. */
 
 };
 
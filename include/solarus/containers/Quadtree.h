@@ -22,9 +22,7 @@
 #include "solarus/lowlevel/Rectangle.h"
 #include "solarus/lowlevel/Size.h"
 #include "solarus/lowlevel/SurfacePtr.h"
-#include <array>
-#include <map>
-#include <memory>
+#include <cstdint>
 #include <vector>
 
 namespace Solarus {
@@ -37,7 +35,13 @@ class Color;
  * The main goal of this container is to get objects in a given rectangle as
  * quickly as possible.
  *
- * \param T Type of objects.
+ * Nodes are stored in a pool and reused after merges, and elements are
+ * found with an open-addressing hash table, so that moving elements does
+ * not allocate memory once the quadtree has grown.
+ * Queries never allocate and return each element only once, even if it
+ * overlaps several cells.
+ *
+ * \param T Type of objects. Must be hashable with std::hash.
  */
 template <typename T>
 class Quadtree {
@@ -61,6 +65,18 @@ class Quadtree {
         std::vector<T>& result
     ) const;
 
+    template<typename Function>
+    void for_each_element(
+        const Rectangle& where,
+        const Function& function
+    ) const;
+
+    template<typename Predicate>
+    bool any_element(
+        const Rectangle& where,
+        const Predicate& predicate
+    ) const;
+
     int get_num_elements() const;
 
     void draw(const SurfacePtr& dst_surface, const Point& dst_position);
@@ -80,65 +96,64 @@ class Quadtree {
 
   private:
 
-    class Node {
-
-      public:
-
-        Node();
-        explicit Node(const Rectangle& cell);
-
-        void clear();
-        void initialize(const Rectangle& cell);
-
-        Rectangle get_cell() const;
-        Size get_cell_size() const;
-
-        bool add(
-            const T& element,
-            const Rectangle& bounding_box
-        );
-        bool remove(
-            const T& element,
-            const Rectangle& bounding_box
-        );
-
-        void get_elements(
-            const Rectangle& region,
-            std::vector<T>& result
-        ) const;
-
-        int get_num_elements() const;
-
-        void draw(
-            const SurfacePtr& dst_surface, const Point& dst_position
-        );
-        void draw_rectangle(
-            const Rectangle& rectangle,
-            const Color& line_color,
-            const SurfacePtr& dst_surface,
-            const Point& dst_position
-        );
-
-      private:
-
-        bool is_split() const;
-        void split();
-        void merge();
-
-        std::vector<std::pair<T, Rectangle>> elements;
-        std::array<std::unique_ptr<Node>, 4> children;
-        Rectangle cell;
-        Point center;
-        Color color;
-
+    /**
+     * \brief A cell of the quadtree.
+     *
+     * Children of a node are 4 consecutive nodes of the pool.
+     */
+    struct Node {
+      Rectangle cell;                   /**< Rectangle covered by this node. */
+      int first_child = -1;             /**< Index of the first child in the pool,
+                                         * or -1 for a leaf. */
+      std::vector<int> elements;        /**< Elements overlapping this leaf,
+                                         * as indexes in element_infos. */
+      Color color;                      /**< Color of the cell for debugging. */
     };
 
+    /**
+     * \brief An element stored in the quadtree.
+     */
     struct ElementInfo {
-        Rectangle bounding_box;
+      T element;                        /**< The element. */
+      Rectangle bounding_box;           /**< Its bounding box. */
     };
 
-    std::map<T, ElementInfo> elements;
-    Node root;
+    static constexpr int empty_slot = -1;
+
+    // Element lookup.
+    int find_slot(const T& element) const;
+    int find_element(const T& element) const;
+    void insert_slot(int element_index);
+    void remove_slot(int slot);
+    void grow_element_table();
+    size_t get_home_slot(const T& element) const;
+
+    // Nodes.
+    void initialize_node(int node_index, const Rectangle& cell);
+    void add_to_node(int node_index, int element_index);
+    bool remove_from_node(int node_index, int element_index, const Rectangle& bounding_box);
+    int get_num_elements_in_node(int node_index) const;
+    void split_node(int node_index);
+    void merge_node(int node_index);
+    template<typename Predicate>
+    bool visit_node(int node_index, const Rectangle& region, const Predicate& predicate) const;
+    void draw_node(int node_index, const SurfacePtr& dst_surface, const Point& dst_position);
+    void draw_rectangle(
+        const Rectangle& rectangle,
+        const Color& line_color,
+        const SurfacePtr& dst_surface,
+        const Point& dst_position
+    );
+
+    std::vector<ElementInfo> element_infos;   /**< Storage of elements. */
+    std::vector<int> free_element_infos;      /**< Unused indexes in element_infos. */
+    std::vector<int> element_table;           /**< Open-addressing hash table of indexes
+                                               * in element_infos (linear probing). */
+    int element_table_shift;                  /**< 64 minus log2 of the table size. */
+    int num_elements;                         /**< Number of elements in the quadtree. */
+
+    std::vector<Node> nodes;                  /**< Pool of nodes. The root is the first one. */
+    std::vector<int> free_nodes;              /**< Unused groups of 4 children in the pool. */
 
 };
 
@@ -19,10 +19,13 @@
 #include "solarus/lowlevel/Random.h"
 #include "solarus/lowlevel/Surface.h"
 #include <algorithm>
-#include <set>
+#include <functional>
 
 namespace Solarus {
 
+template<typename T>
+constexpr int Quadtree<T>::empty_slot;
+
 /**
  * \brief Creates a quadtree with a default space size.
  *
@@ -40,20 +43,40 @@ Quadtree<T>::Quadtree() :
  */
 template<typename T>
 Quadtree<T>::Quadtree(const Rectangle& space) :
-    elements(),
-    root() {
+    element_infos(),
+    free_element_infos(),
+    element_table(16, empty_slot),
+    element_table_shift(64 - 4),
+    num_elements(0),
+    nodes(),
+    free_nodes() {
 
     initialize(space);
 }
 
 /**
  * \brief Removes all elements of the quadtree.
+ *
+ * Memory already allocated is kept for future elements.
  */
 template<typename T>
 void Quadtree<T>::clear() {
 
-  elements.clear();
-  root.clear();
+  element_infos.clear();
+  free_element_infos.clear();
+  std::fill(element_table.begin(), element_table.end(), empty_slot);
+  num_elements = 0;
+
+  // Give all children back to the pool.
+  if (nodes.empty()) {
+    nodes.resize(1);
+  }
+  const Rectangle space = nodes[0].cell;
+  free_nodes.clear();
+  for (int i = 1; i < static_cast<int>(nodes.size()); i += 4) {
+    free_nodes.push_back(i);
+  }
+  initialize_node(0, space);
 }
 
 /**
@@ -76,7 +99,7 @@ void Quadtree<T>::initialize(const Rectangle& space) {
     square.set_width(square.get_height());
   }
 
-  root.initialize(square);
+  initialize_node(0, square);
 }
 
 /**
@@ -85,28 +108,45 @@ void Quadtree<T>::initialize(const Rectangle& space) {
  */
 template<typename T>
 Rectangle Quadtree<T>::get_space() const {
-    return root.get_cell();
+    return nodes[0].cell;
 }
 
 /**
  * \brief Adds an element to the quadtree.
  * \param element The element to add.
  * \param bounding_box Bounding box of the element.
- * \return \c true in case of success.
+ * \return \c true in case of success, \c false if the element was already
+ * in the quadtree or is outside its space.
  */
 template<typename T>
 bool Quadtree<T>::add(const T& element, const Rectangle& bounding_box) {
 
-  if (elements.find(element) != elements.end()) {
+  if (find_element(element) != empty_slot) {
     // Element already in the quadtree.
     return false;
   }
 
-  ElementInfo info;
-  info.bounding_box = bounding_box;
-  elements.insert(std::make_pair(element, info));
+  if (!get_space().overlaps(bounding_box)) {
+    // Outside the space.
+    return false;
+  }
+
+  int element_index;
+  if (!free_element_infos.empty()) {
+    element_index = free_element_infos.back();
+    free_element_infos.pop_back();
+    element_infos[element_index].element = element;
+    element_infos[element_index].bounding_box = bounding_box;
+  }
+  else {
+    element_index = element_infos.size();
+    element_infos.push_back(ElementInfo{ element, bounding_box });
+  }
+  insert_slot(element_index);
+  ++num_elements;
 
-  return root.add(element, bounding_box);
+  add_to_node(0, element_index);
+  return true;
 }
 
 /**
@@ -117,15 +157,19 @@ bool Quadtree<T>::add(const T& element, const Rectangle& bounding_box) {
 template<typename T>
 bool Quadtree<T>::remove(const T& element) {
 
-  const auto& it = elements.find(element);
-  if (it == elements.end()) {
+  const int slot = find_slot(element);
+  const int element_index = element_table[slot];
+  if (element_index == empty_slot) {
     // Unknown element.
     return false;
   }
 
-  Rectangle box = it->second.bounding_box;
-  elements.erase(element);
-  return root.remove(element, box);
+  remove_from_node(0, element_index, element_infos[element_index].bounding_box);
+  remove_slot(slot);
+  element_infos[element_index].element = T();  // Release it now.
+  free_element_infos.push_back(element_index);
+  --num_elements;
+  return true;
 }
 
 /**
@@ -133,6 +177,8 @@ bool Quadtree<T>::remove(const T& element) {
  *
  * This function should be called when the position or size or the element
  * is changed.
+ * An element moved outside the space stays known by the quadtree but
+ * is not found by queries until it comes back.
  *
  * \param element The element to move.
  * \param bounding_box New bounding box of the element.
@@ -141,21 +187,22 @@ bool Quadtree<T>::remove(const T& element) {
 template<typename T>
 bool Quadtree<T>::move(const T& element, const Rectangle& bounding_box) {
 
-  const auto& it = elements.find(element);
-  if (it == elements.end()) {
+  const int element_index = find_element(element);
+  if (element_index == empty_slot) {
     // Entity not in the quadtree.
     return false;
   }
 
-  if (it->second.bounding_box == bounding_box) {
+  const Rectangle old_bounding_box = element_infos[element_index].bounding_box;
+  if (old_bounding_box == bounding_box) {
     // No change.
     return true;
   }
 
-  if (!remove(element)) {
-    return false;
-  }
-  return add(element, bounding_box);
+  remove_from_node(0, element_index, old_bounding_box);
+  element_infos[element_index].bounding_box = bounding_box;
+  add_to_node(0, element_index);
+  return get_space().overlaps(bounding_box);
 }
 
 /**
@@ -164,11 +211,14 @@ bool Quadtree<T>::move(const T& element, const Rectangle& bounding_box) {
  */
 template<typename T>
 int Quadtree<T>::get_num_elements() const {
-  return root.get_num_elements();
+  return num_elements;
 }
 
 /**
  * \brief Gets the elements intersecting the given rectangle.
+ *
+ * Each element is returned only once.
+ *
  * \param[in] region The rectangle to check.
  * \param[in/out] elements A list that will be filled with elements.
  */
@@ -177,7 +227,55 @@ void Quadtree<T>::get_elements(
     const Rectangle& region,
     std::vector<T>& elements
 ) const {
-  root.get_elements(region, elements);
+
+  for_each_element(region, [&elements](const T& element) {
+    elements.push_back(element);
+  });
+}
+
+/**
+ * \brief Calls a function on each element intersecting the given rectangle.
+ *
+ * Each element is visited only once. Nothing is allocated.
+ * The function must not modify the quadtree: if it may do so, get the
+ * elements with get_elements() first.
+ *
+ * \param region The rectangle to check.
+ * \param function Function to call with each element as parameter.
+ */
+template<typename T>
+template<typename Function>
+void Quadtree<T>::for_each_element(
+    const Rectangle& region,
+    const Function& function
+) const {
+
+  visit_node(0, region, [&function](const T& element) {
+    function(element);
+    return false;
+  });
+}
+
+/**
+ * \brief Returns whether a predicate is true for an element intersecting
+ * the given rectangle.
+ *
+ * Elements are visited until the predicate returns \c true.
+ * Each element is visited only once. Nothing is allocated.
+ * The predicate must not modify the quadtree.
+ *
+ * \param region The rectangle to check.
+ * \param predicate Function taking an element and returning a boolean.
+ * \return \c true if the predicate was true for an element.
+ */
+template<typename T>
+template<typename Predicate>
+bool Quadtree<T>::any_element(
+    const Rectangle& region,
+    const Predicate& predicate
+) const {
+
+  return visit_node(0, region, predicate);
 }
 
 /**
@@ -188,151 +286,209 @@ void Quadtree<T>::get_elements(
 template<typename T>
 void Quadtree<T>::draw(const SurfacePtr& dst_surface, const Point& dst_position) {
 
-  root.draw(dst_surface, dst_position);
+  draw_node(0, dst_surface, dst_position);
 }
 
 /**
- * \brief Creates a node with default coordinates.
+ * \brief Returns the preferred slot of an element in the hash table.
  *
- * Call initialize later to set coordinates.
+ * Uses Fibonacci hashing so that aligned pointers are well spread.
+ *
+ * \param element An element.
+ * \return Its slot if there is no collision.
  */
 template<typename T>
-Quadtree<T>::Node::Node() :
-    Node(Rectangle(0, 0, 256, 256)) {
+size_t Quadtree<T>::get_home_slot(const T& element) const {
 
+  const uint64_t hash = std::hash<T>()(element);
+  return static_cast<size_t>((hash * UINT64_C(0x9E3779B97F4A7C15)) >> element_table_shift);
 }
 
 /**
- * \brief Creates a node with the given coordinates.
- * \param cell Cell coordinates of the node.
+ * \brief Returns the slot of the hash table where an element is or would be.
+ * \param element An element.
+ * \return The slot containing this element, or the empty slot where it
+ * would be inserted.
  */
 template<typename T>
-Quadtree<T>::Node::Node(const Rectangle& cell) :
-    elements(),
-    children(),
-    cell(cell),
-    center(cell.get_center()),
-    color() {
-
-  initialize(cell);
+int Quadtree<T>::find_slot(const T& element) const {
 
-  if (debug_quadtrees) {
-    color = Color(Random::get_number(256), Random::get_number(256), Random::get_number(256));
+  const size_t mask = element_table.size() - 1;
+  size_t slot = get_home_slot(element);
+  while (element_table[slot] != empty_slot &&
+      !(element_infos[element_table[slot]].element == element)) {
+    slot = (slot + 1) & mask;
   }
+  return slot;
 }
 
 /**
- * \brief Clears this node.
- *
- * Children nodes and their content are destroyed.
+ * \brief Returns the index of an element in element_infos.
+ * \param element An element.
+ * \return Its index, or empty_slot if it is not in the quadtree.
  */
 template<typename T>
-void Quadtree<T>::Node::clear() {
+int Quadtree<T>::find_element(const T& element) const {
 
-  elements.clear();
-  children[0] = nullptr;
-  children[1] = nullptr;
-  children[2] = nullptr;
-  children[3] = nullptr;
+  return element_table[find_slot(element)];
 }
 
 /**
- * \brief Clears this node and initializes it with a new cell rectangle.
- * \param cell The new cell.
+ * \brief Inserts an element in the hash table.
+ * \param element_index Index of an element of element_infos not already
+ * in the table.
  */
 template<typename T>
-void Quadtree<T>::Node::initialize(const Rectangle& cell) {
+void Quadtree<T>::insert_slot(int element_index) {
 
-  clear();
-  this->cell = cell;
-  elements.reserve(max_in_cell);
+  // Keep the load factor below 1/2.
+  if ((num_elements + 1) * 2 > static_cast<int>(element_table.size())) {
+    grow_element_table();
+  }
+
+  const int slot = find_slot(element_infos[element_index].element);
+  element_table[slot] = element_index;
 }
 
 /**
- * \brief Returns the cell represented by this node.
- * \return The cell's rectangle.
+ * \brief Empties a slot of the hash table.
+ *
+ * Following elements are shifted back so that no tombstone is needed.
+ *
+ * \param slot The slot to empty.
  */
 template<typename T>
-Rectangle Quadtree<T>::Node::get_cell() const {
-  return cell;
+void Quadtree<T>::remove_slot(int slot) {
+
+  const size_t mask = element_table.size() - 1;
+  size_t hole = slot;
+  size_t current = slot;
+  while (true) {
+    current = (current + 1) & mask;
+    const int element_index = element_table[current];
+    if (element_index == empty_slot) {
+      break;
+    }
+    const size_t home = get_home_slot(element_infos[element_index].element);
+    // Move the element into the hole unless its home slot is
+    // cyclically between the hole and its current slot.
+    const bool can_move = (current > hole) ?
+        (home <= hole || home > current) :
+        (home <= hole && home > current);
+    if (can_move) {
+      element_table[hole] = element_index;
+      hole = current;
+    }
+  }
+  element_table[hole] = empty_slot;
 }
 
 /**
- * \brief Returns the size of the cell represented by this node.
- * \return The cell size.
+ * \brief Doubles the size of the hash table.
  */
 template<typename T>
-Size Quadtree<T>::Node::get_cell_size() const {
-    return get_cell().get_size();
+void Quadtree<T>::grow_element_table() {
+
+  std::vector<int> old_table(element_table.size() * 2, empty_slot);
+  old_table.swap(element_table);
+  --element_table_shift;
+
+  for (int element_index: old_table) {
+    if (element_index != empty_slot) {
+      element_table[find_slot(element_infos[element_index].element)] = element_index;
+    }
+  }
 }
 
 /**
- * \brief Adds an element to this node if its bounding box intersects it.
+ * \brief Makes a node an empty leaf covering the given cell.
+ * \param node_index Index of the node in the pool.
+ * \param cell The new cell.
+ */
+template<typename T>
+void Quadtree<T>::initialize_node(int node_index, const Rectangle& cell) {
+
+  Node& node = nodes[node_index];
+  node.cell = cell;
+  node.first_child = -1;
+  node.elements.clear();
+  node.elements.reserve(max_in_cell);
+
+  if (debug_quadtrees) {
+    node.color = Color(Random::get_number(256), Random::get_number(256), Random::get_number(256));
+  }
+}
+
+/**
+ * \brief Adds an element to a node if its bounding box intersects it.
  *
  * Splits the node if necessary when the threshold is exceeded.
  *
- * \param element The element to add.
- * \param bounding_box Bounding box of the element.
- * \return \c true in case of success.
+ * \param node_index Index of the node in the pool.
+ * \param element_index Index of the element in element_infos.
  */
 template<typename T>
-bool Quadtree<T>::Node::add(
-    const T& element,
-    const Rectangle& bounding_box
-) {
-  if (!get_cell().overlaps(bounding_box)) {
+void Quadtree<T>::add_to_node(int node_index, int element_index) {
+
+  const Rectangle& bounding_box = element_infos[element_index].bounding_box;
+  const Rectangle cell = nodes[node_index].cell;
+  if (!cell.overlaps(bounding_box)) {
     // Nothing to do.
-    return false;
+    return;
   }
 
-  if (!is_split()) {
+  if (nodes[node_index].first_child == -1) {
 
     // See if it is time to split.
-    if (get_cell().contains(bounding_box.get_center())) {
+    if (cell.contains(bounding_box.get_center())) {
       // We are the main cell of this element: it counts in the total.
-      if (get_num_elements() >= max_in_cell &&
-          get_cell_size().width > min_cell_size &&
-          get_cell_size().height > min_cell_size) {
-        split();
+      if (get_num_elements_in_node(node_index) >= max_in_cell &&
+          cell.get_width() > min_cell_size &&
+          cell.get_height() > min_cell_size) {
+        split_node(node_index);
       }
     }
   }
 
-  if (!is_split()) {
+  const int first_child = nodes[node_index].first_child;
+  if (first_child == -1) {
     // Add it to the current node.
-    elements.push_back(std::make_pair(element, bounding_box));
-    return true;
+    nodes[node_index].elements.push_back(element_index);
+    return;
   }
 
   // Add it to children cells.
-  for (const std::unique_ptr<Node>& child : children) {
-    child->add(element, bounding_box);
+  for (int i = 0; i < 4; ++i) {
+    add_to_node(first_child + i, element_index);
   }
-  return true;
 }
 
 /**
- * \brief Removes an element from this node if its bounding box intersects it.
+ * \brief Removes an element from a node if its bounding box intersects it.
  *
  * Merges nodes when necessary.
  *
- * \param element The element to remove.
- * \param bounding_box Bounding box of the element.
+ * \param node_index Index of the node in the pool.
+ * \param element_index Index of the element in element_infos.
+ * \param bounding_box Bounding box of the element when it was added.
  * \return \c true in the element was found and removed.
  */
 template<typename T>
-bool Quadtree<T>::Node::remove(
-    const T& element,
+bool Quadtree<T>::remove_from_node(
+    int node_index,
+    int element_index,
     const Rectangle& bounding_box
 ) {
-  if (!get_cell().overlaps(bounding_box)) {
+  if (!nodes[node_index].cell.overlaps(bounding_box)) {
     // Nothing to do.
     return false;
   }
 
-  if (!is_split()) {
+  const int first_child = nodes[node_index].first_child;
+  if (first_child == -1) {
     // Remove from this cell.
-    const auto& it = std::find(elements.begin(), elements.end(), std::make_pair(element, bounding_box));
+    std::vector<int>& elements = nodes[node_index].elements;
+    const auto& it = std::find(elements.begin(), elements.end(), element_index);
     if (it == elements.end()) {
       // The element was not here.
       return false;
@@ -343,179 +499,204 @@ bool Quadtree<T>::Node::remove(
 
   // Remove from children cells.
   bool removed = false;
-  for (const std::unique_ptr<Node>& child : children) {
-    removed |= child->remove(element, bounding_box);
+  for (int i = 0; i < 4; ++i) {
+    removed |= remove_from_node(first_child + i, element_index, bounding_box);
   }
 
   if (removed &&
-      !children[0]->is_split()  // We are the parent node of where the element was removed.
+      nodes[first_child].first_child == -1 &&  // We are the parent node of where the element was removed.
+      nodes[first_child + 1].first_child == -1 &&
+      nodes[first_child + 2].first_child == -1 &&
+      nodes[first_child + 3].first_child == -1
   ) {
     // See if it is time to merge.
-    int num_elements_in_children = get_num_elements();
-    if (num_elements_in_children < min_in_4_cells) {
-      merge();
+    if (get_num_elements_in_node(node_index) < min_in_4_cells) {
+      merge_node(node_index);
     }
   }
   return removed;
 }
 
 /**
- * \brief Returns whether this node is split or is a leaf cell.
- * \return \c true if the node is split.
+ * \brief Returns the number of elements whose center is under a node.
+ * \param node_index Index of the node in the pool.
+ * \return The number of elements under this node.
  */
 template<typename T>
-bool Quadtree<T>::Node::is_split() const {
+int Quadtree<T>::get_num_elements_in_node(int node_index) const {
 
-  return children[0] != nullptr;
+  const Node& node = nodes[node_index];
+  int num_elements_in_node = 0;
+  if (node.first_child == -1) {
+    // Some elements can overlap several cells.
+    // To avoid duplicates, we count an element if its center is in this cell.
+    for (int element_index: node.elements) {
+      const Rectangle& box = element_infos[element_index].bounding_box;
+      if (node.cell.contains(box.get_center())) {
+        ++num_elements_in_node;
+      }
+    }
+  }
+  else {
+    // Ask children.
+    for (int i = 0; i < 4; ++i) {
+      num_elements_in_node += get_num_elements_in_node(node.first_child + i);
+    }
+  }
+  return num_elements_in_node;
 }
 
 /**
- * \brief Splits this cell in four parts and moves its elements to them.
+ * \brief Splits a leaf in four parts and moves its elements to them.
+ * \param node_index Index of the node in the pool.
  */
 template<typename T>
-void Quadtree<T>::Node::split() {
+void Quadtree<T>::split_node(int node_index) {
+
+  Debug::check_assertion(nodes[node_index].first_child == -1, "Quadtree node already split");
 
-  Debug::check_assertion(!is_split(), "Quadtree node already split");
+  // Take 4 children cells from the pool.
+  int first_child;
+  if (!free_nodes.empty()) {
+    first_child = free_nodes.back();
+    free_nodes.pop_back();
+  }
+  else {
+    first_child = nodes.size();
+    nodes.resize(nodes.size() + 4);
+  }
 
-  // Create 4 children cells.
-  const Rectangle& cell = get_cell();
+  const Rectangle cell = nodes[node_index].cell;
   const Point& center = cell.get_center();
-  children[0] = std::unique_ptr<Node>(
-      new Node(Rectangle(cell.get_top_left(), center))
-  );
-  children[1] = std::unique_ptr<Node>(
-      new Node(Rectangle(Point(center.x, cell.get_top()), Point(cell.get_right(), center.y)))
-  );
-  children[2] = std::unique_ptr<Node>(
-      new Node(Rectangle(Point(cell.get_left(), center.y), Point(center.x, cell.get_bottom())))
-  );
-  children[3] = std::unique_ptr<Node>(
-      new Node(Rectangle(center, cell.get_bottom_right()))
-  );
+  initialize_node(first_child, Rectangle(cell.get_top_left(), center));
+  initialize_node(first_child + 1, Rectangle(Point(center.x, cell.get_top()), Point(cell.get_right(), center.y)));
+  initialize_node(first_child + 2, Rectangle(Point(cell.get_left(), center.y), Point(center.x, cell.get_bottom())));
+  initialize_node(first_child + 3, Rectangle(center, cell.get_bottom_right()));
 
   // Move existing elements into them.
-  for (const std::pair<T, Rectangle>& pair: elements) {
-    for (const std::unique_ptr<Node>& child : children) {
-      child->add(pair.first, pair.second);
+  // Children may split too and grow the pool, so don't keep references.
+  std::vector<int> elements;
+  elements.swap(nodes[node_index].elements);
+  nodes[node_index].first_child = first_child;
+  for (int element_index: elements) {
+    for (int i = 0; i < 4; ++i) {
+      add_to_node(first_child + i, element_index);
     }
   }
   elements.clear();
-
-  Debug::check_assertion(is_split(), "Quadtree node split failed");
+  nodes[node_index].elements.swap(elements);  // Keep the memory for later.
 }
 
 /**
- * \brief Merges the four children cell into this one and destroys them.
+ * \brief Merges the four children cells of a node into it and gives them
+ * back to the pool.
  *
  * The children must already be leaves.
+ *
+ * \param node_index Index of the node in the pool.
  */
 template<typename T>
-void Quadtree<T>::Node::merge() {
+void Quadtree<T>::merge_node(int node_index) {
 
-  Debug::check_assertion(is_split(), "Quadtree node already merged");
+  const int first_child = nodes[node_index].first_child;
+  Debug::check_assertion(first_child != -1, "Quadtree node already merged");
 
   // We want to avoid duplicates while preserving a deterministic order.
-  std::set<T> merged_elements;
-  for (const std::unique_ptr<Node>& child : children) {
-    Debug::check_assertion(!child->is_split(), "Quadtree node child is not a leaf");
-    for (const std::pair<T, Rectangle>& pair: child->elements) {
-      const T& element = pair.first;
-      if (merged_elements.insert(element).second) {
-        elements.push_back(pair);
+  std::vector<int>& elements = nodes[node_index].elements;
+  for (int i = 0; i < 4; ++i) {
+    Node& child = nodes[first_child + i];
+    Debug::check_assertion(child.first_child == -1, "Quadtree node child is not a leaf");
+    for (int element_index: child.elements) {
+      if (std::find(elements.begin(), elements.end(), element_index) == elements.end()) {
+        elements.push_back(element_index);
       }
     }
+    child.elements.clear();
   }
 
-  for (std::unique_ptr<Node>& child : children) {
-    child = nullptr;
-  }
-
-  Debug::check_assertion(!is_split(), "Quadtree node merge failed");
-}
-
-/**
- * \brief Returns the number of elements whose center is under this node.
- * \return The number of elements under this node.
- */
-template<typename T>
-int Quadtree<T>::Node::get_num_elements() const {
-
-  int num_elements = 0;
-  if (!is_split()) {
-    // Some elements can overlap several cells.
-    // To avoid duplicates, we count an element if its center is in this cell.
-    // TODO This information could be stored for better performance.
-    for (const std::pair<T, Rectangle>& pair: elements) {
-      const Rectangle& box = pair.second;
-      if (get_cell().contains(box.get_center())) {
-        ++num_elements;
-      }
-    }
-  }
-  else {
-    // Ask children.
-    for (const std::unique_ptr<Node>& child : children) {
-      num_elements += child->get_num_elements();
-    }
-  }
-  return num_elements;
+  nodes[node_index].first_child = -1;
+  free_nodes.push_back(first_child);
 }
 
 /**
- * \brief Gets the elements intersecting the given rectangle under this node.
- * \param[in] region The rectangle to check.
- * \param[in/out] result A list that will be filled with elements.
+ * \brief Visits the elements intersecting a region under a node.
+ *
+ * An element overlapping several leaves is only visited in the leaf that
+ * contains the top-left corner of its intersection with the region
+ * and the quadtree space, so that it is never visited twice.
+ *
+ * \param node_index Index of the node in the pool.
+ * \param region The rectangle to check.
+ * \param predicate Function called on each element. Returning \c true
+ * stops the visit.
+ * \return \c true if the predicate stopped the visit.
  */
 template<typename T>
-void Quadtree<T>::Node::get_elements(
+template<typename Predicate>
+bool Quadtree<T>::visit_node(
+    int node_index,
     const Rectangle& region,
-    std::vector<T>& result
+    const Predicate& predicate
 ) const {
 
-  if (!get_cell().overlaps(region)) {
+  const Node& node = nodes[node_index];
+  if (!node.cell.overlaps(region)) {
     // Nothing here.
-    return;
+    return false;
   }
 
-  if (!is_split()) {
-    for (const std::pair<T, Rectangle>& pair : elements) {
-      if (pair.second.overlaps(region)) {
-        result.push_back(pair.first);
+  if (node.first_child == -1) {
+    const Rectangle& space = nodes[0].cell;
+    for (int element_index: node.elements) {
+      const ElementInfo& info = element_infos[element_index];
+      const Rectangle& box = info.bounding_box;
+      if (!box.overlaps(region)) {
+        continue;
+      }
+      const int x = std::max(std::max(box.get_x(), region.get_x()), space.get_x());
+      const int y = std::max(std::max(box.get_y(), region.get_y()), space.get_y());
+      if (node.cell.contains(x, y) && predicate(info.element)) {
+        return true;
       }
     }
+    return false;
   }
-  else {
-    // Get from from children cells.
-    for (const std::unique_ptr<Node>& child : children) {
-      child->get_elements(region, result);
+
+  // Get from from children cells.
+  for (int i = 0; i < 4; ++i) {
+    if (visit_node(node.first_child + i, region, predicate)) {
+      return true;
     }
   }
+  return false;
 }
 
 /**
- * \brief Draws the node on a surface for debugging purposes.
+ * \brief Draws a node on a surface for debugging purposes.
+ * \param node_index Index of the node in the pool.
  * \param dst_surface The destination surface.
  * \param dst_position Where to draw on that surface.
  */
 template<typename T>
-void Quadtree<T>::Node::draw(const SurfacePtr& dst_surface, const Point& dst_position) {
+void Quadtree<T>::draw_node(int node_index, const SurfacePtr& dst_surface, const Point& dst_position) {
 
-  if (!is_split()) {
+  const Node& node = nodes[node_index];
+  if (node.first_child == -1) {
     // Draw the rectangle of the node.
-    draw_rectangle(get_cell(), color, dst_surface, dst_position);
+    draw_rectangle(node.cell, node.color, dst_surface, dst_position);
 
     // Draw bounding boxes of elements.
-    for (const std::pair<T, Rectangle>& pair: elements) {
-      const Rectangle& bounding_box = pair.second;
-      if (get_cell().contains(bounding_box.get_center())) {
-        draw_rectangle(bounding_box, color, dst_surface, dst_position);
+    for (int element_index: node.elements) {
+      const Rectangle& bounding_box = element_infos[element_index].bounding_box;
+      if (node.cell.contains(bounding_box.get_center())) {
+        draw_rectangle(bounding_box, node.color, dst_surface, dst_position);
       }
     }
   }
   else {
     // Draw children nodes.
-    for (const std::unique_ptr<Node>& child : children) {
-      child->draw(dst_surface, dst_position);
+    for (int i = 0; i < 4; ++i) {
+      draw_node(node.first_child + i, dst_surface, dst_position);
     }
   }
 }
@@ -528,7 +709,7 @@ void Quadtree<T>::Node::draw(const SurfacePtr& dst_surface, const Point& dst_pos
  * \param dst_position Where to draw on that surface.
  */
 template<typename T>
-void Quadtree<T>::Node::draw_rectangle(
+void Quadtree<T>::draw_rectangle(
     const Rectangle& rectangle,
     const Color& line_color,
     const SurfacePtr& dst_surface,
@@ -553,3 +734,4 @@ void Quadtree<T>::Node::draw_rectangle(
 }
 
 }  // namespace Solarus
+
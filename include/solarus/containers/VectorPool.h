@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_VECTOR_POOL_H
+#define SOLARUS_VECTOR_POOL_H
+
+#include "solarus/Common.h"
+#include <utility>
+#include <vector>
+
+namespace Solarus {
+
+/**
+ * \brief Vectors kept to be reused as temporary lists without allocating
+ * memory each time.
+ *
+ * Borrow a vector with a VectorPool::Borrowed object: the vector is given
+ * back empty to the pool when this object is destroyed.
+ * Nested borrows, like in reentrant calls, get different vectors.
+ * This class is not thread-safe.
+ */
+template <typename T>
+class VectorPool {
+
+  public:
+
+    /**
+     * \brief A vector taken from the pool during the lifetime of this object.
+     */
+    class Borrowed {
+
+      public:
+
+        explicit Borrowed(VectorPool& pool);
+        ~Borrowed();
+
+        Borrowed(const Borrowed& other) = delete;
+        Borrowed& operator=(const Borrowed& other) = delete;
+
+        std::vector<T>& get();
+
+      private:
+
+        VectorPool& pool;           /**< The pool to give the vector back to. */
+        std::vector<T> vector;      /**< The vector borrowed. */
+
+    };
+
+  private:
+
+    std::vector<std::vector<T>> free_vectors;   /**< Empty vectors available. */
+
+};
+
+/**
+ * \brief Takes a vector from the pool, or a new one if the pool is empty.
+ * \param pool The pool.
+ */
+template <typename T>
+VectorPool<T>::Borrowed::Borrowed(VectorPool& pool):
+    pool(pool),
+    vector() {
+
+  if (!pool.free_vectors.empty()) {
+    vector.swap(pool.free_vectors.back());
+    pool.free_vectors.pop_back();
+  }
+}
+
+/**
+ * \brief Gives the vector back to the pool.
+ */
+template <typename T>
+VectorPool<T>::Borrowed::~Borrowed() {
+
+  vector.clear();
+  pool.free_vectors.push_back(std::move(vector));
+}
+
+/**
+ * \brief Returns the vector borrowed.
+ * \return The vector, empty when it was borrowed.
+ */
+template <typename T>
+std::vector<T>& VectorPool<T>::Borrowed::get() {
+  return vector;
+}
+
+}
+
+#endif
+
@@ -19,8 +19,12 @@
 
 #include "solarus/Common.h"
 #include "solarus/entities/Detector.h"
+#include "solarus/entities/EntityPtr.h"
+#include "solarus/entities/EntityType.h"
 #include "solarus/lua/ScopedLuaRef.h"
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -71,6 +75,7 @@ class SOLARUS_API CustomEntity: public Detector {
     void set_traversable_by_entities(EntityType type, bool traversable);
     void set_traversable_by_entities(EntityType type, const ScopedLuaRef& traversable_test_ref);
     void reset_traversable_by_entities(EntityType type);
+    bool has_traversable_by_entities_rules() const;
 
     bool can_be_obstacle() const override;
     bool is_obstacle_for(Entity& other) override;
@@ -85,6 +90,7 @@ class SOLARUS_API CustomEntity: public Detector {
         const ScopedLuaRef& traversable_test_ref
     );
     void reset_can_traverse_entities(EntityType type);
+    bool has_can_traverse_entities_rules() const;
 
     bool is_hero_obstacle(Hero& hero) override;
     bool is_block_obstacle(Block& block) override;
@@ -114,6 +120,28 @@ class SOLARUS_API CustomEntity: public Detector {
     bool is_ladder_obstacle() const override;
 
     // Collisions.
+
+    /**
+     * \brief A collision test evaluated without calling Lua.
+     *
+     * All conditions that are set must be satisfied.
+     */
+    struct CollisionPredicate {
+
+      CollisionPredicate();
+
+      int radius;                        /**< Maximum distance between both
+                                          * centers in pixels, or -1. */
+      double facing_cone;                /**< Aperture in radians of a cone
+                                          * centered on the direction of this
+                                          * entity, or -1. */
+      std::set<EntityType> entity_types; /**< Types of entities accepted
+                                          * (empty means all). */
+      std::set<Layer> layers;            /**< Layers accepted (empty means all). */
+      bool batched;                      /**< Call the callback once per cycle
+                                          * with all entities detected. */
+    };
+
     void add_collision_test(
         CollisionMode collision_test,
         const ScopedLuaRef& callback_ref
@@ -122,8 +150,14 @@ class SOLARUS_API CustomEntity: public Detector {
         const ScopedLuaRef& collision_test_ref,
         const ScopedLuaRef& callback_ref
     );
+    void add_collision_test(
+        const CollisionPredicate& predicate,
+        const ScopedLuaRef& callback_ref
+    );
     void clear_collision_tests();
 
+    Rectangle get_max_bounding_box() const override;
+
     bool test_collision_custom(Entity& entity) override;
     void notify_collision(
         Entity& entity_overlapping, CollisionMode collision_mode) override;
@@ -219,9 +253,16 @@ class SOLARUS_API CustomEntity: public Detector {
             const ScopedLuaRef& custom_test_ref,
             const ScopedLuaRef& callback_ref
         );
+        CollisionInfo(
+            LuaContext& lua_context,
+            const CollisionPredicate& predicate,
+            const ScopedLuaRef& callback_ref
+        );
 
         CollisionMode get_built_in_test() const;
         const ScopedLuaRef& get_custom_test_ref() const;
+        bool has_predicate() const;
+        const CollisionPredicate& get_predicate() const;
         const ScopedLuaRef& get_callback_ref() const;
 
       private:
@@ -232,14 +273,34 @@ class SOLARUS_API CustomEntity: public Detector {
                                           * or COLLISION_CUSTOM. */
         ScopedLuaRef custom_test_ref;    /**< Ref to a custom collision test
                                           * or LUA_REFNIL. */
+        bool native;                     /**< Whether the custom collision test
+                                          * is the predicate. */
+        CollisionPredicate predicate;    /**< Native custom collision test. */
         ScopedLuaRef callback_ref;       /**< Ref to the function to called when
                                           * a collision is detected. */
 
     };
 
     const TraversableInfo& get_traversable_by_entity_info(EntityType type);
+    void notify_traversable_by_entities_changed();
     const TraversableInfo& get_can_traverse_entity_info(EntityType type);
 
+    /**
+     * \brief Entities detected by a batched collision test
+     * since its callback was last called.
+     */
+    struct BatchedCollisions {
+      std::shared_ptr<const std::vector<CollisionInfo>>
+          collision_tests;               /**< Tests containing the batched one. */
+      const CollisionInfo* info;         /**< The batched test. */
+      std::vector<EntityPtr> entities;   /**< Entities detected. */
+    };
+
+    void set_collision_tests(const std::vector<CollisionInfo>& collision_tests);
+    bool test_collision_predicate(const CollisionPredicate& predicate, Entity& entity) const;
+    void add_batched_collision(const CollisionInfo& info, Entity& entity);
+    void notify_batched_collisions();
+
     void notify_collision_from(Entity& other_entity);
     void notify_collision_from(Entity& other_entity, Sprite& other_sprite, Sprite& this_sprite);
 
@@ -260,12 +321,20 @@ class SOLARUS_API CustomEntity: public Detector {
 
     // Collisions.
 
-    std::vector<CollisionInfo>
-        collision_tests;               /**< The collision tests to perform. */
-    std::vector<CollisionInfo>
+    std::shared_ptr<const std::vector<CollisionInfo>>
+        collision_tests;               /**< The collision tests to perform.
+                                        * Replaced rather than modified so that
+                                        * tests running keep a valid copy. */
+    std::shared_ptr<const std::vector<CollisionInfo>>
+        successful_collision_tests_owner;  /**< Tests containing the successful ones. */
+    std::vector<const CollisionInfo*>
         successful_collision_tests;    /**< Collision test that detected
                                         * collisions other than
                                         * COLLISION_SPRITE. */
+    std::vector<BatchedCollisions>
+        batched_collisions;            /**< Pending callbacks of batched tests. */
+    int collision_radius;              /**< Largest radius of native tests,
+                                        * or -1. */
 
     bool ground_observer;              /**< Whether this custom entity is a ground observer. */
     bool ground_modifier;              /**< Whether this custom entity is a ground modifier. */
@@ -51,6 +51,7 @@ class Detector: public Entity {
     virtual void notify_layer_changed() override;
 
     // general collision checking functions
+    int get_collision_modes() const;
     void check_collision(Entity& entity);
     void check_collision(Entity& entity, Sprite& sprite);
 
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_ENTITY_PERFORMANCE_STATS_H
+#define SOLARUS_ENTITY_PERFORMANCE_STATS_H
+
+#include "solarus/Common.h"
+#include "solarus/entities/EntityType.h"
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace Solarus {
+
+class Entity;
+
+/**
+ * \brief Time spent updating and drawing the entities of a map.
+ *
+ * Durations are accumulated in microseconds per entity type and per
+ * named entity, including the Lua callbacks called during the update
+ * or the drawing.
+ * Nothing is measured unless the stats are enabled.
+ */
+class SOLARUS_API EntityPerformanceStats {
+
+  public:
+
+    /**
+     * \brief Time spent by some entities.
+     */
+    struct Cost {
+      uint64_t update_time = 0;   /**< Time spent in updates in microseconds. */
+      uint64_t draw_time = 0;     /**< Time spent in drawings in microseconds. */
+    };
+
+    EntityPerformanceStats();
+
+    bool is_enabled() const;
+    void set_enabled(bool enabled);
+    void clear();
+
+    void add_update_frame();
+    void add_draw_frame();
+    void add_update_time(const Entity& entity, uint64_t duration);
+    void add_draw_time(const Entity& entity, uint64_t duration);
+
+    int get_num_update_frames() const;
+    int get_num_draw_frames() const;
+    const std::map<EntityType, Cost>& get_type_costs() const;
+    const std::map<std::string, Cost>& get_entity_costs() const;
+
+  private:
+
+    bool enabled;                                 /**< Whether durations are measured. */
+    int num_update_frames;                        /**< Number of times entities were updated. */
+    int num_draw_frames;                          /**< Number of times entities were drawn. */
+    std::map<EntityType, Cost> type_costs;        /**< Time spent by each type of entity. */
+    std::map<std::string, Cost> entity_costs;     /**< Time spent by each named entity. */
+
+};
+
+}
+
+#endif
+
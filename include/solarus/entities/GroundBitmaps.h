@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_GROUND_BITMAPS_H
+#define SOLARUS_GROUND_BITMAPS_H
+
+#include "solarus/Common.h"
+#include "solarus/entities/Ground.h"
+#include <cstdint>
+#include <vector>
+
+namespace Solarus {
+
+/**
+ * \brief Bit-packed representation of the tile grounds of a map layer.
+ *
+ * For each ground that may be an obstacle, stores one bit per 8x8 square
+ * of the map telling if that square has this ground.
+ * Bits are packed in 64-bit words twice: row by row and column by column.
+ * This allows to know the grounds present under a whole horizontal or
+ * vertical segment of the map with a few word operations.
+ *
+ * Grounds that are never obstacles (empty, traversable, grass and ice)
+ * are not stored.
+ * The bitmap of a ground is only allocated when a square gets this ground.
+ */
+class GroundBitmaps {
+
+  public:
+
+    GroundBitmaps();
+
+    void initialize(int width8, int height8);
+
+    void set_ground(int x8, int y8, Ground old_ground, Ground new_ground);
+    uint32_t get_grounds_in_row(int y8, int x8_min, int x8_max) const;
+    uint32_t get_grounds_in_column(int x8, int y8_min, int y8_max) const;
+
+    static bool is_tracked(Ground ground);
+    static uint32_t get_ground_bit(Ground ground);
+
+  private:
+
+    static constexpr int num_grounds = static_cast<int>(Ground::LAVA) + 1;
+
+    static void set_bit(std::vector<uint64_t>& bits, int index, bool value);
+    static bool test_bits(
+        const std::vector<uint64_t>& bits,
+        int first_index,
+        int last_index
+    );
+
+    int width8;                             /**< Number of 8x8 squares on a row. */
+    int height8;                            /**< Number of 8x8 squares on a column. */
+    int words_per_row;                      /**< Number of 64-bit words storing a row. */
+    int words_per_column;                   /**< Number of 64-bit words storing a column. */
+    uint32_t allocated_grounds;             /**< Bits of grounds whose bitmaps are allocated. */
+    std::vector<uint64_t>
+        row_bits[num_grounds];              /**< For each ground, one bit per square, row by row. */
+    std::vector<uint64_t>
+        column_bits[num_grounds];           /**< For each ground, one bit per square, column by column. */
+
+};
+
+}
+
+#endif
+
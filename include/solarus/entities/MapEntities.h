@@ -19,11 +19,16 @@
 
 #include "solarus/Common.h"
 #include "solarus/containers/Quadtree.h"
+#include "solarus/entities/EntityPerformanceStats.h"
 #include "solarus/entities/EntityPtr.h"
 #include "solarus/entities/EntityType.h"
 #include "solarus/entities/Ground.h"
+#include "solarus/entities/GroundBitmaps.h"
 #include "solarus/entities/Layer.h"
 #include "solarus/entities/TilePtr.h"
+#include "solarus/movements/FlowField.h"
+#include "solarus/movements/PathFindingCache.h"
+#include "solarus/movements/PathFindingGraph.h"
 #include "solarus/Transition.h"
 #include <list>
 #include <map>
@@ -43,6 +48,7 @@ class NonAnimatedRegions;
 class Rectangle;
 class Separator;
 class Stairs;
+class TextSurface;
 
 using EntityTree = Quadtree<EntityPtr>;
 
@@ -64,8 +70,12 @@ class SOLARUS_API MapEntities {
     // get entities
     Hero& get_hero();
     Ground get_tile_ground(Layer layer, int x, int y) const;
+    const GroundBitmaps& get_tile_ground_bitmaps(Layer layer) const;
     const std::list<EntityPtr>& get_entities();
     const std::list<Entity*>& get_obstacle_entities(Layer layer);
+    void get_obstacle_entities_in_rectangle(
+        Layer layer, const Rectangle& rectangle, std::vector<Entity*>& result
+    ) const;
     const std::list<Entity*>& get_ground_observers(Layer layer);
     const std::list<Entity*>& get_ground_modifiers(Layer layer);
     const std::list<Detector*>& get_detectors();
@@ -81,6 +91,9 @@ class SOLARUS_API MapEntities {
     bool has_entity_with_prefix(const std::string& prefix) const;
 
     void get_entities_in_rectangle(const Rectangle& rectangle, std::vector<EntityPtr>& result) const;
+    void get_detectors_in_rectangle(
+        const Rectangle& rectangle, bool sprite_collisions, std::vector<EntityPtr>& result
+    ) const;
 
     // handle entities
     void add_entity(const EntityPtr& entity);
@@ -95,6 +108,15 @@ class SOLARUS_API MapEntities {
     void notify_entity_bounding_box_changed(Entity& entity);
     void notify_entity_ground_observer_changed(Entity& entity);
     void notify_entity_ground_modifier_changed(Entity& entity);
+    void notify_entity_obstacle_changed(Entity& entity);
+    void notify_detector_collision_modes_changed(Detector& detector);
+
+    // path finding
+    PathFindingGraph& get_path_finding_graph(Layer layer, uint32_t obstacle_grounds);
+    FlowField& get_flow_field(const Entity& target, uint32_t obstacle_grounds);
+    uint32_t get_terrain_version() const;
+    uint32_t get_obstacle_version(Layer layer, const Rectangle& area) const;
+    PathFindingCache& get_path_finding_cache();
 
     // specific to some entity types
     bool overlaps_raised_blocks(Layer layer, const Rectangle& rectangle);
@@ -113,6 +135,11 @@ class SOLARUS_API MapEntities {
     void update();
     void draw();
 
+    // performance measures
+    EntityPerformanceStats& get_performance_stats();
+    bool is_performance_overlay_enabled() const;
+    void set_performance_overlay_enabled(bool enabled);
+
   private:
 
     friend class MapLoader;            /**< the map loader initializes the private fields of MapEntities */
@@ -122,6 +149,21 @@ class SOLARUS_API MapEntities {
     void remove_marked_entities();
     void notify_entity_removed(Entity* entity);
     void update_crystal_blocks();
+    void add_drawn_in_y_order(Entity& entity, Layer layer);
+    void remove_drawn_in_y_order(Entity& entity, Layer layer);
+    void sort_drawn_in_y_order(Layer layer);
+    void add_to_detector_trees(const EntityPtr& entity);
+    void add_obstacle(Entity& entity);
+    void remove_obstacle(Entity& entity);
+    void notify_path_finding_ground_changed(Layer layer, const Rectangle& area);
+    void notify_path_finding_ground_modifier_changed(
+        Entity& entity, Layer layer, bool present
+    );
+    void notify_path_finding_obstacle_changed(const Entity& entity, const Rectangle& cells);
+    void notify_path_finding_cells_changed(Layer layer, const Rectangle& cells);
+    void update_entity(Entity& entity);
+    void draw_entity(Entity& entity);
+    void draw_performance_overlay();
 
     // map
     Game& game;                                     /**< the game running this map */
@@ -134,6 +176,8 @@ class SOLARUS_API MapEntities {
                                                      * (tiles_grid_size = map_width8 * map_height8) */
     std::vector<Ground> tiles_ground[LAYER_NB];     /**< array of size tiles_grid_size representing the ground property
                                                      * of each 8x8 square. */
+    GroundBitmaps tiles_ground_bitmaps[LAYER_NB];   /**< the same grounds packed as bits to test
+                                                     * whole rows or columns of squares at once */
     std::unique_ptr<NonAnimatedRegions>
         non_animated_regions[LAYER_NB];             /**< All non-animated tiles are managed here for performance. */
     std::vector<TilePtr>
@@ -155,14 +199,20 @@ class SOLARUS_API MapEntities {
     std::list<Entity*>
       entities_drawn_first[LAYER_NB];               /**< all map entities that are drawn in the normal order */
 
-    std::list<Entity*>
+    std::vector<Entity*>
       entities_drawn_y_order[LAYER_NB];             /**< all map entities that are drawn in the order
                                                      * defined by their y position, including the hero */
+    bool y_order_changed[LAYER_NB];                 /**< whether entities drawn in y order may need
+                                                     * to be sorted again on each layer */
 
     std::list<Detector*> detectors;                 /**< all entities able to detect other entities
                                                      * on this map.
                                                      * TODO store them by layer like obstacle_entities
                                                      * but take care of has_layer_independent_collisions() */
+    EntityTree simple_detector_tree;                /**< detectors with collision modes other than
+                                                     * COLLISION_SPRITE, indexed by max bounding box */
+    EntityTree sprite_detector_tree;                /**< detectors with COLLISION_SPRITE,
+                                                     * indexed by max bounding box */
     std::list<Entity*>
       ground_observers[LAYER_NB];                   /**< all dynamic entities sensible to the ground
                                                      * below them */
@@ -174,6 +224,9 @@ class SOLARUS_API MapEntities {
     std::list<Entity*>
       obstacle_entities[LAYER_NB];                  /**< all entities that might be obstacle for other
                                                      * entities on this map, including the hero */
+    Quadtree<Entity*>
+      obstacle_trees[LAYER_NB];                     /**< the same obstacle entities indexed by their
+                                                     * bounding box for fast collision tests */
 
     std::list<Stairs*> stairs[LAYER_NB];            /**< all stairs of the map */
     std::list<CrystalBlock*>
@@ -182,6 +235,36 @@ class SOLARUS_API MapEntities {
 
     Boomerang* boomerang;                           /**< the boomerang if present on the map, nullptr otherwise */
 
+    // path finding
+    std::vector<std::unique_ptr<PathFindingGraph>>
+      path_finding_graphs[LAYER_NB];                /**< abstract graphs for long paths, created on demand
+                                                     * for each set of obstacle grounds */
+    std::vector<std::unique_ptr<FlowField>>
+      flow_fields;                                  /**< directions to entities chased by several others,
+                                                     * created on demand */
+    uint32_t terrain_version;                       /**< incremented each time the ground of the map changes */
+    static constexpr int
+      obstacle_region_size8 = 8;                    /**< size in 8x8 squares of the regions whose obstacle
+                                                     * changes are tracked */
+    uint32_t obstacle_change_date;                  /**< incremented each time the ground or an obstacle
+                                                     * entity changes */
+    std::vector<uint32_t>
+      obstacle_versions[LAYER_NB];                  /**< value of obstacle_change_date when each region
+                                                     * of each layer last changed */
+    std::map<const Entity*, Rectangle>
+      obstacle_cells;                               /**< 8x8 squares overlapped by each obstacle entity
+                                                     * (an obstacle moving inside them changes no path) */
+    std::map<const Entity*, Rectangle>
+      ground_modifier_cells;                        /**< 8x8 squares overlapped by each ground modifier
+                                                     * (the path finding terrain is only updated when they change) */
+    PathFindingCache path_finding_cache;            /**< paths searched recently */
+
+    // performance measures
+    EntityPerformanceStats performance_stats;       /**< time spent by each entity type and named entity */
+    bool performance_overlay_enabled;               /**< whether the performance stats are drawn on the map */
+    std::vector<std::shared_ptr<TextSurface>>
+      performance_overlay_lines;                    /**< text of the performance overlay */
+
 };
 
 /**
@@ -208,6 +291,19 @@ inline Ground MapEntities::get_tile_ground(Layer layer, int x, int y) const {
   return tiles_ground[layer][(y >> 3) * map_width8 + (x >> 3)];
 }
 
+/**
+ * \brief Returns the tile grounds of a layer as bitmaps.
+ *
+ * This is a bit-packed view of the grounds returned by get_tile_ground(),
+ * kept up to date by set_tile_ground().
+ *
+ * \param layer The layer.
+ * \return The ground bitmaps of this layer.
+ */
+inline const GroundBitmaps& MapEntities::get_tile_ground_bitmaps(Layer layer) const {
+  return tiles_ground_bitmaps[layer];
+}
+
 }
 
 #endif
@@ -20,6 +20,7 @@
 #include "solarus/Common.h"
 #include "solarus/lowlevel/Color.h"
 #include "solarus/lowlevel/SurfacePtr.h"
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -41,6 +42,7 @@ class Tileset {
   public:
 
     explicit Tileset(const std::string& id);
+    ~Tileset();
 
     void load();
     void unload();
@@ -55,6 +57,7 @@ class Tileset {
 
   private:
 
+    int64_t get_images_memory_size() const;
     void add_tile_pattern(
         const std::string& id,
         const TilePatternData& pattern_data
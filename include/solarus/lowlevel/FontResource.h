@@ -80,6 +80,7 @@ class FontResource {
     };
 
     static void load_fonts();
+    static int64_t get_memory_size(const FontFile& font);
 
     static bool fonts_loaded;
     static std::map<std::string, FontFile> fonts;
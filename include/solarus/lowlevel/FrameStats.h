@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_FRAME_STATS_H
+#define SOLARUS_FRAME_STATS_H
+
+#include "solarus/Common.h"
+#include <cstdint>
+#include <vector>
+
+namespace Solarus {
+
+/**
+ * \brief Statistics about the durations of the frames displayed.
+ *
+ * Durations are measured in microseconds between two consecutive frames.
+ * The histogram has one bucket per millisecond, the last bucket counting
+ * all longer frames.
+ */
+class SOLARUS_API FrameStats {
+
+  public:
+
+    static constexpr int num_buckets = 50;  /**< Number of buckets of the histogram. */
+
+    FrameStats();
+
+    void clear();
+    void add_frame(uint64_t duration);
+
+    int get_num_frames() const;
+    uint64_t get_min_duration() const;
+    uint64_t get_max_duration() const;
+    double get_average_duration() const;
+    double get_jitter() const;
+    const std::vector<int>& get_histogram() const;
+
+  private:
+
+    int num_frames;                 /**< Number of frames measured. */
+    uint64_t total_duration;        /**< Sum of the durations. */
+    double total_squared_duration;  /**< Sum of the squared durations. */
+    uint64_t min_duration;          /**< Shortest frame. */
+    uint64_t max_duration;          /**< Longest frame. */
+    std::vector<int> histogram;     /**< Number of frames in each millisecond bucket. */
+
+};
+
+}
+
+#endif
+
@@ -289,6 +289,10 @@ class InputEvent {
     // window event
     bool is_window_closing() const;
 
+    // recording
+    std::string serialize() const;
+    static std::unique_ptr<InputEvent> deserialize(const std::string& data);
+
   private:
 
     explicit InputEvent(const SDL_Event& event);
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_INPUT_RECORDER_H
+#define SOLARUS_INPUT_RECORDER_H
+
+#include "solarus/Common.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace Solarus {
+
+class InputEvent;
+
+/**
+ * \brief Writes input events to a file so that a session can be replayed.
+ *
+ * The file starts with the seed of the random number generator,
+ * followed by each input event with the number of the simulation step
+ * when it was handled, and finally the number of steps of the session.
+ * Use InputReplayer to read it.
+ */
+class InputRecorder {
+
+  public:
+
+    InputRecorder(const std::string& file_name, uint32_t seed);
+
+    bool is_valid() const;
+    void record(uint32_t step, const InputEvent& event);
+    void finish(uint32_t num_steps);
+
+  private:
+
+    std::ofstream file;     /**< The file being written. */
+
+};
+
+}
+
+#endif
+
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_INPUT_REPLAYER_H
+#define SOLARUS_INPUT_REPLAYER_H
+
+#include "solarus/Common.h"
+#include "solarus/lowlevel/InputEvent.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace Solarus {
+
+/**
+ * \brief Reads input events recorded by InputRecorder and gives them back
+ * at the same simulation steps.
+ */
+class InputReplayer {
+
+  public:
+
+    explicit InputReplayer(const std::string& file_name);
+
+    bool is_valid() const;
+    uint32_t get_seed() const;
+    std::unique_ptr<InputEvent> get_event(uint32_t step);
+    bool is_finished(uint32_t step) const;
+
+  private:
+
+    bool valid;             /**< Whether the file was successfully read. */
+    uint32_t seed;          /**< Seed of the random number generator. */
+    uint32_t num_steps;     /**< Number of steps of the recorded session. */
+    std::deque<std::pair<uint32_t, std::string>>
+        events;             /**< Remaining events and their step. */
+
+};
+
+}
+
+#endif
+
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_MEMORY_STATS_H
+#define SOLARUS_MEMORY_STATS_H
+
+#include "solarus/Common.h"
+#include <cstdint>
+#include <string>
+
+namespace Solarus {
+
+/**
+ * \brief Kinds of resources whose memory is accounted.
+ *
+ * Categories may overlap: for example, the images of sprites, tilesets
+ * and bitmap fonts are surfaces, so they are also counted in SURFACES.
+ */
+enum class MemoryCategory {
+  SURFACES,         /**< Pixels of software surfaces. */
+  TEXTURES,         /**< Pixels of GPU textures (estimated). */
+  SPRITES,          /**< Images of loaded sprite animation sets. */
+  SOUNDS,           /**< Decoded sound buffers. */
+  MUSIC,            /**< Encoded and streamed data of the current music. */
+  FONTS,            /**< Font files and bitmap fonts. */
+  TILESETS          /**< Images of loaded tilesets. */
+};
+
+/**
+ * \brief Counts the memory used by each category of resources.
+ *
+ * Resources report their size when they are allocated and freed.
+ * Counters are atomic, so that resources can be freed from any thread.
+ */
+namespace MemoryStats {
+
+constexpr int num_categories = 7;   /**< Number of memory categories. */
+
+SOLARUS_API void add(MemoryCategory category, int64_t size);
+SOLARUS_API void remove(MemoryCategory category, int64_t size);
+SOLARUS_API int64_t get(MemoryCategory category);
+SOLARUS_API const std::string& get_category_name(MemoryCategory category);
+
+SOLARUS_API std::string get_report(int64_t lua_size);
+
+}
+
+}
+
+#endif
+
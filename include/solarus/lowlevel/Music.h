@@ -22,6 +22,7 @@
 #include "solarus/lowlevel/SpcDecoder.h"
 #include "solarus/lowlevel/Sound.h"
 #include "solarus/lua/ScopedLuaRef.h"
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -123,6 +124,7 @@ class Music {
     static constexpr int nb_buffers = 8;
     ALuint buffers[nb_buffers];                  /**< multiple buffers used to stream the music */
     ALuint source;                               /**< the OpenAL source streaming the buffers */
+    int64_t memory_size;                         /**< bytes of encoded and streamed data while playing */
 
     static std::unique_ptr<SpcDecoder>
         spc_decoder;                             /**< the SPC decoder */
@@ -18,13 +18,13 @@
 #define SOLARUS_PIXEL_BITS_H
 
 #include "solarus/Common.h"
+#include "solarus/lowlevel/Rectangle.h"
 #include <cstdint>
 #include <vector>
 
 namespace Solarus {
 
 class Point;
-class Rectangle;
 class Surface;
 
 /**
@@ -33,8 +33,12 @@ class Surface;
  * This class stores efficiently the location of the non-transparent pixels of a surface.
  * For each pixel of the image, a bit indicates whether this pixel is transparent.
  * This class perform fast pixel-perfect collision checks.
+ *
+ * Rows are stored as 64-bit words, pixel x of a row being bit x % 64 of
+ * word x / 64. When SSE2 or AVX2 instructions are available at compile
+ * time, several rows are compared at once.
  */
-class PixelBits {
+class SOLARUS_API PixelBits {
 
   public:
 
@@ -45,17 +49,22 @@ class PixelBits {
 
   private:
 
+    void build_row(const Surface& surface, int pixel_index, uint64_t* row);
+    void compute_opaque_box();
+    const uint64_t* get_row(int y) const;
+
     void print() const;
-    void print_mask(uint32_t mask) const;
 
     int width;               /**< width of the image in pixels */
     int height;              /**< height of the image in pixels */
-    int nb_integers_per_row; /**< number of uint32_t necessary to store
-                              * the bits of a row of the image */
+    int nb_words_per_row;    /**< number of uint64_t storing a row of the image,
+                              * including a last one always zero */
+    Rectangle opaque_box;    /**< smallest rectangle containing all
+                              * non-transparent pixels, relative to the image */
 
-    std::vector<std::vector<uint32_t>>
-        bits;                /**< A two-dimensional array representing the
-                              * transparency bit of each pixel in the image. */
+    std::vector<uint64_t>
+        bits;                /**< The transparency bit of each pixel in the image,
+                              * row after row. */
 
 };
 
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_PROFILER_H
+#define SOLARUS_PROFILER_H
+
+#include "solarus/Common.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Solarus {
+
+class Arguments;
+
+/**
+ * \brief Measures the time spent in the main parts of the engine.
+ *
+ * Code to measure is delimited by Profiler::Zone objects.
+ * The profiler is disabled by default: a zone then costs almost nothing.
+ * When enabled, the time spent in each zone is accumulated until
+ * reset_zone_stats() is called.
+ *
+ * If a trace file is set (option -trace-file=<path>), each zone is also
+ * recorded as an event in the Chrome trace event format, that can be
+ * opened with chrome://tracing.
+ */
+namespace Profiler {
+
+/**
+ * \brief Time statistics of a profiling zone.
+ */
+struct ZoneStats {
+  std::string name;         /**< Name of the zone. */
+  uint64_t total_time;      /**< Time spent in the zone in microseconds. */
+  int num_calls;            /**< Number of times the zone was entered. */
+};
+
+/**
+ * \brief Measures the time spent from its creation to its destruction.
+ *
+ * Declare a zone as a local variable at the beginning of the scope to
+ * measure.
+ */
+class SOLARUS_API Zone {
+
+  public:
+
+    explicit Zone(const char* name);
+    ~Zone();
+
+    Zone(const Zone& other) = delete;
+    Zone& operator=(const Zone& other) = delete;
+
+  private:
+
+    const char* name;       /**< Name of the zone (a string literal). */
+    bool active;            /**< Whether the profiler was enabled when entering the zone. */
+    uint64_t start_time;    /**< Date when the zone was entered in microseconds. */
+};
+
+SOLARUS_API void initialize(const Arguments& args);
+SOLARUS_API void quit();
+
+SOLARUS_API bool is_enabled();
+SOLARUS_API void set_enabled(bool enabled);
+SOLARUS_API uint64_t get_time();
+
+SOLARUS_API void add_zone_time(const char* name, uint64_t duration);
+SOLARUS_API const std::vector<ZoneStats>& get_zone_stats();
+SOLARUS_API void reset_zone_stats();
+
+SOLARUS_API bool is_tracing();
+SOLARUS_API void start_trace(const std::string& file_name);
+SOLARUS_API void stop_trace();
+
+}
+
+}
+
+#endif
+
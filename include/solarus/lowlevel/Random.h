@@ -18,6 +18,7 @@
 #define SOLARUS_RANDOM_H
 
 #include "solarus/Common.h"
+#include <cstdint>
 
 namespace Solarus {
 
@@ -29,6 +30,9 @@ namespace Random {
 void initialize();
 void quit();
 
+uint32_t get_seed();
+void set_seed(uint32_t seed);
+
 int get_number(unsigned int x);
 int get_number(int x, int y);
 
@@ -36,6 +36,7 @@ namespace Solarus {
 class Rectangle {
 
   // low-level classes allowed to manipulate directly the internal SDL rectangle encapsulated
+  friend class RenderCommandList;
   friend class Surface;
   friend class Video;
 
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_RENDER_COMMAND_LIST_H
+#define SOLARUS_RENDER_COMMAND_LIST_H
+
+#include "solarus/Common.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct SDL_Renderer;
+struct SDL_Surface;
+struct SDL_Texture;
+
+namespace Solarus {
+
+class Color;
+
+/**
+ * \brief A GPU texture created and destroyed on the rendering side.
+ *
+ * Surfaces only hold a shared pointer to it: the SDL texture itself is
+ * created, updated and used when render commands are executed, which may
+ * happen on the render thread.
+ */
+class RenderTexture {
+
+  public:
+
+    RenderTexture();
+    ~RenderTexture();
+
+    RenderTexture(const RenderTexture& other) = delete;
+    RenderTexture& operator=(const RenderTexture& other) = delete;
+
+    SDL_Texture* get_texture() const;
+    void set_texture(SDL_Texture* texture, int64_t memory_size);
+
+  private:
+
+    SDL_Texture* texture;       /**< The SDL texture, or nullptr if not created yet. */
+    int64_t memory_size;        /**< Estimated size of the texture in bytes. */
+
+};
+
+using RenderTexturePtr = std::shared_ptr<RenderTexture>;
+
+/**
+ * \brief The drawing operations of one frame, recorded to be executed later.
+ *
+ * Surface::render() fills a command list from its tree of subsurfaces.
+ * The list can then be executed on the thread that owns the renderer.
+ *
+ * A deferred list copies the pixels of software surfaces to upload,
+ * so that the simulation can continue to modify them while the list
+ * is executed on another thread.
+ */
+class RenderCommandList {
+
+  public:
+
+    explicit RenderCommandList(bool deferred);
+
+    bool is_deferred() const;
+    bool is_empty() const;
+
+    void add_texture_update(const RenderTexturePtr& texture, SDL_Surface& surface);
+    void add_fill_rect(const Color& color, uint8_t opacity, const Rectangle& rect);
+    void add_copy(
+        const RenderTexturePtr& texture,
+        uint8_t opacity,
+        const Rectangle& src_rect,
+        const Rectangle& dst_rect
+    );
+
+    void execute(SDL_Renderer* renderer) const;
+    void present(SDL_Renderer* renderer) const;
+
+  private:
+
+    /**
+     * \brief Kinds of render commands.
+     */
+    enum class CommandType {
+      UPDATE_TEXTURE,           /**< Create or update a texture from pixels. */
+      FILL_RECT,                /**< Fill a rectangle with a color. */
+      COPY                      /**< Draw a region of a texture. */
+    };
+
+    /**
+     * \brief Pixels to upload to a texture.
+     */
+    struct TextureUpdate {
+      SDL_Surface* surface;         /**< Surface to read from (non-deferred lists only). */
+      int width;                    /**< Width of the pixels. */
+      int height;                   /**< Height of the pixels. */
+      int pitch;                    /**< Length of a row of pixels in bytes. */
+      std::vector<uint8_t> pixels;  /**< Copy of the pixels (deferred lists only). */
+    };
+
+    /**
+     * \brief A recorded drawing operation.
+     */
+    struct Command {
+      CommandType type;             /**< Kind of command. */
+      RenderTexturePtr texture;     /**< Texture to update or to draw. */
+      size_t update_index;          /**< Index in texture_updates for UPDATE_TEXTURE. */
+      Rectangle src_rect;           /**< Region of the texture to draw. */
+      Rectangle dst_rect;           /**< Where to draw or fill. */
+      uint8_t r, g, b, a;           /**< Fill color, or alpha modulation in a for COPY. */
+    };
+
+    void update_texture(SDL_Renderer* renderer, const Command& command) const;
+
+    bool deferred;                  /**< Whether pixels are copied when recorded. */
+    std::vector<Command> commands;  /**< Commands in execution order. */
+    std::vector<TextureUpdate>
+        texture_updates;            /**< Pixels to upload, referenced by commands. */
+
+};
+
+}
+
+#endif
+
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_RENDER_THREAD_H
+#define SOLARUS_RENDER_THREAD_H
+
+#include "solarus/Common.h"
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct SDL_Renderer;
+struct SDL_Texture;
+struct SDL_Window;
+
+namespace Solarus {
+
+class RenderCommandList;
+
+/**
+ * \brief A thread that owns the renderer and presents recorded frames.
+ *
+ * The simulation records each frame into a RenderCommandList and submits
+ * it. The render thread executes it and presents it, possibly blocking on
+ * the vertical synchronization, while the simulation goes on with the next
+ * steps. At most one frame waits to be executed: submitting another one
+ * blocks until the render thread has picked the previous one.
+ *
+ * Once the thread is started, any other operation on the renderer must go
+ * through run_sync().
+ */
+class RenderThread {
+
+  public:
+
+    RenderThread(SDL_Window* window, SDL_Renderer* renderer);
+    ~RenderThread();
+
+    RenderThread(const RenderThread& other) = delete;
+    RenderThread& operator=(const RenderThread& other) = delete;
+
+    void submit_frame(std::unique_ptr<RenderCommandList> frame);
+    void run_sync(const std::function<void()>& task);
+    void wait_idle();
+    void destroy_texture(SDL_Texture* texture);
+
+  private:
+
+    void run();
+
+    SDL_Window* window;             /**< The window rendered to. */
+    SDL_Renderer* renderer;         /**< The renderer, only used by the render thread. */
+    std::mutex mutex;               /**< Protects the fields below. */
+    std::condition_variable
+        condition;                  /**< Notified whenever the fields below change. */
+    std::unique_ptr<RenderCommandList>
+        pending_frame;              /**< Frame waiting to be presented, if any. */
+    std::function<void()>
+        pending_task;               /**< Task waiting to be run on the renderer, if any. */
+    std::vector<SDL_Texture*>
+        textures_to_destroy;        /**< Textures released by the simulation. */
+    bool busy;                      /**< Whether the thread is currently rendering. */
+    bool stopping;                  /**< Whether the thread should finish. */
+    std::thread thread;             /**< The render thread. */
+
+};
+
+}
+
+#endif
+
@@ -18,6 +18,7 @@
 #define SOLARUS_SOUND_H
 
 #include "solarus/Common.h"
+#include <cstdint>
 #include <string>
 #include <list>
 #include <map>
@@ -78,6 +79,7 @@ class Sound {
   private:
 
     ALuint decode_file(const std::string &file_name);
+    int64_t get_buffer_size() const;
     bool update_playing();
 
     static ALCdevice* device;
@@ -18,7 +18,9 @@
 #define SOLARUS_SURFACE_H
 
 #include "solarus/Common.h"
+#include "solarus/lowlevel/MemoryStats.h"
 #include "solarus/lowlevel/PixelBits.h"
+#include "solarus/lowlevel/RenderCommandList.h"
 #include "solarus/lowlevel/SurfacePtr.h"
 #include "solarus/Drawable.h"
 #include <SDL.h>
@@ -86,10 +88,12 @@ class Surface: public Drawable {
     void set_opacity(uint8_t opacity);
 
     std::string get_pixels() const;
+    int64_t get_memory_size() const;
 
     void apply_pixel_filter(const PixelFilter& pixel_filter, Surface& dst_surface);
 
     void render(SDL_Renderer* renderer);
+    void render(RenderCommandList& commands);
 
     virtual const std::string& get_lua_type_name() const override;
 
@@ -115,17 +119,13 @@ class Surface: public Drawable {
 
     struct SDL_Surface_Deleter {
         void operator()(SDL_Surface* sdl_surface) {
+          MemoryStats::remove(MemoryCategory::SURFACES, get_memory_size(sdl_surface));
           SDL_FreeSurface(sdl_surface);
         }
     };
     using SDL_Surface_UniquePtr = std::unique_ptr<SDL_Surface, SDL_Surface_Deleter>;
 
-    struct SDL_Texture_Deleter {
-        void operator()(SDL_Texture* sdl_texture) {
-          SDL_DestroyTexture(sdl_texture);
-        }
-    };
-    using SDL_Texture_UniquePtr = std::unique_ptr<SDL_Texture, SDL_Texture_Deleter>;
+    static int64_t get_memory_size(const SDL_Surface* sdl_surface);
 
     uint32_t get_pixel(int index) const;
     bool is_pixel_transparent(int index) const;
@@ -137,11 +137,11 @@ class Surface: public Drawable {
 
     void create_software_surface();
     void convert_software_surface();
-    void create_texture_from_surface();
+    void update_texture(RenderCommandList& commands);
     void add_subsurface(const SurfacePtr& src_surface, const Rectangle& region, const Point& dst_position);
     void clear_subsurfaces();
     void render(
-        SDL_Renderer* renderer,
+        RenderCommandList& commands,
         const Rectangle& src_rect,
         const Rectangle& dst_rect,
         const Rectangle& clip_rect,
@@ -156,8 +156,8 @@ class Surface: public Drawable {
                                            * (and therefore immediately) when used as a destination */
     SDL_Surface_UniquePtr
         internal_surface;                 /**< the SDL_Surface encapsulated, if any. */
-    SDL_Texture_UniquePtr
-        internal_texture;                 /**< the SDL_Texture encapsulated, if any. */
+    RenderTexturePtr
+        internal_texture;                 /**< the texture encapsulated, if any. */
     std::unique_ptr<Color>
         internal_color;                   /**< the background color to use, if any. */
     bool is_rendered;                     /**< indicates if the current surface has been rendered. Set to false when drawing a surface on this one. */
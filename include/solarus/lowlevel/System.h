@@ -42,13 +42,17 @@ class SOLARUS_API System {
 
     static uint32_t now();
     static uint32_t get_real_time();
+    static uint64_t get_real_time_us();
     static void sleep(uint32_t duration);
+    static void wait_until_us(uint64_t date);
 
     static constexpr uint32_t timestep = 10;  /**< Timestep added to the simulated time at each update. */
 
   private:
 
     static uint32_t initial_time;         /**< Initial real time in milliseconds. */
+    static uint64_t initial_counter;      /**< Initial value of the high-resolution counter. */
+    static uint64_t counter_frequency;    /**< Ticks per second of the high-resolution counter. */
     static uint32_t ticks;                /**< Simulated time in milliseconds. */
 
 };
@@ -52,6 +52,7 @@ class Video {
 
     static SDL_Texture* get_render_target();
     static SDL_PixelFormat* get_pixel_format();
+    static bool is_disabled();
     static bool is_acceleration_enabled();
     static const std::string& get_rendering_driver_name();
     static void show_window();
@@ -93,6 +94,8 @@ class Video {
     static bool renderer_to_quest_coordinates(const Point& renderer_xy, Point& quest_xy);
 
     static void render(const SurfacePtr& quest_surface);
+    static void wait_rendering();
+    static void destroy_texture(SDL_Texture* texture);
 
   private:
 
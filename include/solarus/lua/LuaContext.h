@@ -34,6 +34,7 @@
 #include "solarus/DrawablePtr.h"
 #include "solarus/SpritePtr.h"
 #include "solarus/TimerPtr.h"
+#include <cstdint>
 #include <list>
 #include <map>
 #include <memory>
@@ -139,6 +140,7 @@ class LuaContext {
     lua_State* get_internal_state();
 
     MainLoop& get_main_loop();
+    int64_t get_heap_size();
 
     // Main loop from C++.
     void initialize();
@@ -254,6 +256,11 @@ class LuaContext {
         Sprite& custom_entity_sprite,
         Sprite& other_entity_sprite
     );
+    void do_custom_entity_collision_callback(
+        const ScopedLuaRef& callback_ref,
+        CustomEntity& custom_entity,
+        const std::vector<EntityPtr>& other_entities
+    );
 
     // Main loop events (sol.main).
     void main_on_started();
@@ -432,6 +439,8 @@ class LuaContext {
       main_api_get_type,
       main_api_get_metatable,
       main_api_get_os,
+      main_api_get_frame_stats,
+      main_api_get_memory_stats,
 
       // Audio API.
       audio_api_get_sound_volume,
@@ -611,6 +620,8 @@ class LuaContext {
       path_finding_movement_api_set_target,
       path_finding_movement_api_get_speed,
       path_finding_movement_api_set_speed,
+      path_finding_movement_api_is_flow_field_enabled,
+      path_finding_movement_api_set_flow_field_enabled,
       circle_movement_api_set_center,
       circle_movement_api_get_radius,
       circle_movement_api_set_radius,
@@ -765,6 +776,9 @@ class LuaContext {
       map_api_get_hero,
       map_api_set_entities_enabled,
       map_api_remove_entities,
+      map_api_set_performance_stats_enabled,
+      map_api_get_performance_stats,
+      map_api_set_performance_overlay_enabled,
       map_api_create_entity,  // Same function used for all entity types.
 
       // Map entity API.
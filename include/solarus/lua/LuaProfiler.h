@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_LUA_PROFILER_H
+#define SOLARUS_LUA_PROFILER_H
+
+#include "solarus/Common.h"
+
+struct lua_State;
+
+namespace Solarus {
+
+class Arguments;
+
+/**
+ * \brief Sampling profiler of the Lua scripts of the quest.
+ *
+ * Enabled with the option -lua-profile=<path>.
+ * A hook installed with lua_sethook() samples the Lua stack when a function
+ * is called or returns and periodically in between, and attributes the
+ * time elapsed since the previous sample to it.
+ * Sampled stacks start with the innermost callback being run.
+ * In addition, every callback called by the engine (on_update(),
+ * timer callbacks, on_draw()...) is timed exactly.
+ *
+ * When the program exits, a report sorted by callback, by function and by
+ * script file is written to the given path, and the sampled stacks are
+ * written to <path>.folded in the folded format of flame graph tools.
+ *
+ * Note that LuaJIT does not call hooks from compiled code: for accurate
+ * per-function results, disable the JIT compiler while profiling.
+ */
+namespace LuaProfiler {
+
+SOLARUS_API void initialize(const Arguments& args);
+SOLARUS_API void quit();
+
+SOLARUS_API bool is_enabled();
+
+SOLARUS_API void attach(lua_State* l);
+SOLARUS_API void detach(lua_State* l);
+
+SOLARUS_API void enter_callback(lua_State* l, int function_index, const char* callback_name);
+SOLARUS_API void leave_callback();
+
+}
+
+}
+
+#endif
+
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_ASYNC_PATH_FINDING_H
+#define SOLARUS_ASYNC_PATH_FINDING_H
+
+#include "solarus/Common.h"
+#include "solarus/lowlevel/Point.h"
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace Solarus {
+
+class Arguments;
+class Entity;
+class PathFindingSnapshot;
+
+/**
+ * \brief Computes paths on background threads.
+ *
+ * A request copies the obstacles around the query into a
+ * PathFindingSnapshot, so that worker threads never access the map.
+ * The caller keeps the request and polls it until it is done.
+ * Requests nobody holds anymore are skipped by the workers.
+ *
+ * The number of workers is set with the option -path-finding-threads=<n>.
+ * It is 0 by default: paths are then computed synchronously as before,
+ * which keeps the simulation deterministic for input replays.
+ */
+namespace AsyncPathFinding {
+
+/**
+ * \brief A path query and its result.
+ */
+class SOLARUS_API Request {
+
+  public:
+
+    explicit Request(std::unique_ptr<PathFindingSnapshot> snapshot);
+    ~Request();
+
+    Request(const Request& other) = delete;
+    Request& operator=(const Request& other) = delete;
+
+    const PathFindingSnapshot& get_snapshot() const;
+    bool is_done() const;
+    const std::string& get_path() const;
+
+    void compute();
+
+  private:
+
+    std::unique_ptr<const PathFindingSnapshot>
+        snapshot;             /**< The query and the obstacles around it. */
+    std::string path;         /**< The path found, empty if none. Only valid once done. */
+    std::atomic<bool> done;   /**< Whether the path was computed. */
+};
+
+/**
+ * \brief Alias for shared_ptr of Request.
+ */
+using RequestPtr = std::shared_ptr<Request>;
+
+SOLARUS_API void initialize(const Arguments& args);
+SOLARUS_API void quit();
+
+SOLARUS_API bool is_enabled();
+SOLARUS_API int get_num_threads();
+
+SOLARUS_API RequestPtr submit(
+    Entity& source_entity,
+    const Point& source,
+    const Entity& target_entity
+);
+
+}
+
+}
+
+#endif
+
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_FLOW_FIELD_H
+#define SOLARUS_FLOW_FIELD_H
+
+#include "solarus/Common.h"
+#include "solarus/entities/Layer.h"
+#include "solarus/lowlevel/Point.h"
+#include <cstdint>
+#include <vector>
+
+namespace Solarus {
+
+class Entity;
+class PathFindingGraph;
+
+/**
+ * \brief Directions to a target from every place of a map layer.
+ *
+ * The cost to reach the target is computed once from every 16x16 node of
+ * the 8x8 ground grid, with the Dijkstra algorithm.
+ * Then any number of entities chasing the same target can read the
+ * direction to take from where they are in constant time.
+ *
+ * Like PathFindingGraph, only the terrain is considered.
+ * The field is recomputed when the target goes to another node or when
+ * the terrain changes, but not more often than every refresh_delay
+ * milliseconds.
+ */
+class FlowField {
+
+  public:
+
+    FlowField(PathFindingGraph& graph, const Entity& target, int width8, int height8);
+
+    const Entity& get_target() const;
+    Layer get_layer() const;
+    uint32_t get_obstacle_grounds() const;
+
+    void update();
+    int get_direction8(const Point& location) const;
+
+    static constexpr uint32_t refresh_delay = 500;  /**< Minimum delay between two computations. */
+
+  private:
+
+    void compute(int target_node);
+
+    PathFindingGraph& graph;          /**< Terrain of the layer. */
+    const Entity& target;             /**< The entity to reach. */
+    int width8;                       /**< Number of 8x8 squares on a row of the map. */
+    int height8;                      /**< Number of 8x8 squares on a column of the map. */
+    int target_node;                  /**< Square index of the node of the target when computed,
+                                       * or -1 if the field was never computed. */
+    uint32_t terrain_version;         /**< Version of the terrain when computed. */
+    uint32_t next_refresh_date;       /**< Date when the field may be computed again. */
+    std::vector<int> costs;           /**< Cost to reach the target from each node. */
+    std::vector<int8_t> directions;   /**< Direction to take from each node (0 to 7),
+                                       * or -1 if the target cannot be reached. */
+
+};
+
+}
+
+#endif
+
@@ -84,6 +84,7 @@ class SOLARUS_API Movement: public ExportableToLua {
     // obstacles
     bool test_collision_with_obstacles(int dx, int dy) const;
     bool test_collision_with_obstacles(const Point& dxy) const;
+    int get_free_distance(const Point& direction, int max_distance) const;
     const Rectangle& get_last_collision_box_on_obstacle() const;
     bool are_obstacles_ignored() const;
     void set_ignore_obstacles(bool ignore_obstacles);
@@ -19,14 +19,15 @@
 
 #include "solarus/Common.h"
 #include "solarus/lowlevel/Point.h"
-#include <list>
-#include <map>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace Solarus {
 
 class Map;
 class Entity;
+class PathFindingSnapshot;
 class Rectangle;
 
 /**
@@ -35,6 +36,9 @@ class Rectangle;
  * In the current implementation, the computed path always corresponds to a
  * shape of 16*16. If the entity to move is bigger, some obstacles may prevent
  * it from following the computed path.
+ *
+ * The search can also be made in a PathFindingSnapshot instead of the map.
+ * It then only reads the snapshot and can run in another thread.
  */
 class SOLARUS_API PathFinding {
 
@@ -44,9 +48,13 @@ class SOLARUS_API PathFinding {
         Map& map,
         Entity& source_entity,
         Entity& target_entity);
+    explicit PathFinding(const PathFindingSnapshot& snapshot);
 
     std::string compute_path();
 
+    static Point get_target_location(const Entity& target_entity);
+    static bool is_local_search(const Point& source, const Point& target);
+
   private:
 
     /**
@@ -54,40 +62,71 @@ class SOLARUS_API PathFinding {
      *
      * A node is the location of a 16*16 square of the map.
      * The algorithm tries to find the best sequence of nodes leading to the target.
+     * Nodes are stored in a flat array indexed by their square index,
+     * so their location is not stored.
      */
     class Node {
 
      public:
 
-      Point location;     /**< location of this node on the map */
-      int index;          /**< index of this node's square on the map (depends on the location) */
+      uint32_t generation;  /**< search that last initialized this node,
+                             * other values mean that the node was not visited yet */
+      uint32_t order;       /**< when this node was opened during the search */
 
       // total_cost = previous_cost + heuristic
-      int previous_cost;  /**< cost of the best path that leads to this node */
-      int heuristic;      /**< estimation of the remaining cost to the target */
-      int total_cost;     /**< total cost of this node */
+      int previous_cost;    /**< cost of the best path that leads to this node */
+      int total_cost;       /**< total cost of this node */
 
-      int parent_index;   /**< index of the square containing the best node leading to this node */
-      char direction;     /**< direction from the parent node to this node (0 to 7) */
+      int parent_index;     /**< index of the square containing the best node leading to this node */
+      int heap_position;    /**< position of this node in the open heap, or -1 if closed */
+      char direction;       /**< direction from the parent node to this node (0 to 7) */
+    };
 
-      bool operator<(const Node& other) const;
+    /**
+     * \brief Nodes and open heap of A*, kept between searches.
+     *
+     * Instead of being cleared, nodes of previous searches are
+     * ignored thanks to their generation number.
+     */
+    struct SearchNodes {
+      std::vector<Node> nodes;      /**< all nodes of the map, indexed by square index */
+      std::vector<int> open_heap;   /**< binary heap of the open nodes, by priority */
+      uint32_t generation = 0;      /**< number of the current search */
     };
 
+    static SearchNodes& get_search_nodes();
+
+    static Rectangle get_search_area(const Point& source, const Point& target);
+    bool can_share_paths() const;
+    std::string compute_local_path(const Point& source, const Point& target);
+    std::string compute_hierarchical_path(const Point& source, const Point& target);
+
     int get_square_index(const Point& location) const;
-    bool is_node_transition_valid(const Node& node, int direction) const;
-    void add_index_sorted(Node* node);
-    std::string rebuild_path(const Node* final_node);
+    Point get_square_location(int index) const;
+    bool is_node_transition_valid(const Point& location, int direction) const;
+    bool is_before(int index1, int index2) const;
+    void push_open_node(int index);
+    int pop_open_node();
+    void move_up_open_node(int index);
+    void move_down_open_node(int index);
+    void set_heap_position(int position, int index);
+    std::string rebuild_path(int final_index) const;
+
+    static constexpr int max_local_distance = 200;  /**< Maximum Manhattan distance of a direct A* search. */
+    static constexpr int max_refined_segments = 2;  /**< Number of local searches to refine a long path. */
 
     static const Point neighbours_locations[];
     static const Rectangle transition_collision_boxes[];
 
-    Map& map;                          /**< the map */
-    Entity& source_entity;          /**< the entity to move */
-    Entity& target_entity;          /**< the target point */
+    Map* map;                       /**< the map, or nullptr when searching in a snapshot */
+    Entity* source_entity;          /**< the entity to move, or nullptr when searching in a snapshot */
+    Entity* target_entity;          /**< the target point, or nullptr when searching in a snapshot */
+    const PathFindingSnapshot*
+        snapshot;                   /**< obstacles to consider instead of the map, or nullptr */
+    int map_width;                  /**< width of the map in pixels */
+    int map_height;                 /**< height of the map in pixels */
 
-    std::map<int, Node> closed_list;   /**< the closed list, indexed by the node locations on the map */
-    std::map<int, Node> open_list;     /**< the open list, indexed by the node locations on the map */
-    std::list<int> open_list_indices;  /**< indices of the open list elements, sorted by priority */
+    SearchNodes& search;            /**< nodes of the search (shared by all searches of this thread) */
 
 };
 
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_PATH_FINDING_CACHE_H
+#define SOLARUS_PATH_FINDING_CACHE_H
+
+#include "solarus/Common.h"
+#include "solarus/entities/EntityType.h"
+#include "solarus/entities/Layer.h"
+#include "solarus/lowlevel/Point.h"
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+
+namespace Solarus {
+
+/**
+ * \brief Remembers the last paths computed on a map.
+ *
+ * Entities that chase the same target from the same place often search
+ * the same path again and again while nothing changes.
+ * A path is reused if it was searched from the same node to the same
+ * target node by an entity of the same type with the same obstacle grounds,
+ * and if no obstacle has changed since in the area that the search could
+ * explore (see MapEntities::get_obstacle_version()).
+ * Entities whose obstacles depend on more than their type and grounds,
+ * like custom entities with their own traversal rules, should not use
+ * the cache.
+ *
+ * Some traversal rules of obstacles are Lua functions whose result may
+ * change anytime. To bound the error, paths also expire after max_age
+ * milliseconds.
+ * When the cache is full, the least recently used path is forgotten.
+ */
+class SOLARUS_API PathFindingCache {
+
+  public:
+
+    /**
+     * \brief What a path depends on.
+     */
+    struct Key {
+      Layer layer;                  /**< Layer of the search. */
+      EntityType source_type;       /**< Type of the entity to move. */
+      uint32_t obstacle_grounds;    /**< Grounds that are obstacles for the entity to move. */
+      uint32_t obstacle_version;    /**< Version of the obstacles of the searched area. */
+      uint32_t terrain_version;     /**< Version of the terrain of the map if the search
+                                     * uses the abstract graph, 0 otherwise. */
+      Point source;                 /**< Location of the source node. */
+      Point target;                 /**< Location of the target node. */
+
+      bool operator<(const Key& other) const;
+    };
+
+    PathFindingCache();
+
+    bool find_path(const Key& key, std::string& path);
+    void add_path(const Key& key, const std::string& path);
+
+    uint64_t get_num_hits() const;
+    uint64_t get_num_misses() const;
+
+    static constexpr size_t capacity = 256;   /**< Maximum number of paths kept. */
+    static constexpr uint32_t max_age = 1000; /**< Delay before a path must be searched again. */
+
+  private:
+
+    /**
+     * \brief A path in the cache.
+     */
+    struct Entry {
+      Key key;                      /**< What the path depends on. */
+      std::string path;             /**< The path, empty if there was no path. */
+      uint32_t date;                /**< When the path was searched. */
+    };
+
+    std::list<Entry> entries;       /**< Paths from the most recently used one. */
+    std::map<Key, std::list<Entry>::iterator>
+        entries_by_key;             /**< Position of each path in the list. */
+    uint64_t num_hits;              /**< Number of searches avoided. */
+    uint64_t num_misses;            /**< Number of searches that had to be made. */
+
+};
+
+}
+
+#endif
+
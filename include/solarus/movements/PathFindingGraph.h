@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_PATH_FINDING_GRAPH_H
+#define SOLARUS_PATH_FINDING_GRAPH_H
+
+#include "solarus/Common.h"
+#include "solarus/entities/Layer.h"
+#include "solarus/lowlevel/Point.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace Solarus {
+
+class Entity;
+class MapEntities;
+
+/**
+ * \brief Abstract graph of a map layer for hierarchical path finding.
+ *
+ * The 8x8 ground grid is divided in square clusters.
+ * Entrances are the places where a 16x16 entity can go from a cluster to
+ * a neighbor one, and the graph stores the cost of going from an entrance
+ * to each other entrance of the same cluster.
+ * A long path is first searched in this small graph and then refined
+ * locally by the usual A* algorithm.
+ *
+ * Only the terrain is considered here: tile grounds and dynamic entities
+ * that change the ground. Whether a ground is an obstacle depends on the
+ * entity to move, so there is one graph per layer and per set of obstacle
+ * grounds.
+ * Diagonal walls are considered as obstacles.
+ *
+ * Clusters are rebuilt lazily when the terrain changes under them.
+ */
+class PathFindingGraph {
+
+  public:
+
+    PathFindingGraph(
+        MapEntities& entities,
+        Layer layer,
+        uint32_t obstacle_grounds,
+        int width8,
+        int height8
+    );
+
+    Layer get_layer() const;
+    uint32_t get_obstacle_grounds() const;
+    static uint32_t get_obstacle_grounds(const Entity& entity);
+
+    uint32_t get_terrain_version() const;
+    void notify_ground_changed(const Rectangle& area);
+    void notify_ground_modifier_changed(const Entity& ground_modifier, bool present);
+
+    void update();
+    bool is_node_free(int x8, int y8) const;
+    bool is_transition_free(int x8, int y8, int dx8, int dy8) const;
+    std::vector<Point> compute_waypoints(const Point& source, const Point& target);
+
+    static constexpr int cluster_size8 = 12;  /**< Width and height of a cluster in 8x8 squares:
+                                               * small enough for any two nodes of a cluster
+                                               * to be in range of a direct A* search. */
+
+  private:
+
+    /**
+     * \brief An edge of the abstract graph.
+     */
+    struct Edge {
+      int node;                               /**< Square index of the destination node. */
+      int cost;                               /**< Cost of going to it, in A* units. */
+    };
+
+    /**
+     * \brief A crossing of the border between two neighbor clusters.
+     */
+    struct Crossing {
+      int node1;                              /**< Square index of the node in the left or top cluster. */
+      int node2;                              /**< Square index of the node in the right or bottom cluster. */
+    };
+
+    /**
+     * \brief A square region of the grid and its entrances.
+     */
+    struct Cluster {
+      bool dirty = true;                      /**< Whether the terrain of this cluster has changed. */
+      std::vector<int> entrances;             /**< Square indices of the entrance nodes. */
+      std::vector<std::vector<Edge>> edges;   /**< Edges from each entrance. */
+      std::vector<Crossing> right_crossings;  /**< Crossings to the cluster on the right. */
+      std::vector<Crossing> bottom_crossings; /**< Crossings to the cluster below. */
+    };
+
+    void update_free_squares(int cluster_index);
+    void update_crossings(int cluster_index, bool right);
+    void update_edges(int cluster_index);
+    void search_cluster(int cluster_index, int start_node, std::vector<int>& costs) const;
+
+    void set_dirty(const Rectangle& area);
+    int get_cluster_index(int node) const;
+    int get_local_index(int cluster_index, int node) const;
+    bool is_square_free(int x8, int y8) const;
+    int get_heuristic(int node1, int node2) const;
+
+    MapEntities& entities;                    /**< Entities of the map. */
+    const Layer layer;                        /**< Layer of the map represented. */
+    const uint32_t obstacle_grounds;          /**< Bits of the grounds that are obstacles. */
+    int width8;                               /**< Number of 8x8 squares on a row of the map. */
+    int height8;                              /**< Number of 8x8 squares on a column of the map. */
+    int num_clusters_x;                       /**< Number of clusters on a row. */
+    int num_clusters_y;                       /**< Number of clusters on a column. */
+    bool dirty;                               /**< Whether at least one cluster is dirty. */
+    uint32_t terrain_version;                 /**< Incremented whenever the terrain changes. */
+    std::vector<bool> free_squares;           /**< Whether each 8x8 square is free of obstacle ground. */
+    std::vector<Cluster> clusters;            /**< Clusters row by row. */
+    std::map<const Entity*, Rectangle>
+        ground_modifier_boxes;                /**< Last known box of each ground modifier of the layer. */
+
+};
+
+}
+
+#endif
+
@@ -19,6 +19,8 @@
 
 #include "solarus/Common.h"
 #include "solarus/entities/EntityPtr.h"
+#include "solarus/lowlevel/Point.h"
+#include "solarus/movements/AsyncPathFinding.h"
 #include "solarus/movements/PathMovement.h"
 #include <cstdint>
 #include <string>
@@ -32,6 +34,13 @@ namespace Solarus {
  * The entity tries to find a path and to avoid the obstacles on the way.
  * To this end, the PathFinding class (i.e. an implementation of the A* algorithm) is used.
  * If the target entity is too far or not reachable, the movement is a random walk.
+ *
+ * Optionally, the path can instead be read from a FlowField shared by all
+ * entities chasing the same target, which is much cheaper when there are
+ * many of them.
+ *
+ * When asynchronous path finding is enabled, the next path is searched by
+ * a worker thread while the entity is still making the current one.
  */
 class SOLARUS_API PathFindingMovement: public PathMovement {
 
@@ -40,6 +49,8 @@ class SOLARUS_API PathFindingMovement: public PathMovement {
     explicit PathFindingMovement(int speed);
 
     void set_target(const EntityPtr& target);
+    bool is_flow_field_enabled() const;
+    void set_flow_field_enabled(bool flow_field_enabled);
     virtual bool is_finished() const override;
 
     virtual const std::string& get_lua_type_name() const override;
@@ -48,11 +59,23 @@ class SOLARUS_API PathFindingMovement: public PathMovement {
 
     virtual void update() override;
     void recompute_movement();
+    bool get_computed_path(std::string& path);
+    std::string compute_flow_field_path();
 
   private:
 
+    void start_path(const std::string& path);
+
+    static constexpr int max_target_move = 16;  /**< Distance the target can move before an
+                                                 * asynchronous result is considered obsolete. */
+
     EntityPtr target;               /**< the entity targeted by this movement (usually the hero) */
     uint32_t next_recomputation_date;
+    bool flow_field_enabled;        /**< whether the path is read from a flow field shared
+                                     * with other entities chasing the same target */
+    Point path_end;                 /**< where the current path should end, or (-1,-1) if unknown */
+    AsyncPathFinding::RequestPtr
+        path_request;               /**< path being computed by a worker thread, if any */
 
 };
 
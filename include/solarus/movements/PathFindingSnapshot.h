@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_PATH_FINDING_SNAPSHOT_H
+#define SOLARUS_PATH_FINDING_SNAPSHOT_H
+
+#include "solarus/Common.h"
+#include "solarus/entities/Ground.h"
+#include "solarus/entities/Layer.h"
+#include "solarus/lowlevel/Point.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include <cstdint>
+#include <vector>
+
+namespace Solarus {
+
+class Entity;
+
+/**
+ * \brief Copy of the obstacles around a path finding query.
+ *
+ * The snapshot is made on the main thread and never changes afterwards,
+ * so that the path can be searched in another thread while the map
+ * keeps changing.
+ * It contains the grounds of tiles and ground modifiers and the boxes
+ * of obstacle entities in the area that a local A* search may explore.
+ * Collisions are tested exactly like
+ * Map::test_collision_with_obstacles() would have done at the time of
+ * the snapshot.
+ */
+class SOLARUS_API PathFindingSnapshot {
+
+  public:
+
+    PathFindingSnapshot(Entity& source_entity, const Point& source, const Point& target);
+
+    Layer get_layer() const;
+    const Point& get_source() const;
+    const Point& get_target() const;
+    int get_map_width() const;
+    int get_map_height() const;
+    uint32_t get_terrain_version() const;
+
+    bool test_collision_with_obstacles(const Rectangle& collision_box) const;
+
+    static constexpr int margin = 224;  /**< Distance around the target covered by the snapshot. */
+
+  private:
+
+    /**
+     * \brief Ground of a ground modifier entity.
+     */
+    struct GroundModifier {
+      Rectangle box;                  /**< Bounding box of the entity. */
+      Ground ground;                  /**< Ground it sets. */
+    };
+
+    Ground get_ground(int x, int y) const;
+    bool test_collision_with_ground(int x, int y, bool& found_diagonal_wall) const;
+
+    Layer layer;                      /**< Layer of the source entity. */
+    Point source;                     /**< Location of the source node. */
+    Point target;                     /**< Location of the target node. */
+    int map_width;                    /**< Width of the map in pixels. */
+    int map_height;                   /**< Height of the map in pixels. */
+    uint32_t terrain_version;         /**< Version of the terrain of the map when copied. */
+    uint32_t obstacle_grounds;        /**< Bits of the grounds that are obstacles for the source entity. */
+    Rectangle area;                   /**< Part of the map copied, aligned on the 8x8 grid. */
+    std::vector<Ground> tile_grounds; /**< Ground of tiles for each 8x8 square of the area. */
+    std::vector<GroundModifier>
+        ground_modifiers;             /**< Enabled ground modifiers of the area, in the order of the map. */
+    std::vector<Rectangle>
+        obstacle_boxes;               /**< Bounding boxes of entities that are obstacles for the source entity. */
+
+};
+
+}
+
+#endif
+
@@ -74,6 +74,7 @@ class StraightMovement: public Movement {
     void update_y();
     void update_smooth_y();
     void update_non_smooth_y();
+    bool update_several_steps(uint32_t now);
 
   private:
 
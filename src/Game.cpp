@@ -22,6 +22,7 @@
 #include "solarus/entities/Tileset.h"
 #include "solarus/lowlevel/Color.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/MemoryStats.h"
 #include "solarus/lowlevel/Music.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/lowlevel/Video.h"
@@ -35,6 +36,7 @@
 #include "solarus/Savegame.h"
 #include "solarus/Treasure.h"
 #include "solarus/TransitionFade.h"
+#include <iostream>
 #include <map>
 
 namespace Solarus {
@@ -612,6 +614,10 @@ void Game::notify_map_changed() {
 
   // Notify the equipment.
   get_equipment().notify_map_changed(*current_map);
+
+  // Show where memory goes, to help keeping maps within budgets.
+  std::cout << "Memory on map '" << current_map->get_id() << "': "
+      << MemoryStats::get_report(get_lua_context().get_heap_size()) << std::endl;
 }
 
 /**
@@ -17,13 +17,20 @@
 #include "solarus/entities/TilePattern.h"
 #include "solarus/lowlevel/Color.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/InputRecorder.h"
+#include "solarus/lowlevel/InputReplayer.h"
 #include "solarus/lowlevel/Music.h"
 #include "solarus/lowlevel/Output.h"
+#include "solarus/lowlevel/Profiler.h"
 #include "solarus/lowlevel/QuestFiles.h"
+#include "solarus/lowlevel/Random.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/lowlevel/System.h"
 #include "solarus/lowlevel/Video.h"
 #include "solarus/lua/LuaContext.h"
+#include "solarus/lua/LuaProfiler.h"
+#include "solarus/movements/AsyncPathFinding.h"
+#include "solarus/Arguments.h"
 #include "solarus/CurrentQuest.h"
 #include "solarus/Game.h"
 #include "solarus/QuestProperties.h"
@@ -31,6 +38,7 @@
 #include "solarus/Savegame.h"
 #include "solarus/Settings.h"
 #include <lua.hpp>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -90,14 +98,60 @@ MainLoop::MainLoop(const Arguments& args):
   root_surface(nullptr),
   game(nullptr),
   next_game(nullptr),
-  exiting(false) {
+  exiting(false),
+  num_steps(0),
+  turbo(args.has_argument("-turbo")),
+  turbo_draw_interval(10),
+  input_recorder(nullptr),
+  input_replayer(nullptr),
+  frame_stats() {
 
   Output::initialize(args);
   std::cout << "Solarus " << SOLARUS_VERSION << std::endl;
 
+  // Check the turbo mode options.
+  const std::string& turbo_draw_interval_string =
+      args.get_argument_value("-turbo-draw-interval");
+  if (!turbo_draw_interval_string.empty()) {
+    std::istringstream iss(turbo_draw_interval_string);
+    if (!(iss >> turbo_draw_interval) || turbo_draw_interval < 0) {
+      Debug::error("Invalid turbo draw interval: '" + turbo_draw_interval_string + "'");
+      turbo_draw_interval = 10;
+    }
+  }
+
+  // Start profiling if requested.
+  Profiler::initialize(args);
+  LuaProfiler::initialize(args);
+
   // Initialize basic features (input, audio, video, files...).
   System::initialize(args);
 
+  // Start path finding threads if requested.
+  AsyncPathFinding::initialize(args);
+
+  // Record or replay input events if requested.
+  const std::string& replay_file_name = args.get_argument_value("-replay-input");
+  const std::string& record_file_name = args.get_argument_value("-record-input");
+  if (!replay_file_name.empty()) {
+    input_replayer = std::unique_ptr<InputReplayer>(new InputReplayer(replay_file_name));
+    if (input_replayer->is_valid()) {
+      Random::set_seed(input_replayer->get_seed());
+    }
+    else {
+      input_replayer = nullptr;
+    }
+  }
+  else if (!record_file_name.empty()) {
+    input_recorder = std::unique_ptr<InputRecorder>(
+        new InputRecorder(record_file_name, Random::get_seed())
+    );
+    if (!input_recorder->is_valid()) {
+      Debug::error("Cannot write input recording file '" + record_file_name + "'");
+      input_recorder = nullptr;
+    }
+  }
+
   // Read the quest general properties.
   load_quest_properties();
 
@@ -136,12 +190,26 @@ MainLoop::~MainLoop() {
   root_surface = nullptr;
 
   lua_context->exit();
+  if (input_recorder != nullptr) {
+    input_recorder->finish(num_steps);
+  }
+  LuaProfiler::quit();
+  AsyncPathFinding::quit();
   TilePattern::quit();
   CurrentQuest::quit();
   System::quit();
+  Profiler::quit();
   Output::quit();
 }
 
+/**
+ * \brief Returns the statistics of frame durations measured by run().
+ * \return The frame statistics.
+ */
+const FrameStats& MainLoop::get_frame_stats() const {
+  return frame_stats;
+}
+
 /**
  * \brief Returns the shared Lua context.
  * \return The Lua context where all scripts are run.
@@ -216,12 +284,21 @@ void MainLoop::set_game(Game* game) {
  */
 void MainLoop::run() {
 
+  if (turbo) {
+    run_turbo();
+    return;
+  }
+
   // Main loop.
   std::cout << "Simulation started" << std::endl;
 
-  uint32_t last_frame_date = System::get_real_time();
-  uint32_t lag = 0;  // Lose time of the simulation to catch up.
-  uint32_t time_dropped = 0;  // Time that won't be caught up.
+  // Dates and durations are in microseconds to avoid rounding the lag.
+  const uint64_t timestep = System::timestep * 1000;
+  uint64_t last_frame_date = System::get_real_time_us();
+  uint64_t last_draw_date = last_frame_date;
+  uint64_t lag = 0;  // Lose time of the simulation to catch up.
+  uint64_t time_dropped = 0;  // Time that won't be caught up.
+  frame_stats.clear();
 
   // The main loop basically repeats
   // check_input(), update(), draw() and sleep().
@@ -229,51 +306,109 @@ void MainLoop::run() {
   while (!is_exiting()) {
 
     // Measure the time of the last iteration.
-    uint32_t now = System::get_real_time() - time_dropped;
-    uint32_t last_frame_duration = now - last_frame_date;
+    uint64_t now = System::get_real_time_us() - time_dropped;
+    uint64_t last_frame_duration = now - last_frame_date;
     last_frame_date = now;
     lag += last_frame_duration;
     // At this point, lag represents how much late the simulated time with
     // compared to the real time.
 
-    if (lag >= 200) {
+    if (lag >= 200000) {
       // Huge lag: don't try to catch up.
       // Maybe we have just made a one-time heavy operation like loading a
       // big file, or the process was just unsuspended.
       // Let's fake the real time instead.
-      time_dropped += lag - System::timestep;
-      lag = System::timestep;
-      last_frame_date = System::get_real_time() - time_dropped;
+      time_dropped += lag - timestep;
+      lag = timestep;
+      last_frame_date = System::get_real_time_us() - time_dropped;
+      last_draw_date = last_frame_date;
     }
 
     // 1. Detect and handle input events.
-    check_input();
+    {
+      Profiler::Zone zone("MainLoop::check_input");
+      check_input();
+    }
 
     // 2. Update the world once, or several times (skipping some draws)
     // to catch up if the system is slow.
     int num_updates = 0;
-    while (lag >= System::timestep
-        && num_updates < 10  // To draw sometimes anyway on very slow systems.
-        && !is_exiting()) {
-      step();
-      lag -= System::timestep;
-      ++num_updates;
+    {
+      Profiler::Zone zone("MainLoop::update");
+      while (lag >= timestep
+          && num_updates < 10  // To draw sometimes anyway on very slow systems.
+          && !is_exiting()) {
+        step();
+        lag -= timestep;
+        ++num_updates;
+      }
     }
 
     // 3. Redraw the screen.
     if (num_updates > 0) {
+      Profiler::Zone zone("MainLoop::draw");
       draw();
+      const uint64_t draw_date = System::get_real_time_us() - time_dropped;
+      frame_stats.add_frame(draw_date - last_draw_date);
+      last_draw_date = draw_date;
     }
 
     // 4. Sleep if we have time, to save CPU and GPU cycles.
-    last_frame_duration = (System::get_real_time() - time_dropped) - last_frame_date;
-    if (last_frame_duration < System::timestep) {
-      System::sleep(System::timestep - last_frame_duration);
+    // The next iteration starts when the lag reaches one timestep again.
+    const uint64_t next_frame_date = last_frame_date + timestep - std::min(lag, timestep);
+    if (System::get_real_time_us() - time_dropped < next_frame_date) {
+      Profiler::Zone zone("MainLoop::sleep");
+      System::wait_until_us(next_frame_date + time_dropped);
     }
   }
   std::cout << "Simulation finished" << std::endl;
 }
 
+/**
+ * \brief Runs the main loop as fast as possible until the user requests to
+ * stop the program (option -turbo).
+ *
+ * Steps are executed back-to-back without sleeping: the simulated time still
+ * advances by exactly one timestep per step, but is no longer tied to the
+ * real time.
+ * The screen is only redrawn every turbo_draw_interval steps, and never if
+ * the video is disabled.
+ * This is useful to simulate long play sessions in a short time.
+ */
+void MainLoop::run_turbo() {
+
+  std::cout << "Simulation started (turbo mode)" << std::endl;
+
+  const uint32_t start_date = System::get_real_time();
+  const uint32_t start_simulated_date = System::now();
+  const uint32_t start_num_steps = num_steps;
+  const bool draw_enabled = turbo_draw_interval > 0 && !Video::is_disabled();
+
+  while (!is_exiting()) {
+
+    {
+      Profiler::Zone zone("MainLoop::check_input");
+      check_input();
+    }
+
+    {
+      Profiler::Zone zone("MainLoop::update");
+      step();
+    }
+
+    if (draw_enabled && (num_steps - start_num_steps) % turbo_draw_interval == 0) {
+      Profiler::Zone zone("MainLoop::draw");
+      draw();
+    }
+  }
+
+  const uint32_t real_duration = System::get_real_time() - start_date;
+  const uint32_t simulated_duration = System::now() - start_simulated_date;
+  std::cout << "Simulation finished: " << num_steps - start_num_steps << " steps, "
+      << simulated_duration << " ms simulated in "
+      << real_duration << " ms" << std::endl;
+}
+
 /**
  * \brief Advances the simulation of one tick.
  *
@@ -281,7 +416,18 @@ void MainLoop::run() {
  * Otherwise, use run() to execute the standard main loop.
  */
 void MainLoop::step() {
+
+  if (input_replayer != nullptr) {
+    replay_input();
+  }
+
   update();
+  ++num_steps;
+
+  if (input_replayer != nullptr && input_replayer->is_finished(num_steps)) {
+    std::cout << "Input replay finished after " << num_steps << " steps" << std::endl;
+    set_exiting();
+  }
 }
 
 /**
@@ -291,11 +437,36 @@ void MainLoop::check_input() {
 
   std::unique_ptr<InputEvent> event = InputEvent::get_event();
   while (event != nullptr) {
-    notify_input(*event);
+    if (input_replayer != nullptr) {
+      // Live events are ignored while replaying, except closing the window.
+      if (event->is_window_closing()) {
+        set_exiting();
+      }
+    }
+    else {
+      if (input_recorder != nullptr) {
+        input_recorder->record(num_steps, *event);
+      }
+      notify_input(*event);
+    }
     event = InputEvent::get_event();
   }
 }
 
+/**
+ * \brief Handles the recorded input events of the current step.
+ *
+ * This function is called at each step when replaying input events.
+ */
+void MainLoop::replay_input() {
+
+  std::unique_ptr<InputEvent> event = input_replayer->get_event(num_steps);
+  while (event != nullptr) {
+    notify_input(*event);
+    event = input_replayer->get_event(num_steps);
+  }
+}
+
 /**
  * \brief This function is called when there is an input event.
  *
@@ -332,9 +503,13 @@ void MainLoop::notify_input(const InputEvent& event) {
 void MainLoop::update() {
 
   if (game != nullptr) {
+    Profiler::Zone zone("Game::update");
     game->update();
   }
-  lua_context->update();
+  {
+    Profiler::Zone zone("LuaContext::update");
+    lua_context->update();
+  }
   System::update();
 
   // go to another game?
@@ -357,6 +532,7 @@ void MainLoop::update() {
  * \brief Redraws the current screen.
  *
  * This function is called repeatedly by the main loop.
+ * Like step(), you can also call it yourself if you don't use run().
  */
 void MainLoop::draw() {
 
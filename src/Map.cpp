@@ -21,6 +21,7 @@
 #include "solarus/entities/Hero.h"
 #include "solarus/entities/MapEntities.h"
 #include "solarus/lowlevel/Music.h"
+#include "solarus/lowlevel/Profiler.h"
 #include "solarus/entities/NonAnimatedRegions.h"
 #include "solarus/entities/TilePattern.h"
 #include "solarus/entities/Tileset.h"
@@ -34,6 +35,7 @@
 #include "solarus/Savegame.h"
 #include "solarus/Sprite.h"
 #include <list>
+#include <vector>
 
 namespace Solarus {
 
@@ -509,6 +511,8 @@ bool Map::notify_input(const InputEvent& event) {
  */
 void Map::update() {
 
+  Profiler::Zone zone("Map::update");
+
   // detect whether the game has just been suspended or resumed
   check_suspended();
 
@@ -870,11 +874,11 @@ bool Map::test_collision_with_entities(
     const Rectangle& collision_box,
     Entity& entity_to_check) const {
 
-  // TODO use the quadtree
-  const std::list<Entity*>& obstacle_entities =
-      entities->get_obstacle_entities(layer);
+  // Obstacle callbacks may move entities: don't iterate the tree directly.
+  VectorPool<Entity*>::Borrowed obstacle_entities(obstacles_nearby_pool);
+  entities->get_obstacle_entities_in_rectangle(layer, collision_box, obstacle_entities.get());
 
-  for (Entity* entity: obstacle_entities) {
+  for (Entity* entity: obstacle_entities.get()) {
 
     if (entity->overlaps(collision_box)
         && entity->is_obstacle_for(entity_to_check, collision_box)
@@ -900,11 +904,109 @@ bool Map::test_collision_with_obstacles(
     const Rectangle& collision_box,
     Entity& entity_to_check) const {
 
+  // Collisions with the terrain
+  // (i.e., tiles and dynamic entities that may change it).
+  if (test_collision_with_terrain(layer, collision_box, entity_to_check)) {
+    return true;
+  }
+
+  // No collision with the terrain: check collisions with dynamic entities.
+  return test_collision_with_entities(layer, collision_box, entity_to_check);
+}
+
+/**
+ * \brief Returns how many pixels a rectangle can be moved in a direction
+ * before it collides with the map obstacles.
+ *
+ * This is equivalent to calling test_collision_with_obstacles() for each
+ * position along the way and stopping at the first obstacle,
+ * but obstacle entities are only looked up once for the whole swept area.
+ *
+ * \param layer Layer of the rectangle in the map.
+ * \param collision_box The rectangle to move (its dimensions should be
+ * multiples of 8).
+ * \param direction The move of one step: each coordinate must be
+ * -1, 0 or 1.
+ * \param max_distance Maximum number of steps to check.
+ * \param entity_to_check The entity to check (used to decide what is
+ * considered as obstacle).
+ * \return The number of steps that can be made without overlapping
+ * an obstacle, between 0 and \c max_distance.
+ */
+int Map::get_obstacle_free_distance(
+    Layer layer,
+    const Rectangle& collision_box,
+    const Point& direction,
+    int max_distance,
+    Entity& entity_to_check) const {
+
+  Debug::check_assertion(
+      direction.x >= -1 && direction.x <= 1 && direction.y >= -1 && direction.y <= 1,
+      "Invalid direction of obstacle query"
+  );
+
+  if (max_distance <= 0 || direction == Point()) {
+    return max_distance;
+  }
+
+  Rectangle last_box = collision_box;
+  last_box.add_xy(direction * max_distance);
+  const Rectangle swept_box = collision_box | last_box;
+
+  // Obstacle callbacks may move entities: don't iterate the tree directly.
+  VectorPool<Entity*>::Borrowed obstacle_entities(obstacles_nearby_pool);
+  entities->get_obstacle_entities_in_rectangle(layer, swept_box, obstacle_entities.get());
+
+  Rectangle box = collision_box;
+  for (int distance = 1; distance <= max_distance; ++distance) {
+
+    box.add_xy(direction);
+
+    if (test_collision_with_terrain(layer, box, entity_to_check)) {
+      return distance - 1;
+    }
+
+    for (Entity* entity: obstacle_entities.get()) {
+      if (entity->overlaps(box)
+          && entity->is_obstacle_for(entity_to_check, box)
+          && entity->is_enabled()
+          && entity != &entity_to_check) {
+        return distance - 1;
+      }
+    }
+  }
+
+  return max_distance;
+}
+
+/**
+ * \brief Tests whether a rectangle collides with the terrain, that is,
+ * the ground of tiles and of dynamic entities that modify it.
+ * \param layer Layer of the rectangle in the map.
+ * \param collision_box The rectangle to check (its dimensions should be
+ * multiples of 8).
+ * \param entity_to_check The entity to check (used to decide what
+ * grounds are considered as obstacle).
+ * \return \c true if the rectangle is overlapping an obstacle ground.
+ */
+bool Map::test_collision_with_terrain(
+    Layer layer,
+    const Rectangle& collision_box,
+    const Entity& entity_to_check) const {
+
   // This function is called very often.
   // For performance reasons, we only check the border of the of the collision box.
 
-  // Collisions with the terrain
-  // (i.e., tiles and dynamic entities that may change it).
+  // Usually, the tile ground bitmaps are enough to decide.
+  bool decided = false;
+  const bool collision = test_collision_with_ground_bitmaps(
+      layer, collision_box, entity_to_check, decided
+  );
+  if (decided) {
+    return collision;
+  }
+
+  // Check the terrain point by point.
   const int x1 = collision_box.get_x();
   const int x2 = x1 + collision_box.get_width() - 1;
   const int y1 = collision_box.get_y();
@@ -955,8 +1057,109 @@ bool Map::test_collision_with_obstacles(
     }
   }
 
-  // No collision with the terrain: check collisions with dynamic entities.
-  return test_collision_with_entities(layer, collision_box, entity_to_check);
+  return false;
+}
+
+/**
+ * \brief Tests whether the border of a rectangle collides with the tile
+ * grounds, using the ground bitmaps of the map.
+ *
+ * This tests whole rows and columns of 8x8 squares at once instead of
+ * individual points.
+ * It gives the same result as the point by point check of
+ * test_collision_with_obstacles(), but it cannot decide when a
+ * diagonal wall or a dynamic entity that modifies the ground is involved.
+ *
+ * \param layer Layer of the rectangle in the map.
+ * \param collision_box The rectangle to check.
+ * \param entity_to_check The entity to check (used to decide what grounds are
+ * considered as obstacle).
+ * \param[out] decided \c true if the result is known, \c false if
+ * points have to be checked one by one.
+ * \return \c true if the border of the rectangle is on an obstacle ground.
+ */
+bool Map::test_collision_with_ground_bitmaps(
+    Layer layer,
+    const Rectangle& collision_box,
+    const Entity& entity_to_check,
+    bool& decided) const {
+
+  // Points checked are the extremities of each 8-pixel segment of the
+  // border, so they can go up to 7 pixels beyond the right and bottom sides.
+  const int x1 = collision_box.get_x();
+  const int x2 = x1 + collision_box.get_width() - 1;
+  const int x3 = x1 + ((collision_box.get_width() - 1) / 8) * 8 + 7;
+  const int y1 = collision_box.get_y();
+  const int y2 = y1 + collision_box.get_height() - 1;
+  const int y3 = y1 + ((collision_box.get_height() - 1) / 8) * 8 + 7;
+
+  // Outside the map, this is an obstacle.
+  if (x1 < 0 || y1 < 0 || x3 >= get_width() || y3 >= get_height()) {
+    decided = true;
+    return true;
+  }
+
+  // Dynamic entities that change the ground hide the tile ground.
+  const Rectangle checked_area(x1, y1, x3 - x1 + 1, y3 - y1 + 1);
+  for (const Entity* ground_modifier: entities->get_ground_modifiers(layer)) {
+    if (ground_modifier->get_modified_ground() != Ground::EMPTY
+        && ground_modifier->overlaps(checked_area)
+        && ground_modifier->is_enabled()
+        && !ground_modifier->is_being_removed()) {
+      decided = false;
+      return false;
+    }
+  }
+
+  const GroundBitmaps& bitmaps = entities->get_tile_ground_bitmaps(layer);
+  const uint32_t grounds =
+      bitmaps.get_grounds_in_row(y1 >> 3, x1 >> 3, x3 >> 3)
+      | bitmaps.get_grounds_in_row(y2 >> 3, x1 >> 3, x3 >> 3)
+      | bitmaps.get_grounds_in_column(x1 >> 3, y1 >> 3, y3 >> 3)
+      | bitmaps.get_grounds_in_column(x2 >> 3, y1 >> 3, y3 >> 3);
+
+  if (grounds == 0) {
+    decided = true;
+    return false;
+  }
+
+  // Diagonal walls need the position of each point in the square.
+  const uint32_t diagonal_grounds =
+      GroundBitmaps::get_ground_bit(Ground::WALL_TOP_RIGHT)
+      | GroundBitmaps::get_ground_bit(Ground::WALL_TOP_LEFT)
+      | GroundBitmaps::get_ground_bit(Ground::WALL_BOTTOM_LEFT)
+      | GroundBitmaps::get_ground_bit(Ground::WALL_BOTTOM_RIGHT)
+      | GroundBitmaps::get_ground_bit(Ground::WALL_TOP_RIGHT_WATER)
+      | GroundBitmaps::get_ground_bit(Ground::WALL_TOP_LEFT_WATER)
+      | GroundBitmaps::get_ground_bit(Ground::WALL_BOTTOM_LEFT_WATER)
+      | GroundBitmaps::get_ground_bit(Ground::WALL_BOTTOM_RIGHT_WATER);
+  if ((grounds & diagonal_grounds) != 0) {
+    decided = false;
+    return false;
+  }
+
+  decided = true;
+  if ((grounds & GroundBitmaps::get_ground_bit(Ground::WALL)) != 0) {
+    return true;
+  }
+
+  // Only ask the entity about grounds actually present.
+  const Ground conditional_grounds[] = {
+      Ground::LOW_WALL,
+      Ground::SHALLOW_WATER,
+      Ground::DEEP_WATER,
+      Ground::HOLE,
+      Ground::LAVA,
+      Ground::PRICKLE,
+      Ground::LADDER
+  };
+  for (Ground ground: conditional_grounds) {
+    if ((grounds & GroundBitmaps::get_ground_bit(ground)) != 0
+        && entity_to_check.is_ground_obstacle(ground)) {
+      return true;
+    }
+  }
+  return false;
 }
 
 /**
@@ -1097,6 +1300,10 @@ Ground Map::get_ground(Layer layer, const Point& xy) const {
  * when this entity has just moved on the map, or when a detector
  * wants to check this entity.
  * We check whether or not the entity overlaps an entity detector.
+ * Then, pixel-precise collisions are checked for each sprite of the entity
+ * that has them enabled.
+ * Only detectors interested in each kind of collision are considered,
+ * and detectors of pixel-precise collisions are looked up once for all sprites.
  * If the map is suspended, this function does nothing.
  *
  * \param entity The entity that has just moved (this entity should have
@@ -1115,16 +1322,12 @@ void Map::check_collision_with_detectors(Entity& entity) {
   // Check this entity with each detector.
 
   // Extend the box because some collision tests work without overlapping.
+  // Detectors are copied first because collision callbacks may move them.
   Rectangle box = entity.get_extended_bounding_box(8);
-  std::vector<EntityPtr> entities_nearby;
-  entities->get_entities_in_rectangle(box, entities_nearby);
-  for (const EntityPtr& entity_nearby: entities_nearby) {
+  VectorPool<EntityPtr>::Borrowed detectors_nearby(entities_nearby_pool);
+  entities->get_detectors_in_rectangle(box, false, detectors_nearby.get());
+  for (const EntityPtr& entity_nearby: detectors_nearby.get()) {
 
-    if (!entity_nearby->is_detector()) {
-      // TODO we can probably get rid of the Detector class.
-      // Most entities are detectors anyway.
-      continue;
-    }
     Detector& detector_nearby = *std::static_pointer_cast<Detector>(entity_nearby);
     if (detector_nearby.is_enabled()
         && !detector_nearby.is_suspended()
@@ -1132,6 +1335,42 @@ void Map::check_collision_with_detectors(Entity& entity) {
       detector_nearby.check_collision(entity);
     }
   }
+
+  // Detect pixel-precise collisions.
+  // All sprites share the same candidates: query them only once.
+  bool pixel_collisions = false;
+  for (const SpritePtr& sprite: entity.get_sprites()) {
+    if (sprite->are_pixel_collisions_enabled()) {
+      pixel_collisions = true;
+      break;
+    }
+  }
+  if (!pixel_collisions) {
+    return;
+  }
+
+  VectorPool<EntityPtr>::Borrowed sprite_detectors_nearby(entities_nearby_pool);
+  entities->get_detectors_in_rectangle(
+      entity.get_max_bounding_box(), true, sprite_detectors_nearby.get()
+  );
+  for (const SpritePtr& sprite: entity.get_sprites()) {
+    if (suspended) {
+      return;
+    }
+    if (!sprite->are_pixel_collisions_enabled()) {
+      continue;
+    }
+    for (const EntityPtr& entity_nearby: sprite_detectors_nearby.get()) {
+
+      Detector& detector_nearby = *std::static_pointer_cast<Detector>(entity_nearby);
+
+      if (!detector_nearby.is_being_removed()
+          && !detector_nearby.is_suspended()
+          && detector_nearby.is_enabled()) {
+        detector_nearby.check_collision(entity, *sprite);
+      }
+    }
+  }
 }
 
 /**
@@ -1158,9 +1397,14 @@ void Map::check_collision_from_detector(Detector& detector) {
 
   // Check each entity with this detector.
   Rectangle box = detector.get_extended_bounding_box(8);
-  std::vector<EntityPtr> entities_nearby;
-  entities->get_entities_in_rectangle(box, entities_nearby);
-  for (const EntityPtr& entity_nearby: entities_nearby) {
+  if ((detector.get_collision_modes() & COLLISION_CUSTOM) != 0) {
+    // Custom tests may detect entities anywhere in the box the detector
+    // is indexed with, like when these entities move.
+    box |= detector.get_max_bounding_box();
+  }
+  VectorPool<EntityPtr>::Borrowed entities_nearby(entities_nearby_pool);
+  entities->get_entities_in_rectangle(box, entities_nearby.get());
+  for (const EntityPtr& entity_nearby: entities_nearby.get()) {
 
     if (entity_nearby->is_enabled()
         && !entity_nearby->is_suspended()
@@ -1192,13 +1436,10 @@ void Map::check_collision_with_detectors(Entity& entity, Sprite& sprite) {
 
   // Check each detector.
   Rectangle box = entity.get_max_bounding_box();
-  std::vector<EntityPtr> entities_nearby;
-  entities->get_entities_in_rectangle(box, entities_nearby);
-  for (const EntityPtr& entity_nearby: entities_nearby) {
+  VectorPool<EntityPtr>::Borrowed detectors_nearby(entities_nearby_pool);
+  entities->get_detectors_in_rectangle(box, true, detectors_nearby.get());
+  for (const EntityPtr& entity_nearby: detectors_nearby.get()) {
 
-    if (!entity_nearby->is_detector()) {
-      continue;
-    }
     Detector& detector_nearby = *std::static_pointer_cast<Detector>(entity_nearby);
 
     if (!detector_nearby.is_being_removed()
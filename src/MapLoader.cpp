@@ -84,6 +84,7 @@ void MapLoader::load_map(Game& game, Map& map) {
     for (int i = 0; i < entities.tiles_grid_size; ++i) {
       entities.tiles_ground[layer].push_back(initial_ground);
     }
+    entities.tiles_ground_bitmaps[layer].initialize(map.width8, map.height8);
 
     entities.non_animated_regions[layer] = std::unique_ptr<NonAnimatedRegions>(
         new NonAnimatedRegions(map, Layer(layer))
@@ -93,6 +94,11 @@ void MapLoader::load_map(Game& game, Map& map) {
   const int margin = 64;
   Rectangle quadtree_space(-margin, -margin, map.get_width() + 2 * margin, map.get_height() + 2 * margin);
   entities.quadtree.initialize(quadtree_space);
+  entities.simple_detector_tree.initialize(quadtree_space);
+  entities.sprite_detector_tree.initialize(quadtree_space);
+  for (int layer = 0; layer < LAYER_NB; ++layer) {
+    entities.obstacle_trees[layer].initialize(quadtree_space);
+  }
 
   entities.boomerang = nullptr;
   map.camera = std::make_shared<Camera>(map);
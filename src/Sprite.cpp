@@ -34,6 +34,8 @@
 namespace Solarus {
 
 std::map<std::string, SpriteAnimationSet*> Sprite::all_animation_sets;
+std::map<std::string, std::map<std::tuple<int, int, int, int>, std::shared_ptr<const PixelBits>>>
+    Sprite::all_pixel_bits;
 
 /**
  * \brief Initializes the sprites system.
@@ -51,6 +53,33 @@ void Sprite::quit() {
     delete kvp.second;
   }
   all_animation_sets.clear();
+  all_pixel_bits.clear();
+}
+
+/**
+ * \brief Returns the pixel collision mask of a frame of an image.
+ *
+ * Masks are computed only once for each image and frame rectangle,
+ * and then shared by all animations that use them.
+ *
+ * \param image_id An id identifying the image in the quest,
+ * like its file name.
+ * \param image The image, used if the mask is not built yet.
+ * \param frame Position of the frame in the image.
+ * \return The mask of non-transparent pixels of this frame.
+ */
+std::shared_ptr<const PixelBits> Sprite::get_pixel_bits(
+    const std::string& image_id,
+    Surface& image,
+    const Rectangle& frame) {
+
+  std::shared_ptr<const PixelBits>& pixel_bits = all_pixel_bits[image_id][
+      std::make_tuple(frame.get_x(), frame.get_y(), frame.get_width(), frame.get_height())
+  ];
+  if (pixel_bits == nullptr) {
+    pixel_bits = std::make_shared<const PixelBits>(image, frame);
+  }
+  return pixel_bits;
 }
 
 /**
@@ -38,6 +38,7 @@ SpriteAnimation::SpriteAnimation(
     int loop_on_frame):
 
   src_image(nullptr),
+  src_image_id(),
   src_image_is_tileset(image_file_name == "tileset"),
   directions(directions),
   frame_delay(frame_delay),
@@ -50,6 +51,7 @@ SpriteAnimation::SpriteAnimation(
     // However, sprite animation sets are already cached so the gain might
     // not be significant.
     src_image = Surface::create(image_file_name);
+    src_image_id = "sprites/" + image_file_name;
     Debug::check_assertion(src_image != nullptr,
         std::string("Cannot load image '" + image_file_name + "'")
     );
@@ -71,6 +73,7 @@ void SpriteAnimation::set_tileset(Tileset& tileset) {
   }
 
   src_image = tileset.get_entities_image();
+  src_image_id = "tilesets/" + tileset.get_id() + ".entities.png";
   if (should_enable_pixel_collisions) {
     disable_pixel_collisions(); // to force creating the images again
     do_enable_pixel_collisions();
@@ -177,7 +180,7 @@ void SpriteAnimation::enable_pixel_collisions() {
 void SpriteAnimation::do_enable_pixel_collisions() {
 
   for (SpriteAnimationDirection& direction: directions) {
-    direction.enable_pixel_collisions(*src_image);
+    direction.enable_pixel_collisions(*src_image, src_image_id);
   }
 }
 
@@ -199,5 +202,18 @@ bool SpriteAnimation::are_pixel_collisions_enabled() const {
   return directions[0].are_pixel_collisions_enabled() || should_enable_pixel_collisions;
 }
 
+/**
+ * \brief Returns the memory used by the image of this animation.
+ * \return The size of the image in bytes, or 0 if the image comes from
+ * the tileset.
+ */
+int64_t SpriteAnimation::get_memory_size() const {
+
+  if (src_image_is_tileset || src_image == nullptr) {
+    return 0;
+  }
+  return src_image->get_memory_size();
+}
+
 }
 
@@ -15,6 +15,7 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "solarus/SpriteAnimationDirection.h"
+#include "solarus/Sprite.h"
 #include "solarus/lowlevel/PixelBits.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/lowlevel/Debug.h"
@@ -104,12 +105,16 @@ void SpriteAnimationDirection::draw(Surface& dst_surface,
  * If the pixel-perfect collisions are already enabled, this function does nothing.
  *
  * \param src_image the surface containing the animations
+ * \param src_image_id file name of this surface, used to reuse the bit
+ * fields already computed for other animations using the same image
  */
-void SpriteAnimationDirection::enable_pixel_collisions(Surface& src_image) {
+void SpriteAnimationDirection::enable_pixel_collisions(
+    Surface& src_image,
+    const std::string& src_image_id) {
 
   if (!are_pixel_collisions_enabled()) {
     for (int i = 0; i < get_nb_frames(); i++) {
-      pixel_bits.emplace_back(src_image, frames[i]);
+      pixel_bits.push_back(Sprite::get_pixel_bits(src_image_id, src_image, frames[i]));
     }
   }
 }
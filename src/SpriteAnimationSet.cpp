@@ -19,6 +19,7 @@
 #include "solarus/SpriteAnimationDirection.h"
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/MemoryStats.h"
 #include "solarus/lowlevel/Rectangle.h"
 #include "solarus/lua/LuaTools.h"
 #include "solarus/SpriteData.h"
@@ -34,11 +35,20 @@ namespace Solarus {
  * (name of a sprite definition file, without the ".dat" extension).
  */
 SpriteAnimationSet::SpriteAnimationSet(const std::string& id):
-  id(id) {
+  id(id),
+  memory_size(0) {
 
   load();
 }
 
+/**
+ * \brief Destroys this animation set.
+ */
+SpriteAnimationSet::~SpriteAnimationSet() {
+
+  MemoryStats::remove(MemoryCategory::SPRITES, memory_size);
+}
+
 /**
  * \brief Attempts to load this animation set from its file.
  */
@@ -58,6 +68,11 @@ void SpriteAnimationSet::load() {
       add_animation(kvp.first, kvp.second);
     }
   }
+
+  for (const auto& kvp: animations) {
+    memory_size += kvp.second.get_memory_size();
+  }
+  MemoryStats::add(MemoryCategory::SPRITES, memory_size);
 }
 
 /**
@@ -33,9 +33,12 @@
 #include "solarus/entities/Stairs.h"
 #include "solarus/entities/Switch.h"
 #include "solarus/entities/Teletransporter.h"
+#include "solarus/lowlevel/Geometry.h"
 #include "solarus/lua/LuaContext.h"
 #include "solarus/Sprite.h"
 #include <lua.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace Solarus {
 
@@ -65,6 +68,11 @@ CustomEntity::CustomEntity(
       name, layer, xy, size
   ),
   model(model),
+  collision_tests(std::make_shared<const std::vector<CollisionInfo>>()),
+  successful_collision_tests_owner(),
+  successful_collision_tests(),
+  batched_collisions(),
+  collision_radius(-1),
   ground_observer(false),
   ground_modifier(false),
   modified_ground(Ground::EMPTY) {
@@ -178,6 +186,7 @@ void CustomEntity::set_traversable_by_entities(bool traversable) {
       get_lua_context(),
       traversable
   );
+  notify_traversable_by_entities_changed();
 }
 
 /**
@@ -198,6 +207,7 @@ void CustomEntity::set_traversable_by_entities(
       get_lua_context(),
       traversable_test_ref
   );
+  notify_traversable_by_entities_changed();
 }
 
 /**
@@ -212,6 +222,7 @@ void CustomEntity::set_traversable_by_entities(
 void CustomEntity::reset_traversable_by_entities() {
 
   traversable_by_entities_general = TraversableInfo();
+  notify_traversable_by_entities_changed();
 }
 
 /**
@@ -234,6 +245,7 @@ void CustomEntity::set_traversable_by_entities(
       get_lua_context(),
       traversable
   );
+  notify_traversable_by_entities_changed();
 }
 
 /**
@@ -256,6 +268,7 @@ void CustomEntity::set_traversable_by_entities(
       get_lua_context(),
       traversable_test_ref
   );
+  notify_traversable_by_entities_changed();
 }
 
 /**
@@ -272,6 +285,33 @@ void CustomEntity::set_traversable_by_entities(
 void CustomEntity::reset_traversable_by_entities(EntityType type) {
 
   traversable_by_entities_type.erase(type);
+  notify_traversable_by_entities_changed();
+}
+
+/**
+ * \brief Returns whether this custom entity has rules about which entities
+ * can traverse it.
+ *
+ * Without such rules, it is traversable by all entities.
+ *
+ * \return \c true if set_traversable_by_entities() was called for all types
+ * or for some type.
+ */
+bool CustomEntity::has_traversable_by_entities_rules() const {
+
+  return !traversable_by_entities_general.is_empty()
+      || !traversable_by_entities_type.empty();
+}
+
+/**
+ * \brief Notifies the map that the entities that can traverse this custom
+ * entity have changed.
+ */
+void CustomEntity::notify_traversable_by_entities_changed() {
+
+  if (is_on_map()) {
+    get_entities().notify_entity_obstacle_changed(*this);
+  }
 }
 
 /**
@@ -421,6 +461,22 @@ void CustomEntity::reset_can_traverse_entities(EntityType type) {
   can_traverse_entities_type.erase(type);
 }
 
+/**
+ * \brief Returns whether this custom entity has its own rules about which
+ * entities it can traverse.
+ *
+ * Without such rules, all custom entities see the same obstacles
+ * (except for grounds).
+ *
+ * \return \c true if set_can_traverse_entities() was called for all types
+ * or for some type.
+ */
+bool CustomEntity::has_can_traverse_entities_rules() const {
+
+  return !can_traverse_entities_general.is_empty()
+      || !can_traverse_entities_type.empty();
+}
+
 /**
  * \copydoc Entity::is_hero_obstacle
  */
@@ -735,11 +791,13 @@ void CustomEntity::add_collision_test(
     add_collision_mode(COLLISION_CUSTOM);
   }
 
-  collision_tests.emplace_back(
+  std::vector<CollisionInfo> tests = *collision_tests;
+  tests.emplace_back(
       get_lua_context(),
       collision_test,
       callback_ref
   );
+  set_collision_tests(tests);
 
   check_collision_with_detectors();
 }
@@ -759,11 +817,44 @@ void CustomEntity::add_collision_test(
 
   add_collision_mode(COLLISION_CUSTOM);
 
-  collision_tests.emplace_back(
+  std::vector<CollisionInfo> tests = *collision_tests;
+  tests.emplace_back(
       get_lua_context(),
       collision_test_ref,
       callback_ref
   );
+  set_collision_tests(tests);
+
+  check_collision_with_detectors();
+}
+
+/**
+ * \brief Registers a function to be called when a native collision test
+ * detects a collision.
+ *
+ * Unlike custom Lua collision tests, the test costs no Lua call.
+ * If the predicate is batched, the callback is called at most once per
+ * cycle with the list of all entities detected.
+ *
+ * \param predicate The conditions of the collision test.
+ * \param callback_ref Lua ref to a function to call when this collision is
+ * detected.
+ */
+void CustomEntity::add_collision_test(
+    const CollisionPredicate& predicate,
+    const ScopedLuaRef& callback_ref
+) {
+  Debug::check_assertion(!callback_ref.is_empty(), "Missing collision callback");
+
+  add_collision_mode(COLLISION_CUSTOM);
+
+  std::vector<CollisionInfo> tests = *collision_tests;
+  tests.emplace_back(
+      get_lua_context(),
+      predicate,
+      callback_ref
+  );
+  set_collision_tests(tests);
 
   check_collision_with_detectors();
 }
@@ -774,10 +865,55 @@ void CustomEntity::add_collision_test(
 void CustomEntity::clear_collision_tests() {
 
   // Disable all collisions checks.
-  collision_tests.clear();
+  set_collision_tests(std::vector<CollisionInfo>());
+  batched_collisions.clear();
   set_collision_modes(COLLISION_FACING);
 }
 
+/**
+ * \brief Replaces the collision tests.
+ *
+ * The previous list is not modified because collision tests running may
+ * still use it.
+ *
+ * \param collision_tests The new collision tests.
+ */
+void CustomEntity::set_collision_tests(const std::vector<CollisionInfo>& collision_tests) {
+
+  this->collision_tests = std::make_shared<const std::vector<CollisionInfo>>(collision_tests);
+
+  // The radius of native tests extends the area where entities are detected.
+  int radius = -1;
+  for (const CollisionInfo& info: collision_tests) {
+    if (info.has_predicate()) {
+      radius = std::max(radius, info.get_predicate().radius);
+    }
+  }
+
+  if (radius != collision_radius) {
+    collision_radius = radius;
+    notify_bounding_box_changed();
+  }
+}
+
+/**
+ * \copydoc Entity::get_max_bounding_box
+ *
+ * The box also includes the area where native collision tests with a radius
+ * can detect entities.
+ */
+Rectangle CustomEntity::get_max_bounding_box() const {
+
+  Rectangle box = Detector::get_max_bounding_box();
+  if (collision_radius > 0) {
+    Rectangle detection_box(get_center_point(), Size());
+    detection_box.add_xy(-collision_radius, -collision_radius);
+    detection_box.set_size(collision_radius * 2 + 1, collision_radius * 2 + 1);
+    box |= detection_box;
+  }
+  return box;
+}
+
 /**
  * \copydoc Detector::test_collision_custom
  */
@@ -790,59 +926,50 @@ bool CustomEntity::test_collision_custom(Entity& entity) {
 
   bool collision = false;
 
-  const std::vector<CollisionInfo> collision_tests = this->collision_tests;
-  for (const CollisionInfo& info: collision_tests) {
+  // Lua tests may change the collision tests: keep these ones alive.
+  const std::shared_ptr<const std::vector<CollisionInfo>> collision_tests = this->collision_tests;
+  for (const CollisionInfo& info: *collision_tests) {
 
+    bool detected = false;
     switch (info.get_built_in_test()) {
 
       case COLLISION_OVERLAPPING:
-        if (test_collision_rectangle(entity)) {
-          collision = true;
-          successful_collision_tests.push_back(info);
-        }
+        detected = test_collision_rectangle(entity);
         break;
 
       case COLLISION_CONTAINING:
-        if (test_collision_inside(entity)) {
-          collision = true;
-          successful_collision_tests.push_back(info);
-        }
+        detected = test_collision_inside(entity);
         break;
 
       case COLLISION_ORIGIN:
-        if (test_collision_origin_point(entity)) {
-          collision = true;
-          successful_collision_tests.push_back(info);
-        }
+        detected = test_collision_origin_point(entity);
         break;
 
       case COLLISION_FACING:
-        if (test_collision_facing_point(entity)) {
-          collision = true;
-          successful_collision_tests.push_back(info);
-        }
+        detected = test_collision_facing_point(entity);
         break;
 
       case COLLISION_TOUCHING:
-        if (test_collision_touching(entity)) {
-          collision = true;
-          successful_collision_tests.push_back(info);
-        }
+        detected = test_collision_touching(entity);
         break;
 
       case COLLISION_CENTER:
-        if (test_collision_center(entity)) {
-          collision = true;
-          successful_collision_tests.push_back(info);
-        }
+        detected = test_collision_center(entity);
         break;
 
       case COLLISION_CUSTOM:
-        if (get_lua_context().do_custom_entity_collision_test_function(
-              info.get_custom_test_ref(), *this, entity)
-        ) {
-          collision = true;
-          successful_collision_tests.push_back(info);
+        if (info.has_predicate()) {
+          detected = test_collision_predicate(info.get_predicate(), entity);
+          if (detected && info.get_predicate().batched) {
+            // The callback will be called later with other entities.
+            add_batched_collision(info, entity);
+            detected = false;
+          }
+        }
+        else {
+          detected = get_lua_context().do_custom_entity_collision_test_function(
+              info.get_custom_test_ref(), *this, entity
+          );
         }
         break;
 
@@ -854,11 +981,117 @@ bool CustomEntity::test_collision_custom(Entity& entity) {
         Debug::die("Invalid collision mode");
         break;
     }
+
+    if (detected) {
+      collision = true;
+      successful_collision_tests.push_back(&info);
+    }
+  }
+
+  if (collision) {
+    successful_collision_tests_owner = collision_tests;
   }
 
   return collision;
 }
 
+/**
+ * \brief Evaluates a native collision test.
+ * \param predicate The conditions to check.
+ * \param entity The entity to test.
+ * \return \c true if the entity satisfies all conditions.
+ */
+bool CustomEntity::test_collision_predicate(
+    const CollisionPredicate& predicate,
+    Entity& entity) const {
+
+  if (!predicate.entity_types.empty() &&
+      predicate.entity_types.find(entity.get_type()) == predicate.entity_types.end()) {
+    return false;
+  }
+
+  if (!predicate.layers.empty() &&
+      predicate.layers.find(entity.get_layer()) == predicate.layers.end()) {
+    return false;
+  }
+
+  const Point center = get_center_point();
+  const Point other_center = entity.get_center_point();
+
+  if (predicate.radius >= 0) {
+    const int dx = other_center.x - center.x;
+    const int dy = other_center.y - center.y;
+    if (dx * dx + dy * dy > predicate.radius * predicate.radius) {
+      return false;
+    }
+  }
+
+  if (predicate.facing_cone >= 0.0 && other_center != center) {
+    const double facing_angle = get_sprites_direction() * Geometry::PI_OVER_2;
+    double difference = std::fabs(Geometry::get_angle(center, other_center) - facing_angle);
+    if (difference > Geometry::PI) {
+      difference = Geometry::TWO_PI - difference;
+    }
+    if (difference > predicate.facing_cone / 2.0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * \brief Stores an entity detected by a batched collision test.
+ * \param info The batched collision test.
+ * \param entity The entity detected.
+ */
+void CustomEntity::add_batched_collision(const CollisionInfo& info, Entity& entity) {
+
+  EntityPtr shared_entity = std::static_pointer_cast<Entity>(entity.shared_from_this());
+
+  for (BatchedCollisions& batch: batched_collisions) {
+    if (batch.info == &info) {
+      if (std::find(batch.entities.begin(), batch.entities.end(), shared_entity) == batch.entities.end()) {
+        batch.entities.push_back(shared_entity);
+      }
+      return;
+    }
+  }
+
+  BatchedCollisions batch;
+  batch.collision_tests = collision_tests;
+  batch.info = &info;
+  batch.entities.push_back(shared_entity);
+  batched_collisions.push_back(batch);
+}
+
+/**
+ * \brief Calls the callbacks of batched collision tests that detected
+ * entities since the last call.
+ */
+void CustomEntity::notify_batched_collisions() {
+
+  if (batched_collisions.empty()) {
+    return;
+  }
+
+  // Callbacks may detect new collisions: they will be for the next cycle.
+  std::vector<BatchedCollisions> batches;
+  batches.swap(batched_collisions);
+
+  for (BatchedCollisions& batch: batches) {
+    batch.entities.erase(std::remove_if(
+        batch.entities.begin(), batch.entities.end(),
+        [](const EntityPtr& entity) { return entity->is_being_removed(); }
+    ), batch.entities.end());
+    if (!batch.entities.empty()) {
+      get_lua_context().do_custom_entity_collision_callback(
+          batch.info->get_callback_ref(), *this, batch.entities
+      );
+    }
+  }
+}
+
 /**
  * \copydoc Detector::notify_collision(Entity&,CollisionMode)
  */
@@ -879,13 +1112,14 @@ void CustomEntity::notify_collision(Entity& entity_overlapping, CollisionMode co
       "Unexpected collision mode");
 
   // There is a collision: execute the callbacks.
-  for (const CollisionInfo& info: successful_collision_tests) {
+  for (const CollisionInfo* info: successful_collision_tests) {
     get_lua_context().do_custom_entity_collision_callback(
-        info.get_callback_ref(), *this, entity_overlapping
+        info->get_callback_ref(), *this, entity_overlapping
     );
   }
 
   successful_collision_tests.clear();
+  successful_collision_tests_owner = nullptr;
 }
 
 /**
@@ -897,8 +1131,8 @@ void CustomEntity::notify_collision(
     Sprite& other_sprite
 ) {
   // A collision was detected with a sprite of another entity.
-  const std::vector<CollisionInfo> collision_tests = this->collision_tests;
-  for (const CollisionInfo& info: collision_tests) {
+  const std::shared_ptr<const std::vector<CollisionInfo>> collision_tests = this->collision_tests;
+  for (const CollisionInfo& info: *collision_tests) {
 
     if (info.get_built_in_test() == COLLISION_SPRITE) {
       // Execute the callback.
@@ -1216,6 +1450,8 @@ void CustomEntity::update() {
     return;
   }
 
+  notify_batched_collisions();
+
   get_lua_context().entity_on_update(*this);
 }
 
@@ -1334,6 +1570,18 @@ bool CustomEntity::TraversableInfo::is_traversable(
   );
 }
 
+/**
+ * \brief Creates a native collision test with no condition.
+ */
+CustomEntity::CollisionPredicate::CollisionPredicate():
+    radius(-1),
+    facing_cone(-1.0),
+    entity_types(),
+    layers(),
+    batched(false) {
+
+}
+
 /**
  * \brief Empty constructor.
  */
@@ -1341,6 +1589,8 @@ CustomEntity::CollisionInfo::CollisionInfo():
     lua_context(nullptr),
     built_in_test(COLLISION_NONE),
     custom_test_ref(),
+    native(false),
+    predicate(),
     callback_ref() {
 
 }
@@ -1360,6 +1610,8 @@ CustomEntity::CollisionInfo::CollisionInfo(
     lua_context(&lua_context),
     built_in_test(built_in_test),
     custom_test_ref(),
+    native(false),
+    predicate(),
     callback_ref(callback_ref) {
 
   Debug::check_assertion(!callback_ref.is_empty(), "Missing callback ref");
@@ -1380,6 +1632,30 @@ CustomEntity::CollisionInfo::CollisionInfo(
     lua_context(&lua_context),
     built_in_test(COLLISION_CUSTOM),
     custom_test_ref(custom_test_ref),
+    native(false),
+    predicate(),
+    callback_ref(callback_ref) {
+
+  Debug::check_assertion(!callback_ref.is_empty(), "Missing callback ref");
+}
+
+/**
+ * \brief Creates a native collision test info.
+ * \param lua_context The Lua context.
+ * \param predicate The conditions of the collision test.
+ * \param callback_ref Lua ref to a function to call when this collision is
+ * detected.
+ */
+CustomEntity::CollisionInfo::CollisionInfo(
+    LuaContext& lua_context,
+    const CollisionPredicate& predicate,
+    const ScopedLuaRef& callback_ref
+):
+    lua_context(&lua_context),
+    built_in_test(COLLISION_CUSTOM),
+    custom_test_ref(),
+    native(true),
+    predicate(predicate),
     callback_ref(callback_ref) {
 
   Debug::check_assertion(!callback_ref.is_empty(), "Missing callback ref");
@@ -1403,6 +1679,22 @@ const ScopedLuaRef& CustomEntity::CollisionInfo::get_custom_test_ref() const {
   return custom_test_ref;
 }
 
+/**
+ * \brief Returns whether this is a native collision test.
+ * \return \c true if the test is get_predicate().
+ */
+bool CustomEntity::CollisionInfo::has_predicate() const {
+  return native;
+}
+
+/**
+ * \brief Returns the conditions of a native collision test.
+ * \return The predicate (only meaningful if has_predicate() is \c true).
+ */
+const CustomEntity::CollisionPredicate& CustomEntity::CollisionInfo::get_predicate() const {
+  return predicate;
+}
+
 /**
  * \brief Returns the function to call when the collision is detected.
  * \return A Lua ref to the callback.
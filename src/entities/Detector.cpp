@@ -16,6 +16,7 @@
  */
 #include "solarus/entities/Detector.h"
 #include "solarus/entities/Hero.h"
+#include "solarus/entities/MapEntities.h"
 #include "solarus/Map.h"
 #include "solarus/KeysEffect.h"
 #include "solarus/Sprite.h"
@@ -74,7 +75,15 @@ void Detector::set_collision_modes(int collision_modes) {
   if (collision_modes & COLLISION_SPRITE) {
     enable_pixel_collisions();
   }
+  if (collision_modes == this->collision_modes) {
+    return;
+  }
   this->collision_modes = collision_modes;
+
+  if (is_on_map()) {
+    // Detectors are indexed by the kind of collisions they detect.
+    get_entities().notify_detector_collision_modes_changed(*this);
+  }
 }
 
 /**
@@ -86,6 +95,14 @@ void Detector::add_collision_mode(CollisionMode collision_mode) {
   set_collision_modes(this->collision_modes | collision_mode);
 }
 
+/**
+ * \brief Returns the collision modes of this detector.
+ * \return An OR combination of collision modes.
+ */
+int Detector::get_collision_modes() const {
+  return collision_modes;
+}
+
 /**
  * \brief Returns whether the detector's collision modes includes
  * the specified collision mode.
@@ -138,6 +155,11 @@ void Detector::set_layer_independent_collisions(bool independent) {
  */
 void Detector::check_collision(Entity& entity) {
 
+  if ((collision_modes & ~COLLISION_SPRITE) == 0) {
+    // Only pixel-precise collisions are detected.
+    return;
+  }
+
   if (&entity != this
       && (has_layer_independent_collisions() || get_layer() == entity.get_layer())) { // the entity is in the same layer as the detector
 
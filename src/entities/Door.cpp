@@ -176,6 +176,7 @@ void Door::set_open(bool door_open) {
 
   if (is_on_map()) {
     update_dynamic_tiles();
+    get_entities().notify_entity_obstacle_changed(*this);
 
     if (is_saved()) {
       get_savegame().set_boolean(savegame_variable, door_open);
@@ -549,7 +549,15 @@ bool Enemy::is_traversable() const {
  * \param traversable \c true to make this enemy traversable.
  */
 void Enemy::set_traversable(bool traversable) {
+
+  if (traversable == this->traversable) {
+    return;
+  }
+
   this->traversable = traversable;
+  if (is_on_map()) {
+    get_entities().notify_entity_obstacle_changed(*this);
+  }
 }
 
 /**
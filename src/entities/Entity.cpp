@@ -692,6 +692,7 @@ int Entity::get_y() const {
  */
 void Entity::set_x(int x) {
   bounding_box.set_x(x - origin.x);
+  notify_bounding_box_changed();
 }
 
 /**
@@ -703,6 +704,7 @@ void Entity::set_x(int x) {
  */
 void Entity::set_y(int y) {
   bounding_box.set_y(y - origin.y);
+  notify_bounding_box_changed();
 }
 
 /**
@@ -725,8 +727,8 @@ Point Entity::get_xy() const {
  * \param y the new y coordinate of the entity on the map
  */
 void Entity::set_xy(int x, int y) {
-  set_x(x);
-  set_y(y);
+  bounding_box.set_xy(x - origin.x, y - origin.y);
+  notify_bounding_box_changed();
 }
 
 /**
@@ -770,6 +772,7 @@ Point Entity::get_top_left_xy() const {
  */
 void Entity::set_top_left_x(int x) {
   bounding_box.set_x(x);
+  notify_bounding_box_changed();
 }
 
 /**
@@ -778,6 +781,7 @@ void Entity::set_top_left_x(int x) {
  */
 void Entity::set_top_left_y(int y) {
   bounding_box.set_y(y);
+  notify_bounding_box_changed();
 }
 
 /**
@@ -789,8 +793,8 @@ void Entity::set_top_left_y(int y) {
  * \param y y position of the entity
  */
 void Entity::set_top_left_xy(int x, int y) {
-  set_top_left_x(x);
-  set_top_left_y(y);
+  bounding_box.set_xy(x, y);
+  notify_bounding_box_changed();
 }
 
 /**
@@ -891,6 +895,7 @@ const Rectangle& Entity::get_bounding_box() const {
  */
 void Entity::set_bounding_box(const Rectangle &bounding_box) {
   this->bounding_box = bounding_box;
+  notify_bounding_box_changed();
 }
 
 /**
@@ -1178,6 +1183,8 @@ void Entity::set_origin(int x, int y) {
 
   bounding_box.add_xy(origin.x - x, origin.y - y);
   origin = { x, y };
+
+  notify_bounding_box_changed();
 }
 
 /**
@@ -1542,15 +1549,8 @@ void Entity::check_collision_with_detectors() {
     return;
   }
 
-  // Detect simple collisions.
+  // Detect simple collisions, and then pixel-precise ones.
   get_map().check_collision_with_detectors(*this);
-
-  // Detect pixel-precise collisions.
-  for (const SpritePtr& sprite: sprites) {
-    if (sprite->are_pixel_collisions_enabled()) {
-      get_map().check_collision_with_detectors(*this, *sprite);
-    }
-  }
 }
 
 /**
@@ -1682,6 +1682,9 @@ void Entity::notify_enabled(bool /* enabled */) {
     update_ground_observers();
   }
   update_ground_below();
+
+  // Disabled entities are not obstacles.
+  get_entities().notify_entity_obstacle_changed(*this);
 }
 
 /**
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/EntityPerformanceStats.h"
+#include "solarus/entities/Entity.h"
+
+namespace Solarus {
+
+/**
+ * \brief Creates disabled entity performance stats.
+ */
+EntityPerformanceStats::EntityPerformanceStats():
+    enabled(false),
+    num_update_frames(0),
+    num_draw_frames(0) {
+
+}
+
+/**
+ * \brief Returns whether durations are being measured.
+ * \return \c true if the stats are enabled.
+ */
+bool EntityPerformanceStats::is_enabled() const {
+  return enabled;
+}
+
+/**
+ * \brief Enables or disables measuring durations.
+ *
+ * Enabling the stats clears previous measures.
+ *
+ * \param enabled \c true to enable the stats.
+ */
+void EntityPerformanceStats::set_enabled(bool enabled) {
+
+  if (enabled && !this->enabled) {
+    clear();
+  }
+  this->enabled = enabled;
+}
+
+/**
+ * \brief Forgets all measures.
+ */
+void EntityPerformanceStats::clear() {
+
+  num_update_frames = 0;
+  num_draw_frames = 0;
+  type_costs.clear();
+  entity_costs.clear();
+}
+
+/**
+ * \brief Counts one more update of all entities.
+ */
+void EntityPerformanceStats::add_update_frame() {
+  ++num_update_frames;
+}
+
+/**
+ * \brief Counts one more drawing of all entities.
+ */
+void EntityPerformanceStats::add_draw_frame() {
+  ++num_draw_frames;
+}
+
+/**
+ * \brief Adds the time spent updating an entity.
+ * \param entity The entity updated.
+ * \param duration The duration of its update in microseconds.
+ */
+void EntityPerformanceStats::add_update_time(const Entity& entity, uint64_t duration) {
+
+  type_costs[entity.get_type()].update_time += duration;
+  const std::string& name = entity.get_name();
+  if (!name.empty()) {
+    entity_costs[name].update_time += duration;
+  }
+}
+
+/**
+ * \brief Adds the time spent drawing an entity.
+ * \param entity The entity drawn.
+ * \param duration The duration of its drawing in microseconds.
+ */
+void EntityPerformanceStats::add_draw_time(const Entity& entity, uint64_t duration) {
+
+  type_costs[entity.get_type()].draw_time += duration;
+  const std::string& name = entity.get_name();
+  if (!name.empty()) {
+    entity_costs[name].draw_time += duration;
+  }
+}
+
+/**
+ * \brief Returns the number of times entities were updated.
+ * \return The number of update frames measured.
+ */
+int EntityPerformanceStats::get_num_update_frames() const {
+  return num_update_frames;
+}
+
+/**
+ * \brief Returns the number of times entities were drawn.
+ * \return The number of draw frames measured.
+ */
+int EntityPerformanceStats::get_num_draw_frames() const {
+  return num_draw_frames;
+}
+
+/**
+ * \brief Returns the time spent by each type of entity.
+ * \return The accumulated cost of each entity type measured.
+ */
+const std::map<EntityType, EntityPerformanceStats::Cost>&
+EntityPerformanceStats::get_type_costs() const {
+  return type_costs;
+}
+
+/**
+ * \brief Returns the time spent by each named entity.
+ * \return The accumulated cost of each entity measured, by name.
+ */
+const std::map<std::string, EntityPerformanceStats::Cost>&
+EntityPerformanceStats::get_entity_costs() const {
+  return entity_costs;
+}
+
+}
+
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/GroundBitmaps.h"
+#include "solarus/lowlevel/Debug.h"
+#include <algorithm>
+
+namespace Solarus {
+
+constexpr int GroundBitmaps::num_grounds;
+
+/**
+ * \brief Creates empty ground bitmaps.
+ *
+ * Call initialize() to set their size.
+ */
+GroundBitmaps::GroundBitmaps():
+  width8(0),
+  height8(0),
+  words_per_row(0),
+  words_per_column(0),
+  allocated_grounds(0) {
+
+}
+
+/**
+ * \brief Sets the size of the grid and clears all bitmaps.
+ * \param width8 Number of 8x8 squares on a row.
+ * \param height8 Number of 8x8 squares on a column.
+ */
+void GroundBitmaps::initialize(int width8, int height8) {
+
+  Debug::check_assertion(width8 >= 0 && height8 >= 0, "Invalid ground bitmaps size");
+
+  this->width8 = width8;
+  this->height8 = height8;
+  this->words_per_row = (width8 + 63) / 64;
+  this->words_per_column = (height8 + 63) / 64;
+  this->allocated_grounds = 0;
+  for (int i = 0; i < num_grounds; ++i) {
+    row_bits[i].clear();
+    column_bits[i].clear();
+  }
+}
+
+/**
+ * \brief Returns whether a ground is stored in the bitmaps.
+ * \param ground A ground.
+ * \return \c false if this ground is never an obstacle.
+ */
+bool GroundBitmaps::is_tracked(Ground ground) {
+
+  switch (ground) {
+
+    case Ground::EMPTY:
+    case Ground::TRAVERSABLE:
+    case Ground::GRASS:
+    case Ground::ICE:
+      return false;
+
+    default:
+      return true;
+  }
+}
+
+/**
+ * \brief Returns the bit representing a ground in the masks returned by
+ * get_grounds_in_row() and get_grounds_in_column().
+ * \param ground A ground.
+ * \return The corresponding bit.
+ */
+uint32_t GroundBitmaps::get_ground_bit(Ground ground) {
+  return 1u << static_cast<int>(ground);
+}
+
+/**
+ * \brief Updates the bitmaps when the ground of a square changes.
+ *
+ * Coordinates outside the grid are ignored.
+ *
+ * \param x8 X coordinate of the square (divided by 8).
+ * \param y8 Y coordinate of the square (divided by 8).
+ * \param old_ground The previous ground of this square.
+ * \param new_ground The new ground of this square.
+ */
+void GroundBitmaps::set_ground(int x8, int y8, Ground old_ground, Ground new_ground) {
+
+  if (x8 < 0 || x8 >= width8 || y8 < 0 || y8 >= height8) {
+    return;
+  }
+
+  const int row_index = y8 * words_per_row * 64 + x8;
+  const int column_index = x8 * words_per_column * 64 + y8;
+
+  if (is_tracked(old_ground) &&
+      (allocated_grounds & get_ground_bit(old_ground)) != 0) {
+    const int old_index = static_cast<int>(old_ground);
+    set_bit(row_bits[old_index], row_index, false);
+    set_bit(column_bits[old_index], column_index, false);
+  }
+
+  if (is_tracked(new_ground)) {
+    const int new_index = static_cast<int>(new_ground);
+    if ((allocated_grounds & get_ground_bit(new_ground)) == 0) {
+      row_bits[new_index].assign(height8 * words_per_row, 0);
+      column_bits[new_index].assign(width8 * words_per_column, 0);
+      allocated_grounds |= get_ground_bit(new_ground);
+    }
+    set_bit(row_bits[new_index], row_index, true);
+    set_bit(column_bits[new_index], column_index, true);
+  }
+}
+
+/**
+ * \brief Returns the grounds present in a horizontal segment of squares.
+ *
+ * Squares outside the grid are ignored.
+ *
+ * \param y8 Y coordinate of the row (divided by 8).
+ * \param x8_min X coordinate of the first square (divided by 8).
+ * \param x8_max X coordinate of the last square (divided by 8).
+ * \return The bits of the tracked grounds found in this segment
+ * (see get_ground_bit()).
+ */
+uint32_t GroundBitmaps::get_grounds_in_row(int y8, int x8_min, int x8_max) const {
+
+  if (y8 < 0 || y8 >= height8) {
+    return 0;
+  }
+  x8_min = std::max(x8_min, 0);
+  x8_max = std::min(x8_max, width8 - 1);
+  if (x8_min > x8_max) {
+    return 0;
+  }
+
+  const int row_start = y8 * words_per_row * 64;
+  uint32_t grounds = 0;
+  for (int i = 0; i < num_grounds; ++i) {
+    if ((allocated_grounds & (1u << i)) != 0 &&
+        test_bits(row_bits[i], row_start + x8_min, row_start + x8_max)) {
+      grounds |= 1u << i;
+    }
+  }
+  return grounds;
+}
+
+/**
+ * \brief Returns the grounds present in a vertical segment of squares.
+ *
+ * Squares outside the grid are ignored.
+ *
+ * \param x8 X coordinate of the column (divided by 8).
+ * \param y8_min Y coordinate of the first square (divided by 8).
+ * \param y8_max Y coordinate of the last square (divided by 8).
+ * \return The bits of the tracked grounds found in this segment
+ * (see get_ground_bit()).
+ */
+uint32_t GroundBitmaps::get_grounds_in_column(int x8, int y8_min, int y8_max) const {
+
+  if (x8 < 0 || x8 >= width8) {
+    return 0;
+  }
+  y8_min = std::max(y8_min, 0);
+  y8_max = std::min(y8_max, height8 - 1);
+  if (y8_min > y8_max) {
+    return 0;
+  }
+
+  const int column_start = x8 * words_per_column * 64;
+  uint32_t grounds = 0;
+  for (int i = 0; i < num_grounds; ++i) {
+    if ((allocated_grounds & (1u << i)) != 0 &&
+        test_bits(column_bits[i], column_start + y8_min, column_start + y8_max)) {
+      grounds |= 1u << i;
+    }
+  }
+  return grounds;
+}
+
+/**
+ * \brief Sets or clears a bit.
+ * \param bits The bitmap to change.
+ * \param index Index of the bit.
+ * \param value The new value.
+ */
+void GroundBitmaps::set_bit(std::vector<uint64_t>& bits, int index, bool value) {
+
+  const uint64_t mask = uint64_t(1) << (index & 63);
+  if (value) {
+    bits[index >> 6] |= mask;
+  }
+  else {
+    bits[index >> 6] &= ~mask;
+  }
+}
+
+/**
+ * \brief Returns whether at least one bit is set in a range.
+ * \param bits The bitmap to test.
+ * \param first_index Index of the first bit of the range.
+ * \param last_index Index of the last bit of the range (included).
+ * \return \c true if a bit is set in this range.
+ */
+bool GroundBitmaps::test_bits(
+    const std::vector<uint64_t>& bits,
+    int first_index,
+    int last_index) {
+
+  const int first_word = first_index >> 6;
+  const int last_word = last_index >> 6;
+  const uint64_t first_mask = ~uint64_t(0) << (first_index & 63);
+  const uint64_t last_mask = ~uint64_t(0) >> (63 - (last_index & 63));
+
+  if (first_word == last_word) {
+    return (bits[first_word] & first_mask & last_mask) != 0;
+  }
+
+  if ((bits[first_word] & first_mask) != 0) {
+    return true;
+  }
+  for (int i = first_word + 1; i < last_word; ++i) {
+    if (bits[i] != 0) {
+      return true;
+    }
+  }
+  return (bits[last_word] & last_mask) != 0;
+}
+
+}
+
@@ -21,21 +21,72 @@
 #include "solarus/entities/TilePattern.h"
 #include "solarus/entities/Layer.h"
 #include "solarus/entities/CrystalBlock.h"
+#include "solarus/entities/CustomEntity.h"
 #include "solarus/entities/Boomerang.h"
 #include "solarus/entities/Stairs.h"
 #include "solarus/entities/Separator.h"
 #include "solarus/entities/Destination.h"
+#include "solarus/entities/Detector.h"
+#include "solarus/entities/Enemy.h"
 #include "solarus/entities/NonAnimatedRegions.h"
+#include "solarus/entities/EntityTypeInfo.h"
 #include "solarus/Map.h"
 #include "solarus/Game.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/lowlevel/Color.h"
 #include "solarus/lowlevel/Music.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Profiler.h"
+#include "solarus/lowlevel/TextSurface.h"
+#include <algorithm>
+#include <functional>
 #include <sstream>
 
 namespace Solarus {
 
+namespace {
+
+/**
+ * \brief Returns the 8x8 squares overlapped by a rectangle.
+ * \param box A rectangle.
+ * \return The squares, in units of 8 pixels.
+ */
+Rectangle get_grid_cells(const Rectangle& box) {
+
+  const int x8 = box.get_x() >> 3;
+  const int y8 = box.get_y() >> 3;
+  const int x8_max = (box.get_x() + std::max(box.get_width(), 1) - 1) >> 3;
+  const int y8_max = (box.get_y() + std::max(box.get_height(), 1) - 1) >> 3;
+  return Rectangle(x8, y8, x8_max - x8 + 1, y8_max - y8 + 1);
+}
+
+/**
+ * \brief Returns whether an entity may be an obstacle for the entities
+ * that share their paths (see PathFindingCache).
+ *
+ * Custom entities without traversable rules and traversable enemies block
+ * none of them, so their moves change no shared path.
+ *
+ * \param entity An entity that can be an obstacle.
+ * \return \c false if the entity is never an obstacle for shared paths.
+ */
+bool can_block_shared_paths(const Entity& entity) {
+
+  switch (entity.get_type()) {
+
+  case EntityType::CUSTOM:
+    return static_cast<const CustomEntity&>(entity).has_traversable_by_entities_rules();
+
+  case EntityType::ENEMY:
+    return !static_cast<const Enemy&>(entity).is_traversable();
+
+  default:
+    return true;
+  }
+}
+
+}
+
 /**
  * \brief Constructor.
  * \param game The game.
@@ -49,11 +100,18 @@ MapEntities::MapEntities(Game& game, Map& map):
   tiles_grid_size(0),
   hero(*game.get_hero()),
   default_destination(nullptr),
-  boomerang(nullptr) {
+  boomerang(nullptr),
+  terrain_version(0),
+  obstacle_change_date(0),
+  performance_overlay_enabled(false) {
+
+  for (int layer = 0; layer < LAYER_NB; ++layer) {
+    this->y_order_changed[layer] = false;
+  }
 
   Layer hero_layer = hero.get_layer();
   this->obstacle_entities[hero_layer].push_back(&hero);
-  this->entities_drawn_y_order[hero_layer].push_back(&hero);
+  add_drawn_in_y_order(hero, hero_layer);
   this->ground_observers[hero_layer].push_back(&hero);
   this->named_entities[hero.get_name()] = &hero;
 }
@@ -170,7 +228,12 @@ void MapEntities::set_tile_ground(Layer layer, int x8, int y8, Ground ground) {
 
   if (x8 >= 0 && x8 < map_width8 && y8 >= 0 && y8 < map_height8) {
     int index = y8 * map_width8 + x8;
+    const Ground old_ground = tiles_ground[layer][index];
     tiles_ground[layer][index] = ground;
+    tiles_ground_bitmaps[layer].set_ground(x8, y8, old_ground, ground);
+    if (ground != old_ground) {
+      notify_path_finding_ground_changed(layer, Rectangle(x8 * 8, y8 * 8, 8, 8));
+    }
   }
 }
 
@@ -271,6 +334,34 @@ bool MapEntities::has_entity_with_prefix(const std::string& prefix) const {
   return false;
 }
 
+/**
+ * \brief Returns the entities that might be obstacles in a rectangle.
+ *
+ * The result may contain duplicates.
+ *
+ * \param[in] layer The layer to check.
+ * \param[in] rectangle A rectangle.
+ * \param[out] result The obstacle entities whose bounding box overlaps
+ * that rectangle.
+ */
+void MapEntities::get_obstacle_entities_in_rectangle(
+    Layer layer, const Rectangle& rectangle, std::vector<Entity*>& result
+) const {
+
+  const Quadtree<Entity*>& tree = obstacle_trees[layer];
+  if (!tree.get_space().contains(rectangle)) {
+    // Entities far outside the map are not in the tree.
+    for (Entity* entity: obstacle_entities[layer]) {
+      if (entity->overlaps(rectangle)) {
+        result.push_back(entity);
+      }
+    }
+    return;
+  }
+
+  tree.get_elements(rectangle, result);
+}
+
 /**
  * \brief Returns all entities whose bounding box overlaps the given rectangle.
  * \param[in] rectangle A rectangle.
@@ -282,6 +373,26 @@ void MapEntities::get_entities_in_rectangle(
   quadtree.get_elements(rectangle, result);
 }
 
+/**
+ * \brief Returns the detectors interested in a kind of collision whose
+ * max bounding box overlaps the given rectangle.
+ * \param[in] rectangle A rectangle.
+ * \param[in] sprite_collisions \c true to get detectors with
+ * COLLISION_SPRITE, \c false to get detectors with other collision modes.
+ * \param[out] result The detectors in that rectangle.
+ */
+void MapEntities::get_detectors_in_rectangle(
+    const Rectangle& rectangle, bool sprite_collisions, std::vector<EntityPtr>& result
+) const {
+
+  if (sprite_collisions) {
+    sprite_detector_tree.get_elements(rectangle, result);
+  }
+  else {
+    simple_detector_tree.get_elements(rectangle, result);
+  }
+}
+
 /**
  * \brief Brings to front an entity in its layer.
  * \param entity The entity to bring to front.
@@ -350,6 +461,7 @@ void MapEntities::notify_map_started() {
   // Put the hero in the the quadtree.
   HeroPtr shared_hero = std::static_pointer_cast<Hero>(hero.shared_from_this());
   quadtree.add(shared_hero, hero.get_max_bounding_box());
+  obstacle_trees[hero.get_layer()].add(&hero, hero.get_bounding_box());
 
   // Notify entities.
   for (const EntityPtr& entity: all_entities) {
@@ -593,21 +705,12 @@ void MapEntities::add_entity(const EntityPtr& entity) {
     // update the detectors list
     if (entity->is_detector()) {
       detectors.push_back(static_cast<Detector*>(entity.get()));
+      add_to_detector_trees(entity);
     }
 
     // update the obstacle list
     if (entity->can_be_obstacle()) {
-
-      if (entity->has_layer_independent_collisions()) {
-        // some entities handle collisions on any layer (e.g. stairs inside a single floor)
-        obstacle_entities[LAYER_LOW].push_back(entity.get());
-        obstacle_entities[LAYER_INTERMEDIATE].push_back(entity.get());
-        obstacle_entities[LAYER_HIGH].push_back(entity.get());
-      }
-      else {
-        // but usually, an entity collides with only one layer
-        obstacle_entities[layer].push_back(entity.get());
-      }
+      add_obstacle(*entity);
     }
 
     // update the ground observers list
@@ -618,11 +721,13 @@ void MapEntities::add_entity(const EntityPtr& entity) {
     // update the ground modifiers list
     if (entity->is_ground_modifier()) {
       ground_modifiers[layer].push_back(entity.get());
+      ground_modifier_cells[entity.get()] = get_grid_cells(entity->get_bounding_box());
+      notify_path_finding_ground_modifier_changed(*entity, layer, true);
     }
 
     // update the sprites list
     if (entity->is_drawn_in_y_order()) {
-      entities_drawn_y_order[layer].push_back(entity.get());
+      add_drawn_in_y_order(*entity, layer);
     }
     else if (entity->can_be_drawn()) {
       entities_drawn_first[layer].push_back(entity.get());
@@ -732,6 +837,68 @@ void MapEntities::remove_entity(const std::string& name) {
   }
 }
 
+/**
+ * \brief Adds a detector to the trees corresponding to its collision modes.
+ * \param entity A detector.
+ */
+void MapEntities::add_to_detector_trees(const EntityPtr& entity) {
+
+  const int collision_modes = static_cast<Detector&>(*entity).get_collision_modes();
+  if ((collision_modes & ~COLLISION_SPRITE) != 0) {
+    simple_detector_tree.add(entity, entity->get_max_bounding_box());
+  }
+  if ((collision_modes & COLLISION_SPRITE) != 0) {
+    sprite_detector_tree.add(entity, entity->get_max_bounding_box());
+  }
+}
+
+/**
+ * \brief Adds an entity to the obstacle lists and trees of its layers.
+ * \param entity An entity that can be an obstacle.
+ */
+void MapEntities::add_obstacle(Entity& entity) {
+
+  if (entity.has_layer_independent_collisions()) {
+    // some entities handle collisions on any layer (e.g. stairs inside a single floor)
+    for (int i = 0; i < LAYER_NB; ++i) {
+      obstacle_entities[i].push_back(&entity);
+      obstacle_trees[i].add(&entity, entity.get_bounding_box());
+    }
+  }
+  else {
+    // but usually, an entity collides with only one layer
+    const Layer layer = entity.get_layer();
+    obstacle_entities[layer].push_back(&entity);
+    obstacle_trees[layer].add(&entity, entity.get_bounding_box());
+  }
+
+  const Rectangle cells = get_grid_cells(entity.get_bounding_box());
+  obstacle_cells[&entity] = cells;
+  notify_path_finding_obstacle_changed(entity, cells);
+}
+
+/**
+ * \brief Removes an entity from the obstacle lists and trees of its layers.
+ * \param entity An entity that can be an obstacle.
+ */
+void MapEntities::remove_obstacle(Entity& entity) {
+
+  if (entity.has_layer_independent_collisions()) {
+    for (int i = 0; i < LAYER_NB; ++i) {
+      obstacle_entities[i].remove(&entity);
+      obstacle_trees[i].remove(&entity);
+    }
+  }
+  else {
+    const Layer layer = entity.get_layer();
+    obstacle_entities[layer].remove(&entity);
+    obstacle_trees[layer].remove(&entity);
+  }
+
+  obstacle_cells.erase(&entity);
+  notify_path_finding_obstacle_changed(entity, get_grid_cells(entity.get_bounding_box()));
+}
+
 /**
  * \brief Removes all entities of a type whose name starts with the specified prefix.
  * \param prefix Prefix of the name of the entities to remove.
@@ -760,20 +927,14 @@ void MapEntities::remove_marked_entities() {
 
     // remove it from the obstacle entities list if present
     if (entity->can_be_obstacle()) {
-
-      if (entity->has_layer_independent_collisions()) {
-        for (int i = 0; i < LAYER_NB; i++) {
-          obstacle_entities[i].remove(entity);
-        }
-      }
-      else {
-        obstacle_entities[layer].remove(entity);
-      }
+      remove_obstacle(*entity);
     }
 
     // remove it from the detectors list if present
     if (entity->is_detector()) {
       detectors.remove(static_cast<Detector*>(entity));
+      simple_detector_tree.remove(shared_entity);
+      sprite_detector_tree.remove(shared_entity);
     }
 
     // remove it from the ground observers list if present
@@ -784,16 +945,24 @@ void MapEntities::remove_marked_entities() {
     // remove it from the ground modifiers list if present
     if (entity->is_ground_modifier()) {
       ground_modifiers[layer].remove(entity);
+      ground_modifier_cells.erase(entity);
+      notify_path_finding_ground_modifier_changed(*entity, layer, false);
     }
 
     // remove it from the sprite entities list if present
     if (entity->is_drawn_in_y_order()) {
-      entities_drawn_y_order[layer].remove(entity);
+      remove_drawn_in_y_order(*entity, layer);
     }
     else if (entity->can_be_drawn()) {
       entities_drawn_first[layer].remove(entity);
     }
 
+    // remove the flow fields leading to it
+    flow_fields.erase(std::remove_if(flow_fields.begin(), flow_fields.end(),
+        [entity](const std::unique_ptr<FlowField>& flow_field) {
+      return &flow_field->get_target() == entity;
+    }), flow_fields.end());
+
     // remove it from the whole list
     all_entities.remove(shared_entity);
     const std::string& name = entity->get_name();
@@ -859,20 +1028,28 @@ void MapEntities::update() {
 
   Debug::check_assertion(map.is_started(), "The map is not started");
 
+  Profiler::Zone zone("MapEntities::update");
+
+  if (performance_stats.is_enabled()) {
+    performance_stats.add_update_frame();
+  }
+
   // First update the hero.
-  hero.update();
+  update_entity(hero);
 
   // Update the dynamic entities.
   for (int layer = 0; layer < LAYER_NB; layer++) {
 
-    // Sort the entities drawn in y order.
-    entities_drawn_y_order[layer].sort(compare_y);
+    // Sort the entities drawn in y order if some of them have moved.
+    if (y_order_changed[layer]) {
+      sort_drawn_in_y_order(Layer(layer));
+    }
   }
 
   for (const EntityPtr& entity: all_entities) {
 
     if (!entity->is_being_removed()) {
-      entity->update();
+      update_entity(*entity);
     }
   }
 
@@ -880,11 +1057,33 @@ void MapEntities::update() {
   remove_marked_entities();
 }
 
+/**
+ * \brief Updates an entity and measures it if performance stats are enabled.
+ * \param entity The entity to update.
+ */
+void MapEntities::update_entity(Entity& entity) {
+
+  if (!performance_stats.is_enabled()) {
+    entity.update();
+    return;
+  }
+
+  const uint64_t start_time = Profiler::get_time();
+  entity.update();
+  performance_stats.add_update_time(entity, Profiler::get_time() - start_time);
+}
+
 /**
  * \brief Draws the entities on the map surface.
  */
 void MapEntities::draw() {
 
+  Profiler::Zone zone("MapEntities::draw");
+
+  if (performance_stats.is_enabled()) {
+    performance_stats.add_draw_frame();
+  }
+
   for (int layer = 0; layer < LAYER_NB; ++layer) {
 
     // draw the animated tiles and the tiles that overlap them:
@@ -903,16 +1102,19 @@ void MapEntities::draw() {
     for (Entity* entity: entities_drawn_first[layer]) {
 
       if (entity->is_enabled()) {
-        entity->draw_on_map();
+        draw_entity(*entity);
       }
     }
 
     // draw the sprites at the hero's level, in the order
     // defined by their y position (including the hero)
-    for (Entity* entity: entities_drawn_y_order[layer]) {
+    // Use an index because scripts may add entities while drawing.
+    const std::vector<Entity*>& y_ordered_entities = entities_drawn_y_order[layer];
+    for (size_t i = 0; i < y_ordered_entities.size(); ++i) {
 
+      Entity* entity = y_ordered_entities[i];
       if (entity->is_enabled()) {
-        entity->draw_on_map();
+        draw_entity(*entity);
       }
     }
   }
@@ -920,6 +1122,123 @@ void MapEntities::draw() {
   if (EntityTree::debug_quadtrees) {
     quadtree.draw(map.get_visible_surface(), -map.get_camera_position().get_top_left());
   }
+
+  if (performance_overlay_enabled) {
+    draw_performance_overlay();
+  }
+}
+
+/**
+ * \brief Draws an entity and measures it if performance stats are enabled.
+ * \param entity The entity to draw.
+ */
+void MapEntities::draw_entity(Entity& entity) {
+
+  if (!performance_stats.is_enabled()) {
+    entity.draw_on_map();
+    return;
+  }
+
+  const uint64_t start_time = Profiler::get_time();
+  entity.draw_on_map();
+  performance_stats.add_draw_time(entity, Profiler::get_time() - start_time);
+}
+
+/**
+ * \brief Returns the time spent by entities of this map.
+ * \return The performance stats of entities.
+ */
+EntityPerformanceStats& MapEntities::get_performance_stats() {
+  return performance_stats;
+}
+
+/**
+ * \brief Returns whether the performance stats are drawn on the map.
+ * \return \c true if the performance overlay is shown.
+ */
+bool MapEntities::is_performance_overlay_enabled() const {
+  return performance_overlay_enabled;
+}
+
+/**
+ * \brief Shows or hides the performance stats on the map.
+ *
+ * Showing the overlay also enables the performance stats.
+ *
+ * \param enabled \c true to show the performance overlay.
+ */
+void MapEntities::set_performance_overlay_enabled(bool enabled) {
+
+  performance_overlay_enabled = enabled;
+  performance_overlay_lines.clear();
+  if (enabled) {
+    performance_stats.set_enabled(true);
+  }
+}
+
+/**
+ * \brief Draws the most expensive entity types on top of the map.
+ *
+ * Costs are averages per frame in microseconds since the stats were enabled.
+ * The text is refreshed every 30 frames to stay readable.
+ */
+void MapEntities::draw_performance_overlay() {
+
+  static constexpr int num_lines = 8;
+  static constexpr int refresh_interval = 30;
+
+  const int num_update_frames = std::max(performance_stats.get_num_update_frames(), 1);
+  const int num_draw_frames = std::max(performance_stats.get_num_draw_frames(), 1);
+
+  if (performance_overlay_lines.empty() ||
+      performance_stats.get_num_draw_frames() % refresh_interval == 0) {
+
+    // Sort entity types by decreasing total cost per frame.
+    std::vector<std::pair<uint64_t, std::string>> lines;
+    for (const auto& kvp: performance_stats.get_type_costs()) {
+      const uint64_t update_time = kvp.second.update_time / num_update_frames;
+      const uint64_t draw_time = kvp.second.draw_time / num_draw_frames;
+      std::ostringstream oss;
+      oss << EntityTypeInfo::get_entity_type_name(kvp.first)
+          << ": " << update_time << " + " << draw_time << " us";
+      lines.emplace_back(update_time + draw_time, oss.str());
+    }
+    std::sort(lines.begin(), lines.end(), std::greater<std::pair<uint64_t, std::string>>());
+    if (lines.size() > num_lines) {
+      lines.resize(num_lines);
+    }
+
+    performance_overlay_lines.clear();
+    std::shared_ptr<TextSurface> title = std::make_shared<TextSurface>(
+        4, 4, TextSurface::HorizontalAlignment::LEFT, TextSurface::VerticalAlignment::TOP
+    );
+    title->set_text("Entities: update + draw per frame");
+    performance_overlay_lines.push_back(title);
+    for (const auto& line: lines) {
+      std::shared_ptr<TextSurface> text = std::make_shared<TextSurface>(
+          4, 4 + 12 * static_cast<int>(performance_overlay_lines.size()),
+          TextSurface::HorizontalAlignment::LEFT, TextSurface::VerticalAlignment::TOP
+      );
+      text->set_text(line.second);
+      performance_overlay_lines.push_back(text);
+    }
+
+    const uint64_t num_path_hits = path_finding_cache.get_num_hits();
+    const uint64_t num_paths = num_path_hits + path_finding_cache.get_num_misses();
+    std::ostringstream oss;
+    oss << "Path cache: " << num_path_hits << " / " << num_paths << " hits";
+    std::shared_ptr<TextSurface> path_cache_line = std::make_shared<TextSurface>(
+        4, 4 + 12 * static_cast<int>(performance_overlay_lines.size()),
+        TextSurface::HorizontalAlignment::LEFT, TextSurface::VerticalAlignment::TOP
+    );
+    path_cache_line->set_text(oss.str());
+    performance_overlay_lines.push_back(path_cache_line);
+  }
+
+  const SurfacePtr& dst_surface = map.get_visible_surface();
+  for (const std::shared_ptr<TextSurface>& line: performance_overlay_lines) {
+    line->draw(dst_surface);
+  }
 }
 
 /**
@@ -947,14 +1266,67 @@ void MapEntities::set_entity_drawn_in_y_order(
   const Layer layer = entity.get_layer();
   if (drawn_in_y_order) {
     entities_drawn_first[layer].remove(&entity);
-    entities_drawn_y_order[layer].push_back(&entity);
+    add_drawn_in_y_order(entity, layer);
   }
   else {
-    entities_drawn_y_order[layer].remove(&entity);
+    remove_drawn_in_y_order(entity, layer);
     entities_drawn_first[layer].push_back(&entity);
   }
 }
 
+/**
+ * \brief Adds an entity at the end of the entities drawn in y order.
+ *
+ * It will be moved to its place at the next update.
+ *
+ * \param entity The entity to add.
+ * \param layer Layer where to add it.
+ */
+void MapEntities::add_drawn_in_y_order(Entity& entity, Layer layer) {
+
+  entities_drawn_y_order[layer].push_back(&entity);
+  y_order_changed[layer] = true;
+}
+
+/**
+ * \brief Removes an entity from the entities drawn in y order.
+ *
+ * The order of the other ones is kept.
+ *
+ * \param entity The entity to remove.
+ * \param layer Layer where it is.
+ */
+void MapEntities::remove_drawn_in_y_order(Entity& entity, Layer layer) {
+
+  std::vector<Entity*>& entities = entities_drawn_y_order[layer];
+  entities.erase(std::remove(entities.begin(), entities.end(), &entity), entities.end());
+}
+
+/**
+ * \brief Sorts the entities drawn in y order on a layer.
+ *
+ * Only a few entities move between two updates, so the vector is almost
+ * sorted: an insertion sort is linear in this case.
+ * Like the sorting of a list, it is stable: entities with the same y
+ * keep their relative order.
+ *
+ * \param layer The layer to sort.
+ */
+void MapEntities::sort_drawn_in_y_order(Layer layer) {
+
+  std::vector<Entity*>& entities = entities_drawn_y_order[layer];
+  for (size_t i = 1; i < entities.size(); ++i) {
+    Entity* entity = entities[i];
+    size_t j = i;
+    while (j > 0 && compare_y(entity, entities[j - 1])) {
+      entities[j] = entities[j - 1];
+      --j;
+    }
+    entities[j] = entity;
+  }
+  y_order_changed[layer] = false;
+}
+
 /**
  * \brief Changes the layer of an entity.
  *
@@ -973,6 +1345,11 @@ void MapEntities::set_entity_layer(Entity& entity, Layer layer) {
     if (entity.can_be_obstacle() && !entity.has_layer_independent_collisions()) {
       obstacle_entities[old_layer].remove(&entity);
       obstacle_entities[layer].push_back(&entity);
+      obstacle_trees[old_layer].remove(&entity);
+      obstacle_trees[layer].add(&entity, entity.get_bounding_box());
+      const Rectangle cells = get_grid_cells(entity.get_bounding_box());
+      notify_path_finding_cells_changed(old_layer, cells);
+      notify_path_finding_cells_changed(layer, cells);
     }
 
     // update the ground observers list
@@ -985,12 +1362,14 @@ void MapEntities::set_entity_layer(Entity& entity, Layer layer) {
     if (entity.is_ground_modifier()) {
       ground_modifiers[old_layer].remove(&entity);
       ground_modifiers[layer].push_back(&entity);
+      notify_path_finding_ground_modifier_changed(entity, old_layer, false);
+      notify_path_finding_ground_modifier_changed(entity, layer, true);
     }
 
     // update the sprites list
     if (entity.is_drawn_in_y_order()) {
-      entities_drawn_y_order[old_layer].remove(&entity);
-      entities_drawn_y_order[layer].push_back(&entity);
+      remove_drawn_in_y_order(entity, old_layer);
+      add_drawn_in_y_order(entity, layer);
     }
     else if (entity.can_be_drawn()) {
       entities_drawn_first[old_layer].remove(&entity);
@@ -1009,9 +1388,51 @@ void MapEntities::set_entity_layer(Entity& entity, Layer layer) {
  */
 void MapEntities::notify_entity_bounding_box_changed(Entity& entity) {
 
+  // The drawing order may change.
+  if (entity.is_drawn_in_y_order()) {
+    y_order_changed[entity.get_layer()] = true;
+  }
+
   // Update the quadtree.
   EntityPtr shared_entity = std::static_pointer_cast<Entity>(entity.shared_from_this());
   quadtree.move(shared_entity, shared_entity->get_max_bounding_box());
+  if (entity.is_detector()) {
+    simple_detector_tree.move(shared_entity, shared_entity->get_max_bounding_box());
+    sprite_detector_tree.move(shared_entity, shared_entity->get_max_bounding_box());
+  }
+
+  // Update the obstacle trees.
+  if (entity.can_be_obstacle()) {
+    if (entity.has_layer_independent_collisions()) {
+      for (int i = 0; i < LAYER_NB; ++i) {
+        obstacle_trees[i].move(&entity, entity.get_bounding_box());
+      }
+    }
+    else {
+      obstacle_trees[entity.get_layer()].move(&entity, entity.get_bounding_box());
+    }
+
+    // Paths only change if the obstacle overlaps other squares of the grid.
+    const auto it = obstacle_cells.find(&entity);
+    const Rectangle cells = get_grid_cells(entity.get_bounding_box());
+    if (it != obstacle_cells.end() && cells != it->second) {
+      notify_path_finding_obstacle_changed(entity, it->second);
+      notify_path_finding_obstacle_changed(entity, cells);
+      it->second = cells;
+    }
+  }
+
+  // The terrain only changes if the ground modifier overlaps other squares
+  // of the grid.
+  if (entity.is_ground_modifier()) {
+    const Rectangle cells = get_grid_cells(entity.get_bounding_box());
+    Rectangle& old_cells = ground_modifier_cells[&entity];
+    if (cells != old_cells) {
+      notify_path_finding_cells_changed(entity.get_layer(), old_cells);
+      old_cells = cells;
+      notify_path_finding_ground_modifier_changed(entity, entity.get_layer(), true);
+    }
+  }
 }
 
 /**
@@ -1037,8 +1458,257 @@ void MapEntities::notify_entity_ground_modifier_changed(Entity& entity) {
 
   Layer layer = entity.get_layer();
   ground_modifiers[layer].remove(&entity);
+  ground_modifier_cells.erase(&entity);
   if (entity.is_ground_modifier()) {
     ground_modifiers[layer].push_back(&entity);
+    ground_modifier_cells[&entity] = get_grid_cells(entity.get_bounding_box());
+  }
+  notify_path_finding_ground_modifier_changed(entity, layer, entity.is_ground_modifier());
+}
+
+/**
+ * \brief This function should be called when an entity starts or stops
+ * being an obstacle without moving, like a door that opens or an entity
+ * that gets enabled or disabled.
+ * \param entity The entity whose obstacle property may have changed.
+ */
+void MapEntities::notify_entity_obstacle_changed(Entity& entity) {
+
+  if (entity.is_ground_modifier()) {
+    notify_path_finding_ground_modifier_changed(entity, entity.get_layer(), true);
+  }
+  if (entity.can_be_obstacle() && &entity != &hero) {
+    // Whether it blocks shared paths may have changed too.
+    const Rectangle cells = get_grid_cells(entity.get_bounding_box());
+    if (entity.has_layer_independent_collisions()) {
+      for (int i = 0; i < LAYER_NB; ++i) {
+        notify_path_finding_cells_changed(Layer(i), cells);
+      }
+    }
+    else {
+      notify_path_finding_cells_changed(entity.get_layer(), cells);
+    }
+  }
+}
+
+/**
+ * \brief Returns the abstract graph of a layer used to find long paths.
+ *
+ * The graph is created the first time it is needed for these obstacle
+ * grounds and then kept up to date with the terrain.
+ *
+ * \param layer The layer.
+ * \param obstacle_grounds Bits of the grounds that are obstacles
+ * (see PathFindingGraph::get_obstacle_grounds()).
+ * \return The graph.
+ */
+PathFindingGraph& MapEntities::get_path_finding_graph(
+    Layer layer, uint32_t obstacle_grounds) {
+
+  for (const std::unique_ptr<PathFindingGraph>& graph: path_finding_graphs[layer]) {
+    if (graph->get_obstacle_grounds() == obstacle_grounds) {
+      return *graph;
+    }
+  }
+
+  path_finding_graphs[layer].emplace_back(new PathFindingGraph(
+      *this, layer, obstacle_grounds, map_width8, map_height8
+  ));
+  return *path_finding_graphs[layer].back();
+}
+
+/**
+ * \brief Returns the flow field leading to an entity.
+ *
+ * The field is created the first time it is needed for these obstacle
+ * grounds and shared by all entities that chase the same target.
+ *
+ * \param target The entity to reach.
+ * \param obstacle_grounds Bits of the grounds that are obstacles
+ * (see PathFindingGraph::get_obstacle_grounds()).
+ * \return The flow field. Call FlowField::update() before using it.
+ */
+FlowField& MapEntities::get_flow_field(const Entity& target, uint32_t obstacle_grounds) {
+
+  const Layer layer = target.get_layer();
+  for (const std::unique_ptr<FlowField>& flow_field: flow_fields) {
+    if (&flow_field->get_target() == &target
+        && flow_field->get_layer() == layer
+        && flow_field->get_obstacle_grounds() == obstacle_grounds) {
+      return *flow_field;
+    }
+  }
+
+  flow_fields.emplace_back(new FlowField(
+      get_path_finding_graph(layer, obstacle_grounds), target, map_width8, map_height8
+  ));
+  return *flow_fields.back();
+}
+
+/**
+ * \brief Returns a number that changes each time the ground of the map
+ * changes, on any layer.
+ *
+ * This allows to detect that a path computed earlier may be obsolete.
+ *
+ * \return The current version of the terrain.
+ */
+uint32_t MapEntities::get_terrain_version() const {
+  return terrain_version;
+}
+
+/**
+ * \brief Returns a number that changes each time the obstacles of an area
+ * change.
+ *
+ * This includes the ground and obstacle entities that are added, removed,
+ * enabled, disabled, opened, closed or that move to other 8x8 squares.
+ * The hero is not included: it moves all the time and is an obstacle
+ * for few entities.
+ * Neither are entities that are never obstacles for entities sharing
+ * their paths, like traversable enemies.
+ *
+ * Changes are tracked by regions of 64x64 pixels, so the version may also
+ * change when obstacles change close to the area.
+ *
+ * \param layer A layer.
+ * \param area A rectangle of the map.
+ * \return The current version of the obstacles of this area.
+ */
+uint32_t MapEntities::get_obstacle_version(Layer layer, const Rectangle& area) const {
+
+  const std::vector<uint32_t>& versions = obstacle_versions[layer];
+  const int width = (map_width8 + obstacle_region_size8 - 1) / obstacle_region_size8;
+  const int height = (map_height8 + obstacle_region_size8 - 1) / obstacle_region_size8;
+  if (versions.size() != static_cast<size_t>(width * height)) {
+    return 0;
+  }
+
+  const Rectangle cells = get_grid_cells(area);
+  const int x_min = std::max(cells.get_x() / obstacle_region_size8, 0);
+  const int y_min = std::max(cells.get_y() / obstacle_region_size8, 0);
+  const int x_max = std::min((cells.get_x() + cells.get_width() - 1) / obstacle_region_size8, width - 1);
+  const int y_max = std::min((cells.get_y() + cells.get_height() - 1) / obstacle_region_size8, height - 1);
+
+  uint32_t version = 0;
+  for (int y = y_min; y <= y_max; ++y) {
+    for (int x = x_min; x <= x_max; ++x) {
+      version = std::max(version, versions[y * width + x]);
+    }
+  }
+  return version;
+}
+
+/**
+ * \brief Returns the paths searched recently on this map.
+ * \return The path finding cache.
+ */
+PathFindingCache& MapEntities::get_path_finding_cache() {
+  return path_finding_cache;
+}
+
+/**
+ * \brief Notifies the path finding graphs of a layer that the ground
+ * has changed in an area.
+ * \param layer The layer.
+ * \param area The rectangle whose ground has changed.
+ */
+void MapEntities::notify_path_finding_ground_changed(
+    Layer layer, const Rectangle& area) {
+
+  ++terrain_version;
+  notify_path_finding_cells_changed(layer, get_grid_cells(area));
+  for (const std::unique_ptr<PathFindingGraph>& graph: path_finding_graphs[layer]) {
+    graph->notify_ground_changed(area);
+  }
+}
+
+/**
+ * \brief Notifies the path finding graphs of a layer that a ground modifier
+ * has been added, moved or removed.
+ * \param entity The ground modifier.
+ * \param layer The layer.
+ * \param present \c false if the entity is no longer a ground modifier
+ * of this layer.
+ */
+void MapEntities::notify_path_finding_ground_modifier_changed(
+    Entity& entity, Layer layer, bool present) {
+
+  ++terrain_version;
+  notify_path_finding_cells_changed(layer, get_grid_cells(entity.get_bounding_box()));
+  for (const std::unique_ptr<PathFindingGraph>& graph: path_finding_graphs[layer]) {
+    graph->notify_ground_modifier_changed(entity, present);
+  }
+}
+
+/**
+ * \brief Notifies the path finding that an obstacle entity
+ * has been added, moved or removed.
+ *
+ * Changes of the hero and of entities that never block shared paths
+ * are ignored (see get_obstacle_version()).
+ *
+ * \param entity The obstacle entity.
+ * \param cells The 8x8 squares where it appeared or disappeared.
+ */
+void MapEntities::notify_path_finding_obstacle_changed(
+    const Entity& entity, const Rectangle& cells) {
+
+  if (&entity == &hero || !can_block_shared_paths(entity)) {
+    return;
+  }
+
+  if (entity.has_layer_independent_collisions()) {
+    for (int i = 0; i < LAYER_NB; ++i) {
+      notify_path_finding_cells_changed(Layer(i), cells);
+    }
+  }
+  else {
+    notify_path_finding_cells_changed(entity.get_layer(), cells);
+  }
+}
+
+/**
+ * \brief Changes the obstacle version of the regions of a layer
+ * that overlap some squares.
+ * \param layer The layer.
+ * \param cells The 8x8 squares where obstacles have changed.
+ */
+void MapEntities::notify_path_finding_cells_changed(
+    Layer layer, const Rectangle& cells) {
+
+  std::vector<uint32_t>& versions = obstacle_versions[layer];
+  const int width = (map_width8 + obstacle_region_size8 - 1) / obstacle_region_size8;
+  const int height = (map_height8 + obstacle_region_size8 - 1) / obstacle_region_size8;
+  if (versions.size() != static_cast<size_t>(width * height)) {
+    versions.assign(width * height, 0);
+  }
+
+  const int x_min = std::max(cells.get_x() / obstacle_region_size8, 0);
+  const int y_min = std::max(cells.get_y() / obstacle_region_size8, 0);
+  const int x_max = std::min((cells.get_x() + cells.get_width() - 1) / obstacle_region_size8, width - 1);
+  const int y_max = std::min((cells.get_y() + cells.get_height() - 1) / obstacle_region_size8, height - 1);
+
+  ++obstacle_change_date;
+  for (int y = y_min; y <= y_max; ++y) {
+    for (int x = x_min; x <= x_max; ++x) {
+      versions[y * width + x] = obstacle_change_date;
+    }
+  }
+}
+
+/**
+ * \brief This function should be called when the collision modes of a
+ * detector change.
+ * \param detector The detector whose collision modes have changed.
+ */
+void MapEntities::notify_detector_collision_modes_changed(Detector& detector) {
+
+  EntityPtr shared_detector = std::static_pointer_cast<Entity>(detector.shared_from_this());
+  simple_detector_tree.remove(shared_detector);
+  sprite_detector_tree.remove(shared_detector);
+  if (!detector.is_being_removed()) {
+    add_to_detector_trees(shared_detector);
   }
 }
 
@@ -23,6 +23,7 @@
 #include "solarus/entities/TilesetData.h"
 #include "solarus/entities/TimeScrollingTilePattern.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/MemoryStats.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/lua/LuaData.h"
 #include "solarus/lua/LuaTools.h"
@@ -42,6 +43,14 @@ Tileset::Tileset(const std::string& id):
   entities_image(nullptr) {
 }
 
+/**
+ * \brief Destructor.
+ */
+Tileset::~Tileset() {
+
+  MemoryStats::remove(MemoryCategory::TILESETS, get_images_memory_size());
+}
+
 /**
  * \brief Returns the id of this tileset.
  * \return the tileset id
@@ -152,6 +161,8 @@ void Tileset::load() {
     Debug::error(std::string("Missing entities image for tileset '") + id + "': " + file_name);
     entities_image = Surface::create(16, 16);
   }
+
+  MemoryStats::add(MemoryCategory::TILESETS, get_images_memory_size());
 }
 
 /**
@@ -161,6 +172,7 @@ void Tileset::load() {
 void Tileset::unload() {
 
   tile_patterns.clear();
+  MemoryStats::remove(MemoryCategory::TILESETS, get_images_memory_size());
   tiles_image = nullptr;
   entities_image = nullptr;
 }
@@ -181,6 +193,22 @@ bool Tileset::is_loaded() {
   return tiles_image != nullptr;
 }
 
+/**
+ * \brief Returns the memory used by the images of this tileset.
+ * \return The size of the images in bytes, or 0 if the tileset is not loaded.
+ */
+int64_t Tileset::get_images_memory_size() const {
+
+  int64_t size = 0;
+  if (tiles_image != nullptr) {
+    size += tiles_image->get_memory_size();
+  }
+  if (entities_image != nullptr) {
+    size += entities_image->get_memory_size();
+  }
+  return size;
+}
+
 /**
  * \brief Returns the image containing the tiles of this tileset.
  * \return the tiles image
@@ -225,8 +253,10 @@ void Tileset::set_images(const std::string& other_id) {
   Tileset tmp_tileset(other_id);
   tmp_tileset.load();
 
+  MemoryStats::remove(MemoryCategory::TILESETS, get_images_memory_size());
   tiles_image = tmp_tileset.get_tiles_image();
   entities_image = tmp_tileset.get_entities_image();
+  MemoryStats::add(MemoryCategory::TILESETS, get_images_memory_size());
 
   background_color = tmp_tileset.get_background_color();
 }
@@ -15,6 +15,7 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/MemoryStats.h"
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lowlevel/FontResource.h"
 #include "solarus/lowlevel/Surface.h"
@@ -39,6 +40,9 @@ void FontResource::initialize() {
  */
 void FontResource::quit() {
 
+  for (const auto& kvp: fonts) {
+    MemoryStats::remove(MemoryCategory::FONTS, get_memory_size(kvp.second));
+  }
   fonts.clear();
   fonts_loaded = false;
   TTF_Quit();
@@ -107,12 +111,26 @@ void FontResource::load_fonts() {
       font.bitmap_font = nullptr;
     }
 
+    MemoryStats::add(MemoryCategory::FONTS, get_memory_size(font));
     fonts.emplace(font_id, std::move(font));
   }
 
   fonts_loaded = true;
 }
 
+/**
+ * \brief Returns the memory used by a loaded font.
+ * \param font A font.
+ * \return The size of the font file or of the bitmap in bytes.
+ */
+int64_t FontResource::get_memory_size(const FontFile& font) {
+
+  if (font.bitmap_font != nullptr) {
+    return font.bitmap_font->get_memory_size();
+  }
+  return font.buffer.size();
+}
+
 /**
  * \brief Returns the id of default font.
  * \return Id of the first font in alphabetical order, or an empty string
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/FrameStats.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Solarus {
+
+/**
+ * \brief Creates empty frame statistics.
+ */
+FrameStats::FrameStats():
+  num_frames(0),
+  total_duration(0),
+  total_squared_duration(0.0),
+  min_duration(0),
+  max_duration(0),
+  histogram(num_buckets, 0) {
+
+}
+
+/**
+ * \brief Forgets all frames measured so far.
+ */
+void FrameStats::clear() {
+
+  num_frames = 0;
+  total_duration = 0;
+  total_squared_duration = 0.0;
+  min_duration = 0;
+  max_duration = 0;
+  std::fill(histogram.begin(), histogram.end(), 0);
+}
+
+/**
+ * \brief Adds the duration of a frame.
+ * \param duration Time elapsed since the previous frame in microseconds.
+ */
+void FrameStats::add_frame(uint64_t duration) {
+
+  if (num_frames == 0) {
+    min_duration = duration;
+    max_duration = duration;
+  }
+  else {
+    min_duration = std::min(min_duration, duration);
+    max_duration = std::max(max_duration, duration);
+  }
+  ++num_frames;
+  total_duration += duration;
+  total_squared_duration += static_cast<double>(duration) * duration;
+
+  const uint64_t bucket = std::min<uint64_t>(duration / 1000, num_buckets - 1);
+  ++histogram[bucket];
+}
+
+/**
+ * \brief Returns the number of frames measured.
+ * \return The number of frames.
+ */
+int FrameStats::get_num_frames() const {
+  return num_frames;
+}
+
+/**
+ * \brief Returns the duration of the shortest frame.
+ * \return The shortest duration in microseconds, or 0 if there is no frame.
+ */
+uint64_t FrameStats::get_min_duration() const {
+  return min_duration;
+}
+
+/**
+ * \brief Returns the duration of the longest frame.
+ * \return The longest duration in microseconds, or 0 if there is no frame.
+ */
+uint64_t FrameStats::get_max_duration() const {
+  return max_duration;
+}
+
+/**
+ * \brief Returns the average duration of frames.
+ * \return The average duration in microseconds, or 0 if there is no frame.
+ */
+double FrameStats::get_average_duration() const {
+
+  if (num_frames == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(total_duration) / num_frames;
+}
+
+/**
+ * \brief Returns the standard deviation of the duration of frames.
+ * \return The jitter in microseconds, or 0 if there is no frame.
+ */
+double FrameStats::get_jitter() const {
+
+  if (num_frames == 0) {
+    return 0.0;
+  }
+  const double average = get_average_duration();
+  const double variance = total_squared_duration / num_frames - average * average;
+  return std::sqrt(std::max(variance, 0.0));
+}
+
+/**
+ * \brief Returns the histogram of frame durations.
+ * \return The number of frames of each duration. Index i counts frames
+ * that lasted between i and i + 1 milliseconds, except the last index
+ * that counts all longer frames.
+ */
+const std::vector<int>& FrameStats::get_histogram() const {
+  return histogram;
+}
+
+}
+
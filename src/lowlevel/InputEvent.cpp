@@ -20,6 +20,8 @@
 #include "solarus/lowlevel/Debug.h"
 #include <SDL.h>
 #include <cstdlib>  // std::abs
+#include <cstring>
+#include <sstream>
 
 namespace Solarus {
 
@@ -1274,5 +1276,133 @@ bool InputEvent::is_window_closing() const {
   return internal_event.type == SDL_QUIT;
 }
 
+/**
+ * \brief Converts this event to a single line of text.
+ *
+ * This is used to record input events and replay them later.
+ * The format only depends on the fields that Solarus uses.
+ *
+ * \return A textual representation of the event, without newline.
+ */
+std::string InputEvent::serialize() const {
+
+  std::ostringstream oss;
+  oss << internal_event.type;
+
+  switch (internal_event.type) {
+
+  case SDL_KEYDOWN:
+  case SDL_KEYUP:
+    oss << " " << internal_event.key.keysym.sym
+        << " " << internal_event.key.keysym.mod
+        << " " << static_cast<int>(internal_event.key.repeat);
+    break;
+
+  case SDL_TEXTINPUT:
+    oss << " " << internal_event.text.text;
+    break;
+
+  case SDL_MOUSEBUTTONDOWN:
+  case SDL_MOUSEBUTTONUP:
+    oss << " " << static_cast<int>(internal_event.button.button)
+        << " " << internal_event.button.x
+        << " " << internal_event.button.y;
+    break;
+
+  case SDL_JOYAXISMOTION:
+    oss << " " << static_cast<int>(internal_event.jaxis.axis)
+        << " " << internal_event.jaxis.value;
+    break;
+
+  case SDL_JOYHATMOTION:
+    oss << " " << static_cast<int>(internal_event.jhat.hat)
+        << " " << static_cast<int>(internal_event.jhat.value);
+    break;
+
+  case SDL_JOYBUTTONDOWN:
+  case SDL_JOYBUTTONUP:
+    oss << " " << static_cast<int>(internal_event.jbutton.button);
+    break;
+
+  default:
+    break;
+  }
+
+  return oss.str();
+}
+
+/**
+ * \brief Creates an event from its textual representation.
+ * \param data A string previously returned by serialize().
+ * \return The corresponding event, or nullptr if the data is invalid.
+ */
+std::unique_ptr<InputEvent> InputEvent::deserialize(const std::string& data) {
+
+  std::istringstream iss(data);
+  SDL_Event internal_event;
+  std::memset(&internal_event, 0, sizeof(internal_event));
+  if (!(iss >> internal_event.type)) {
+    return nullptr;
+  }
+
+  int a = 0, b = 0, c = 0;
+  bool valid = true;
+  switch (internal_event.type) {
+
+  case SDL_KEYDOWN:
+  case SDL_KEYUP:
+    valid = static_cast<bool>(iss >> a >> b >> c);
+    internal_event.key.keysym.sym = a;
+    internal_event.key.keysym.mod = b;
+    internal_event.key.repeat = c;
+    break;
+
+  case SDL_TEXTINPUT:
+  {
+    std::string text;
+    iss.get();  // Skip the separator.
+    std::getline(iss, text);
+    valid = text.size() < sizeof(internal_event.text.text);
+    if (valid) {
+      std::strcpy(internal_event.text.text, text.c_str());
+    }
+    break;
+  }
+
+  case SDL_MOUSEBUTTONDOWN:
+  case SDL_MOUSEBUTTONUP:
+    valid = static_cast<bool>(iss >> a >> b >> c);
+    internal_event.button.button = a;
+    internal_event.button.x = b;
+    internal_event.button.y = c;
+    break;
+
+  case SDL_JOYAXISMOTION:
+    valid = static_cast<bool>(iss >> a >> b);
+    internal_event.jaxis.axis = a;
+    internal_event.jaxis.value = b;
+    break;
+
+  case SDL_JOYHATMOTION:
+    valid = static_cast<bool>(iss >> a >> b);
+    internal_event.jhat.hat = a;
+    internal_event.jhat.value = b;
+    break;
+
+  case SDL_JOYBUTTONDOWN:
+  case SDL_JOYBUTTONUP:
+    valid = static_cast<bool>(iss >> a);
+    internal_event.jbutton.button = a;
+    break;
+
+  default:
+    break;
+  }
+
+  if (!valid) {
+    return nullptr;
+  }
+  return std::unique_ptr<InputEvent>(new InputEvent(internal_event));
 }
 
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/InputEvent.h"
+#include "solarus/lowlevel/InputRecorder.h"
+
+namespace Solarus {
+
+/**
+ * \brief Creates a recording file.
+ * \param file_name Path of the file to write.
+ * \param seed Seed of the random number generator used by the session.
+ */
+InputRecorder::InputRecorder(const std::string& file_name, uint32_t seed):
+  file(file_name) {
+
+  file << "seed " << seed << std::endl;
+}
+
+/**
+ * \brief Returns whether the file could be opened.
+ * \return \c true if events can be recorded.
+ */
+bool InputRecorder::is_valid() const {
+  return file.good();
+}
+
+/**
+ * \brief Records an input event.
+ * \param step Number of the simulation step before which the event is
+ * handled.
+ * \param event The event.
+ */
+void InputRecorder::record(uint32_t step, const InputEvent& event) {
+
+  file << step << " " << event.serialize() << '\n';
+}
+
+/**
+ * \brief Finishes the recording.
+ * \param num_steps Total number of steps of the session.
+ */
+void InputRecorder::finish(uint32_t num_steps) {
+
+  file << "end " << num_steps << std::endl;
+  file.close();
+}
+
+}
+
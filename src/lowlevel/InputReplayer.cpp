@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/InputReplayer.h"
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace Solarus {
+
+/**
+ * \brief Loads a recording file.
+ *
+ * Errors are reported with Debug::error() and make the replayer invalid.
+ *
+ * \param file_name Path of a file written by InputRecorder.
+ */
+InputReplayer::InputReplayer(const std::string& file_name):
+  valid(false),
+  seed(0),
+  num_steps(std::numeric_limits<uint32_t>::max()),
+  events() {
+
+  std::ifstream file(file_name);
+  std::string keyword;
+  if (!(file >> keyword >> seed) || keyword != "seed") {
+    Debug::error("Invalid input recording file: '" + file_name + "'");
+    return;
+  }
+
+  std::string line;
+  std::getline(file, line);  // End of the seed line.
+  while (std::getline(file, line)) {
+
+    if (line.empty()) {
+      continue;
+    }
+
+    std::istringstream iss(line);
+    if (line.compare(0, 4, "end ") == 0) {
+      iss >> keyword >> num_steps;
+      break;
+    }
+
+    uint32_t step = 0;
+    if (!(iss >> step)) {
+      Debug::error("Invalid line in input recording file: '" + line + "'");
+      return;
+    }
+    iss.get();  // Skip the separator.
+    std::string data;
+    std::getline(iss, data);
+    events.emplace_back(step, data);
+  }
+
+  valid = true;
+}
+
+/**
+ * \brief Returns whether the recording was successfully loaded.
+ * \return \c true if events can be replayed.
+ */
+bool InputReplayer::is_valid() const {
+  return valid;
+}
+
+/**
+ * \brief Returns the seed of the random number generator of the recorded
+ * session.
+ * \return The seed.
+ */
+uint32_t InputReplayer::get_seed() const {
+  return seed;
+}
+
+/**
+ * \brief Returns the next recorded event of a step.
+ *
+ * Call this function repeatedly until it returns nullptr to get all
+ * events of the step in their original order.
+ *
+ * \param step The current simulation step.
+ * \return The next event recorded before this step, or nullptr if there
+ * is no more event for this step.
+ */
+std::unique_ptr<InputEvent> InputReplayer::get_event(uint32_t step) {
+
+  while (!events.empty() && events.front().first <= step) {
+    std::unique_ptr<InputEvent> event = InputEvent::deserialize(events.front().second);
+    if (event == nullptr) {
+      Debug::error("Invalid input event in recording: '" + events.front().second + "'");
+    }
+    events.pop_front();
+    if (event != nullptr) {
+      return event;
+    }
+  }
+
+  return nullptr;
+}
+
+/**
+ * \brief Returns whether the recorded session is finished.
+ * \param step The current simulation step.
+ * \return \c true if the recorded session did not last more steps.
+ */
+bool InputReplayer::is_finished(uint32_t step) const {
+  return step >= num_steps;
+}
+
+}
+
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/MemoryStats.h"
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+
+namespace Solarus {
+
+namespace MemoryStats {
+
+namespace {
+
+std::atomic<int64_t> sizes[num_categories];  /**< Bytes used by each category. */
+
+const std::string category_names[num_categories] = {
+    "surfaces",
+    "textures",
+    "sprites",
+    "sounds",
+    "music",
+    "fonts",
+    "tilesets"
+};
+
+/**
+ * \brief Formats a number of bytes for humans.
+ * \param size A number of bytes.
+ * \return The size in kilobytes or megabytes.
+ */
+std::string format_size(int64_t size) {
+
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(1);
+  if (size >= 1024 * 1024) {
+    oss << (size / (1024.0 * 1024.0)) << " MB";
+  }
+  else {
+    oss << (size / 1024.0) << " KB";
+  }
+  return oss.str();
+}
+
+}
+
+/**
+ * \brief Records that some memory was allocated.
+ * \param category Category of the resource.
+ * \param size Number of bytes allocated.
+ */
+void add(MemoryCategory category, int64_t size) {
+  sizes[static_cast<int>(category)] += size;
+}
+
+/**
+ * \brief Records that some memory was freed.
+ * \param category Category of the resource.
+ * \param size Number of bytes freed.
+ */
+void remove(MemoryCategory category, int64_t size) {
+  sizes[static_cast<int>(category)] -= size;
+}
+
+/**
+ * \brief Returns the memory currently used by a category.
+ * \param category A category of resources.
+ * \return The number of bytes used.
+ */
+int64_t get(MemoryCategory category) {
+  return sizes[static_cast<int>(category)];
+}
+
+/**
+ * \brief Returns the name of a category.
+ * \param category A category of resources.
+ * \return Its name, as used in reports and in the Lua API.
+ */
+const std::string& get_category_name(MemoryCategory category) {
+  return category_names[static_cast<int>(category)];
+}
+
+/**
+ * \brief Returns a one-line summary of the memory used by each category.
+ * \param lua_size Size of the Lua heap in bytes.
+ * \return The summary.
+ */
+std::string get_report(int64_t lua_size) {
+
+  std::ostringstream oss;
+  for (int i = 0; i < num_categories; ++i) {
+    oss << category_names[i] << " " << format_size(sizes[i]) << ", ";
+  }
+  oss << "lua " << format_size(lua_size);
+  return oss.str();
+}
+
+}
+
+}
+
@@ -19,6 +19,8 @@
 #include "solarus/lowlevel/ItDecoder.h"
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/MemoryStats.h"
+#include "solarus/lowlevel/Profiler.h"
 #include "solarus/lua/LuaContext.h"
 #include <lua.hpp>
 #include <algorithm>
@@ -53,7 +55,8 @@ Music::Music():
   format(NO_FORMAT),
   loop(false),
   callback_ref(),
-  source(AL_NONE) {
+  source(AL_NONE),
+  memory_size(0) {
 
   for (int i = 0; i < nb_buffers; i++) {
     buffers[i] = AL_NONE;
@@ -76,7 +79,8 @@ Music::Music(
   format(OGG),
   loop(loop),
   callback_ref(callback_ref),
-  source(AL_NONE) {
+  source(AL_NONE),
+  memory_size(0) {
 
   Debug::check_assertion(!loop || callback_ref.is_empty(),
       "Attempt to set both a loop and a callback to music"
@@ -362,7 +366,11 @@ void Music::update() {
   }
 
   if (current_music != nullptr) {
-    bool playing = current_music->update_playing();
+    bool playing = false;
+    {
+      Profiler::Zone zone("Music::update_playing");
+      playing = current_music->update_playing();
+    }
     if (!playing) {
       // Music is finished.
       ScopedLuaRef callback_ref = current_music->callback_ref;
@@ -569,6 +577,7 @@ bool Music::start() {
 
       // load the SPC data into the SPC decoding library
       spc_decoder->load((int16_t*) sound_buffer.data(), sound_buffer.size());
+      memory_size = sound_buffer.size();
 
       for (int i = 0; i < nb_buffers; i++) {
         decode_spc(buffers[i], 4096);
@@ -581,6 +590,7 @@ bool Music::start() {
 
       // load the IT data into the IT decoding library
       it_decoder->load(sound_buffer);
+      memory_size = sound_buffer.size();
 
       for (int i = 0; i < nb_buffers; i++) {
         decode_it(buffers[i], 4096);
@@ -593,6 +603,7 @@ bool Music::start() {
       ogg_mem.loop = this->loop;
       ogg_mem.data = QuestFiles::data_file_read(file_name);
       // now, ogg_mem contains the encoded data
+      memory_size = ogg_mem.data.size();
 
       int error = ov_open_callbacks(&ogg_mem, &ogg_file, nullptr, 0, Sound::ogg_callbacks);
       if (error) {
@@ -614,6 +625,10 @@ bool Music::start() {
       break;
   }
 
+  // Count the encoded data and the streaming buffers (4096 stereo samples each).
+  memory_size += nb_buffers * 4096 * 2 * sizeof(ALshort);
+  MemoryStats::add(MemoryCategory::MUSIC, memory_size);
+
   // start the streaming
   alSourceQueueBuffers(source, nb_buffers, buffers);
   int error = alGetError();
@@ -662,6 +677,8 @@ void Music::stop() {
 
   // delete the buffers
   alDeleteBuffers(nb_buffers, buffers);
+  MemoryStats::remove(MemoryCategory::MUSIC, memory_size);
+  memory_size = 0;
 
   switch (format) {
 
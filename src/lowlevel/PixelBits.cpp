@@ -23,8 +23,91 @@
 #include <algorithm>
 #include <iostream> // print functions
 
+#if defined(__AVX2__)
+#  define SOLARUS_PIXEL_BITS_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define SOLARUS_PIXEL_BITS_SSE2 1
+#endif
+
+#if defined(SOLARUS_PIXEL_BITS_AVX2)
+#  include <immintrin.h>
+#elif defined(SOLARUS_PIXEL_BITS_SSE2)
+#  include <emmintrin.h>
+#endif
+
 namespace Solarus {
 
+namespace {
+
+/**
+ * \brief Returns 64 consecutive pixel bits of a row.
+ * \param row The row.
+ * \param first_bit Index of the first pixel to get. The word containing it
+ * must be followed by another one in the row.
+ * \return Bit i is the bit of pixel first_bit + i.
+ */
+inline uint64_t get_bits(const uint64_t* row, int first_bit) {
+
+  const int word = first_bit >> 6;
+  const int shift = first_bit & 63;
+  if (shift == 0) {
+    return row[word];
+  }
+  return (row[word] >> shift) | (row[word + 1] << (64 - shift));
+}
+
+#ifdef SOLARUS_PIXEL_BITS_SSE2
+/**
+ * \brief Like get_bits(), but on two rows at once.
+ *
+ * A shift count of 64 gives zero, so no special case is needed
+ * when the first bit is aligned.
+ */
+inline __m128i get_bits_sse2(
+    const uint64_t* row0,
+    const uint64_t* row1,
+    int word,
+    __m128i shift,
+    __m128i inverse_shift) {
+
+  const __m128i low = _mm_set_epi64x(
+      static_cast<long long>(row1[word]),
+      static_cast<long long>(row0[word]));
+  const __m128i high = _mm_set_epi64x(
+      static_cast<long long>(row1[word + 1]),
+      static_cast<long long>(row0[word + 1]));
+  return _mm_or_si128(_mm_srl_epi64(low, shift), _mm_sll_epi64(high, inverse_shift));
+}
+#endif
+
+#ifdef SOLARUS_PIXEL_BITS_AVX2
+/**
+ * \brief Like get_bits(), but on four rows at once.
+ */
+inline __m256i get_bits_avx2(
+    const uint64_t* row,
+    int row_stride,
+    int word,
+    __m128i shift,
+    __m128i inverse_shift) {
+
+  const __m256i low = _mm256_set_epi64x(
+      static_cast<long long>(row[3 * row_stride + word]),
+      static_cast<long long>(row[2 * row_stride + word]),
+      static_cast<long long>(row[row_stride + word]),
+      static_cast<long long>(row[word]));
+  const __m256i high = _mm256_set_epi64x(
+      static_cast<long long>(row[3 * row_stride + word + 1]),
+      static_cast<long long>(row[2 * row_stride + word + 1]),
+      static_cast<long long>(row[row_stride + word + 1]),
+      static_cast<long long>(row[word + 1]));
+  return _mm256_or_si256(_mm256_srl_epi64(low, shift), _mm256_sll_epi64(high, inverse_shift));
+}
+#endif
+
+}
+
 /**
  * \brief Creates a pixel bits object.
  * \param surface The surface where the image is.
@@ -33,7 +116,8 @@ namespace Solarus {
 PixelBits::PixelBits(const Surface& surface, const Rectangle& image_position):
   width(0),
   height(0),
-  nb_integers_per_row(0),
+  nb_words_per_row(0),
+  opaque_box(),
   bits() {
 
   // Create a list of boolean values representing the transparency of each pixel.
@@ -54,38 +138,125 @@ PixelBits::PixelBits(const Surface& surface, const Rectangle& image_position):
   width = clipped_image_position.get_width();
   height = clipped_image_position.get_height();
 
-  nb_integers_per_row = width >> 5; // width / 32
-  if ((width & 31) != 0) { // width % 32 != 0
-    nb_integers_per_row++;
-  }
+  // One more word so that bits can be read across two words without
+  // going past the row.
+  nb_words_per_row = ((width + 63) >> 6) + 1;
 
   int pixel_index = clipped_image_position.get_y() * surface.get_width() + clipped_image_position.get_x();
 
-  bits.resize(height);
+  bits.assign(height * nb_words_per_row, 0);
   for (int i = 0; i < height; ++i) {
-    bits[i].resize(nb_integers_per_row);
+    build_row(surface, pixel_index, &bits[i * nb_words_per_row]);
+    pixel_index += surface.get_width();
+  }
+
+  compute_opaque_box();
+}
 
-    // Fill the bits for this row, using nb_integers_per_row sequences of 32 bits.
-    int k = -1;
-    uint32_t mask = 0x00000000;  // Current bit in the sequence of 32 bits.
+/**
+ * \brief Fills the bits of a row of the image.
+ * \param surface The surface where the image is.
+ * \param pixel_index Index of the first pixel of the row in the surface.
+ * \param row The row to fill. Must be initialized to zero.
+ */
+void PixelBits::build_row(const Surface& surface, int pixel_index, uint64_t* row) {
+
+  SDL_Surface* internal_surface = surface.internal_surface.get();
+  if (internal_surface->format->BytesPerPixel != 4) {
+    // Exotic format: check each pixel with the general function.
     for (int j = 0; j < width; ++j) {
-      if (mask == 0x00000000) {
-        // Time for a new sequence of 32 bits.
-        k++;
-        mask = 0x80000000;
-        bits[i][k] = 0x00000000;  // Initialize the sequence to transparent.
+      if (!surface.is_pixel_transparent(pixel_index + j)) {
+        row[j >> 6] |= uint64_t(1) << (j & 63);
       }
+    }
+    return;
+  }
 
-      // If the pixel is opaque.
-      if (!surface.is_pixel_transparent(pixel_index)) {
-        bits[i][k] |= mask;
-      }
+  // 32-bit pixels: same tests as Surface::is_pixel_transparent(),
+  // but the format is only read once.
+  const uint32_t* pixels = static_cast<const uint32_t*>(internal_surface->pixels) + pixel_index;
+  uint32_t colorkey = 0;
+  const bool with_colorkey = SDL_GetColorKey(internal_surface, &colorkey) == 0;
+  const uint32_t alpha_mask = internal_surface->format->Amask;
+
+  int j = 0;
+#ifdef SOLARUS_PIXEL_BITS_SSE2
+  // Four pixels at a time. They never cross a 64-bit word.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i colorkey_4 = _mm_set1_epi32(static_cast<int>(colorkey));
+  const __m128i alpha_mask_4 = _mm_set1_epi32(static_cast<int>(alpha_mask));
+  for (; j + 4 <= width; j += 4) {
+    const __m128i pixels_4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + j));
+    __m128i transparent = zero;
+    if (with_colorkey) {
+      transparent = _mm_cmpeq_epi32(pixels_4, colorkey_4);
+    }
+    if (alpha_mask != 0) {
+      transparent = _mm_or_si128(transparent,
+          _mm_cmpeq_epi32(_mm_and_si128(pixels_4, alpha_mask_4), zero));
+    }
+    const uint64_t opaque = ~_mm_movemask_ps(_mm_castsi128_ps(transparent)) & 0xF;
+    row[j >> 6] |= opaque << (j & 63);
+  }
+#endif
+
+  for (; j < width; ++j) {
+    const uint32_t pixel = pixels[j];
+    const bool transparent = (with_colorkey && pixel == colorkey) ||
+        (alpha_mask != 0 && (pixel & alpha_mask) == 0);
+    if (!transparent) {
+      row[j >> 6] |= uint64_t(1) << (j & 63);
+    }
+  }
+}
+
+/**
+ * \brief Computes the smallest rectangle containing all non-transparent
+ * pixels.
+ */
+void PixelBits::compute_opaque_box() {
 
-      mask >>= 1;
-      ++pixel_index;
+  int min_x = width;
+  int max_x = -1;
+  int min_y = height;
+  int max_y = -1;
+  for (int i = 0; i < height; ++i) {
+    const uint64_t* row = get_row(i);
+    for (int k = 0; k < nb_words_per_row; ++k) {
+      const uint64_t word = row[k];
+      if (word == 0) {
+        continue;
+      }
+      min_y = std::min(min_y, i);
+      max_y = i;
+      int low = 0;
+      while (((word >> low) & 1) == 0) {
+        ++low;
+      }
+      int high = 63;
+      while (((word >> high) & 1) == 0) {
+        --high;
+      }
+      min_x = std::min(min_x, k * 64 + low);
+      max_x = std::max(max_x, k * 64 + high);
     }
-    pixel_index += surface.get_width() - width;
   }
+
+  if (max_y == -1) {
+    // Fully transparent.
+    opaque_box = Rectangle();
+    return;
+  }
+  opaque_box = Rectangle(min_x, min_y, max_x - min_x + 1, max_y - min_y + 1);
+}
+
+/**
+ * \brief Returns the bits of a row.
+ * \param y Index of the row.
+ * \return The first word of this row.
+ */
+const uint64_t* PixelBits::get_row(int y) const {
+  return &bits[y * nb_words_per_row];
 }
 
 /**
@@ -103,131 +274,95 @@ bool PixelBits::test_collision(
 ) const {
   const bool debug_pixel_collisions = false;
 
-  if (bits.empty()) {
-    // No image.
+  if (opaque_box.is_flat() || other.opaque_box.is_flat()) {
+    // No visible pixel.
     return false;
   }
 
-  // Compute both bounding boxes.
-  const Rectangle bounding_box1(location1.x, location1.y, width, height);
-  const Rectangle bounding_box2(location2.x, location2.y, other.width, other.height);
+  // Only the boxes of non-transparent pixels can collide.
+  // Outside them, rows and columns are empty.
+  const Rectangle bounding_box1(location1 + opaque_box.get_xy(), opaque_box.get_size());
+  const Rectangle bounding_box2(location2 + other.opaque_box.get_xy(), other.opaque_box.get_size());
 
-  // Check collision between the two bounding boxes.
   if (!bounding_box1.overlaps(bounding_box2)) {
     return false;
   }
 
+  const Rectangle intersection = bounding_box1.get_intersection(bounding_box2);
+
   if (debug_pixel_collisions) {
     std::cout << System::now() << "\n bounding box collision\n";
     std::cout << "rect1 = " << bounding_box1 << "\n";
     std::cout << "rect2 = " << bounding_box2 << "\n";
+    std::cout << "intersection: " << intersection << "\n";
     print();
     other.print();
   }
 
-  // Compute the intersection between both rectangles.
-  const int intersection_x = std::max(bounding_box1.get_x(), bounding_box2.get_x());
-  const int intersection_y = std::max(bounding_box1.get_y(), bounding_box2.get_y());
-  const Rectangle intersection(
-      intersection_x,
-      intersection_y,
-      std::min(bounding_box1.get_x() + bounding_box1.get_width(),
-          bounding_box2.get_x() + bounding_box2.get_width()) - intersection_x,
-      std::min(bounding_box1.get_y() + bounding_box1.get_height(),
-          bounding_box2.get_y() + bounding_box2.get_height()) - intersection_y);
-
-  if (debug_pixel_collisions) {
-    std::cout << "intersection: " << intersection << "\n";
-  }
-
-  // compute the relative position of the intersection rectangle for each bounding_box
-  Point offset1 = intersection.get_xy() - bounding_box1.get_xy();
-  Point offset2 = intersection.get_xy() - bounding_box2.get_xy();
-
-  if (debug_pixel_collisions) {
-    std::cout << "offset1.x = " << offset1.x << ", offset1.y = " << offset1.y;
-    std::cout << ", offset2.x = " << offset2.x << ", offset2.y = " << offset2.y << std::endl;
-  }
-
-  // For each row of the intersection, we will call row 'a' the row coming from the right bounding box
-  // and row 'b' the one coming from the left bounding box.
-
-  std::vector<std::vector<uint32_t>>::const_iterator rows_a;           // for each row: array of masks of the right bounding box
-  std::vector<std::vector<uint32_t>>::const_iterator rows_b;           // for each row: array of masks of the left bounding box
-
-  int nb_masks_per_row_a;    // number of masks on row a that are in the intersection (row b may have one more mask)
-  int nb_masks_per_row_b;    // number of masks on row b that are in the intersection
-  int nb_unused_masks_row_b; // number of unused masks on row b (i.e. before the intersection)
-  int nb_unused_bits_row_b;  // number of unused bits on the first used mask of row b
-  int nb_used_bits_row_b;    // number of bits used on the first used mask of row b
-
-  // make sure row a starts after row b
-  if (bounding_box1.get_x() > bounding_box2.get_x()) {
-    rows_a = this->bits.begin() + offset1.y;
-    rows_b = other.bits.begin() + offset2.y;
-    nb_unused_masks_row_b = offset2.x >> 5;
-    nb_unused_bits_row_b = offset2.x & 31;
-  }
-  else {
-    rows_a = other.bits.begin() + offset2.y;
-    rows_b = this->bits.begin() + offset1.y;
-    nb_unused_masks_row_b = offset1.x >> 5;
-    nb_unused_bits_row_b = offset1.x & 31;
-  }
-  nb_used_bits_row_b = 32 - nb_unused_bits_row_b;
-
-  // compute the number of masks in the intersection on row a
-  nb_masks_per_row_a = intersection.get_width() >> 5;
-  if ((intersection.get_width() & 31) != 0) {
-    nb_masks_per_row_a++;
-  }
-
-  // compute the number of masks in the intersection on row b
-  nb_masks_per_row_b = (intersection.get_width() + nb_unused_bits_row_b) >> 5;
-  if (((intersection.get_width() + nb_unused_bits_row_b) & 31) != 0) {
-    nb_masks_per_row_b++;
-  }
-
-  // check the collisions each row of the intersection rectangle
-  for (int i = 0; i < intersection.get_height(); ++i) {
-
-    // current row
-    const std::vector<uint32_t>& bits_a = *rows_a;
-    const std::vector<uint32_t>& bits_b = *rows_b;
-
-    ++rows_a;
-    ++rows_b;
-
-    if (debug_pixel_collisions) {
-      std::cout << "*** checking row " << i << " of the intersection rectangle\n";
-    }
-
-    // Check each mask.
-    for (int j = 0; j < nb_masks_per_row_a; ++j) {
-
-      // We compare the left of a with the right part of b,
-      // and the right part of a with the right part of the next b if any.
-
-      uint32_t mask_a = bits_a[j];
-      uint32_t mask_b = bits_b[j + nb_unused_masks_row_b];
-      uint32_t mask_a_left = mask_a >> nb_unused_bits_row_b;
-      uint32_t next_mask_b_left = 0x00000000;
-      if (j + 1 < nb_masks_per_row_a ||            // Not the last a-mask.
-          nb_masks_per_row_b > nb_masks_per_row_a  // Last a-mask but there exists one more b-mask.
-          ) {
-        // We are still inside the intersection: next_mask_b_left exists.
-        next_mask_b_left = bits_b[j + nb_unused_masks_row_b + 1] >> nb_used_bits_row_b;
+  // Position of the intersection in each image.
+  const Point offset1 = intersection.get_xy() - location1;
+  const Point offset2 = intersection.get_xy() - location2;
+
+  const int nb_rows = intersection.get_height();
+  const int nb_words = (intersection.get_width() + 63) >> 6;
+  const uint64_t* rows1 = this->get_row(offset1.y);
+  const uint64_t* rows2 = other.get_row(offset2.y);
+  const int stride1 = this->nb_words_per_row;
+  const int stride2 = other.nb_words_per_row;
+
+  // Compare 64 columns at a time.
+  // Bits past the intersection are transparent in at least one image.
+  for (int k = 0; k < nb_words; ++k) {
+
+    const int first_bit1 = offset1.x + k * 64;
+    const int first_bit2 = offset2.x + k * 64;
+    const int word1 = first_bit1 >> 6;
+    const int word2 = first_bit2 >> 6;
+    const int shift1 = first_bit1 & 63;
+    const int shift2 = first_bit2 & 63;
+    int i = 0;
+
+#ifdef SOLARUS_PIXEL_BITS_AVX2
+    {
+      const __m128i shift1_v = _mm_cvtsi32_si128(shift1);
+      const __m128i inverse_shift1_v = _mm_cvtsi32_si128(64 - shift1);
+      const __m128i shift2_v = _mm_cvtsi32_si128(shift2);
+      const __m128i inverse_shift2_v = _mm_cvtsi32_si128(64 - shift2);
+      for (; i + 4 <= nb_rows; i += 4) {
+        const __m256i bits1 = get_bits_avx2(
+            rows1 + i * stride1, stride1, word1, shift1_v, inverse_shift1_v);
+        const __m256i bits2 = get_bits_avx2(
+            rows2 + i * stride2, stride2, word2, shift2_v, inverse_shift2_v);
+        if (!_mm256_testz_si256(bits1, bits2)) {
+          return true;
+        }
       }
-
-      if (debug_pixel_collisions) {
-        std::cout << "mask_a = ";
-        print_mask(mask_a);
-        std::cout << ", mask b = ";
-        print_mask(mask_b);
-        std::cout << "\n";
+    }
+#endif
+
+#ifdef SOLARUS_PIXEL_BITS_SSE2
+    {
+      const __m128i shift1_v = _mm_cvtsi32_si128(shift1);
+      const __m128i inverse_shift1_v = _mm_cvtsi32_si128(64 - shift1);
+      const __m128i shift2_v = _mm_cvtsi32_si128(shift2);
+      const __m128i inverse_shift2_v = _mm_cvtsi32_si128(64 - shift2);
+      const __m128i zero = _mm_setzero_si128();
+      for (; i + 2 <= nb_rows; i += 2) {
+        const __m128i bits1 = get_bits_sse2(
+            rows1 + i * stride1, rows1 + (i + 1) * stride1, word1, shift1_v, inverse_shift1_v);
+        const __m128i bits2 = get_bits_sse2(
+            rows2 + i * stride2, rows2 + (i + 1) * stride2, word2, shift2_v, inverse_shift2_v);
+        const __m128i common = _mm_and_si128(bits1, bits2);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(common, zero)) != 0xFFFF) {
+          return true;
+        }
       }
+    }
+#endif
 
-      if (((mask_a_left & mask_b) | (mask_a & next_mask_b_left)) != 0x00000000) {
+    for (; i < nb_rows; ++i) {
+      if ((get_bits(rows1 + i * stride1, first_bit1) &
+          get_bits(rows2 + i * stride2, first_bit2)) != 0) {
         return true;
       }
     }
@@ -243,38 +378,19 @@ void PixelBits::print() const {
 
   std::cout << "frame size is " << width << " x " << height << std::endl;
   for (int i = 0; i < height; i++) {
-    int k = -1;
-    uint32_t mask = 0x00000000;
+    const uint64_t* row = get_row(i);
     for (int j = 0; j < width; j++) {
 
-      if (mask == 0x00000000) {
-        k++;
-        mask = 0x80000000;
-      }
-
-      if (bits[i][k] & mask) {
+      if (((row[j >> 6] >> (j & 63)) & 1) != 0) {
         std::cout << "X";
       }
       else {
         std::cout << ".";
       }
-
-      mask >>= 1;
     }
     std::cout << std::endl;
   }
 }
 
-/**
- * \brief Prints an ASCII representation of a 32-bit mask (for debugging purposes only).
- */
-void PixelBits::print_mask(uint32_t mask) const {
-
-  for (int i = 0; i < 32; i++) {
-    std::cout << (((mask & 0x80000000) != 0x00000000) ? "X" : ".");
-    mask <<= 1;
-  }
-}
-
 }
 
@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Profiler.h"
+#include "solarus/Arguments.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#if defined(SOLARUS_OSX) || defined(SOLARUS_IOS)
+#  define thread_local
+#endif
+
+namespace Solarus {
+
+namespace Profiler {
+
+namespace {
+
+bool enabled = false;                /**< Whether zones are measured. */
+std::vector<ZoneStats> zone_stats;   /**< Accumulated time of each zone,
+                                      * in order of first entrance. */
+std::unique_ptr<std::ofstream>
+    trace_file;                      /**< Where trace events are written if tracing. */
+uint64_t trace_start_time = 0;       /**< Date when tracing started. */
+bool first_trace_event = true;       /**< Whether no event was written yet. */
+std::mutex mutex;                    /**< Protects statistics and the trace file
+                                      * from zones measured in other threads. */
+int num_threads = 0;                 /**< Number of threads that wrote trace events. */
+
+/**
+ * \brief Returns an identifier of the current thread for trace events.
+ *
+ * Must be called with the mutex locked.
+ * Where thread_local is unavailable, all threads share the same number.
+ *
+ * \return The thread number, starting at 1 for the first thread.
+ */
+int get_thread_id() {
+
+  static thread_local int thread_id = 0;
+  if (thread_id == 0) {
+    thread_id = ++num_threads;
+  }
+  return thread_id;
+}
+
+/**
+ * \brief Writes a complete event to the trace file.
+ * \param name Name of the zone.
+ * \param start_time Date when the zone was entered in microseconds.
+ * \param duration Time spent in the zone in microseconds.
+ */
+void write_trace_event(const char* name, uint64_t start_time, uint64_t duration) {
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (trace_file == nullptr) {
+    return;
+  }
+  std::ofstream& out = *trace_file;
+  if (!first_trace_event) {
+    out << ",\n";
+  }
+  first_trace_event = false;
+  out << "{\"name\":\"" << name
+      << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << get_thread_id()
+      << ",\"ts\":" << (start_time - trace_start_time)
+      << ",\"dur\":" << duration << "}";
+}
+
+}
+
+/**
+ * \brief Initializes the profiler.
+ *
+ * Options recognized:
+ *   -trace-file=<path>
+ *
+ * \param args Command-line arguments.
+ */
+void initialize(const Arguments& args) {
+
+  const std::string& trace_file_name = args.get_argument_value("-trace-file");
+  if (!trace_file_name.empty()) {
+    start_trace(trace_file_name);
+  }
+}
+
+/**
+ * \brief Stops the profiler and finishes writing the trace file if any.
+ */
+void quit() {
+
+  stop_trace();
+  enabled = false;
+  zone_stats.clear();
+}
+
+/**
+ * \brief Starts measuring a zone if the profiler is enabled.
+ * \param name Name of the zone. Must be a string literal or at least
+ * outlive the zone.
+ */
+Zone::Zone(const char* name):
+    name(name),
+    active(is_enabled()),
+    start_time(active ? get_time() : 0) {
+
+}
+
+/**
+ * \brief Stops measuring the zone and accumulates the time spent.
+ */
+Zone::~Zone() {
+
+  if (active) {
+    const uint64_t duration = get_time() - start_time;
+    add_zone_time(name, duration);
+    if (trace_file != nullptr) {
+      write_trace_event(name, start_time, duration);
+    }
+  }
+}
+
+/**
+ * \brief Returns whether the profiler is measuring zones.
+ * \return \c true if the profiler is enabled or tracing.
+ */
+bool is_enabled() {
+  return enabled || is_tracing();
+}
+
+/**
+ * \brief Enables or disables the profiler.
+ *
+ * Tracing is independent: zones are always measured while tracing.
+ *
+ * \param enabled \c true to start measuring zones.
+ */
+void set_enabled(bool enabled) {
+  Profiler::enabled = enabled;
+}
+
+/**
+ * \brief Returns the current date of a monotonic high-resolution clock.
+ * \return The date in microseconds. Only differences between two dates
+ * are meaningful.
+ */
+uint64_t get_time() {
+
+  using namespace std::chrono;
+  return duration_cast<microseconds>(
+      steady_clock::now().time_since_epoch()
+  ).count();
+}
+
+/**
+ * \brief Adds some time to the statistics of a zone.
+ * \param name Name of the zone.
+ * \param duration Time spent in the zone in microseconds.
+ */
+void add_zone_time(const char* name, uint64_t duration) {
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // There are only a few zones: a linear search is fine.
+  for (ZoneStats& stats: zone_stats) {
+    if (std::strcmp(stats.name.c_str(), name) == 0) {
+      stats.total_time += duration;
+      ++stats.num_calls;
+      return;
+    }
+  }
+
+  zone_stats.push_back({ name, duration, 1 });
+}
+
+/**
+ * \brief Returns the time accumulated in each zone since the last reset.
+ * \return The statistics of each zone entered at least once.
+ */
+const std::vector<ZoneStats>& get_zone_stats() {
+  return zone_stats;
+}
+
+/**
+ * \brief Clears the accumulated time of all zones.
+ */
+void reset_zone_stats() {
+
+  for (ZoneStats& stats: zone_stats) {
+    stats.total_time = 0;
+    stats.num_calls = 0;
+  }
+}
+
+/**
+ * \brief Returns whether zones are currently written to a trace file.
+ * \return \c true if tracing.
+ */
+bool is_tracing() {
+  return trace_file != nullptr;
+}
+
+/**
+ * \brief Starts writing zones to a trace file.
+ *
+ * The file uses the Chrome trace event format.
+ * If a trace was already being written, it is finished first.
+ *
+ * \param file_name Path of the file to write.
+ */
+void start_trace(const std::string& file_name) {
+
+  stop_trace();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  trace_file = std::unique_ptr<std::ofstream>(new std::ofstream(file_name));
+  if (!trace_file->good()) {
+    Debug::error("Cannot open trace file '" + file_name + "'");
+    trace_file = nullptr;
+    return;
+  }
+
+  *trace_file << "{\"traceEvents\":[\n";
+  trace_start_time = get_time();
+  first_trace_event = true;
+}
+
+/**
+ * \brief Finishes writing the trace file if any.
+ */
+void stop_trace() {
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (trace_file == nullptr) {
+    return;
+  }
+
+  *trace_file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  trace_file = nullptr;
+}
+
+}
+
+}
@@ -25,11 +25,20 @@
 namespace Solarus {
 namespace Random {
 
+namespace {
+
+uint32_t seed = 0;                 /**< Seed of the random number generators. */
+unsigned int seed_generation = 0;  /**< Incremented each time the seed changes. */
+
+}
+
 /**
  * \brief Initializes the random number generator.
+ *
+ * The seed is initialized from the current time.
  */
 void initialize() {
-  // nothing to do
+  set_seed(static_cast<uint32_t>(std::time(nullptr)));
 }
 
 /**
@@ -39,6 +48,28 @@ void quit() {
   // nothing to do
 }
 
+/**
+ * \brief Returns the seed currently used to generate random numbers.
+ * \return The seed.
+ */
+uint32_t get_seed() {
+  return seed;
+}
+
+/**
+ * \brief Restarts the sequence of random numbers from a seed.
+ *
+ * Setting the same seed again produces the same sequence of numbers,
+ * which is useful to make a simulation reproducible.
+ *
+ * \param seed The seed to use.
+ */
+void set_seed(uint32_t seed) {
+
+  Random::seed = seed;
+  ++seed_generation;
+}
+
 /**
  * \brief Returns a random integer number in [0, x[ with a uniform distribution.
  *
@@ -75,9 +106,17 @@ int get_number(int x, int y) {
   // thread, initialized once, like a static variable) rather
   // than maintaining them in the body of a class.
   //
-  thread_local std::mt19937 engine(std::time(nullptr));
+  thread_local std::mt19937 engine(seed);
+  thread_local unsigned int engine_seed_generation = seed_generation;
   thread_local std::uniform_int_distribution<int> dist{};
 
+  // Restart the sequence if the seed has changed.
+  if (engine_seed_generation != seed_generation) {
+    engine.seed(seed);
+    dist.reset();
+    engine_seed_generation = seed_generation;
+  }
+
   // Type of the parameters of the distribution
   using param_type = std::uniform_int_distribution<int>::param_type;
 
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Color.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/MemoryStats.h"
+#include "solarus/lowlevel/RenderCommandList.h"
+#include "solarus/lowlevel/Video.h"
+#include <SDL.h>
+#include <algorithm>
+#include <string>
+
+namespace Solarus {
+
+/**
+ * \brief Creates a texture handle with no SDL texture yet.
+ */
+RenderTexture::RenderTexture():
+  texture(nullptr),
+  memory_size(0) {
+
+}
+
+/**
+ * \brief Destroys the SDL texture if any.
+ *
+ * The destruction is delegated to the video system because it has to
+ * happen on the thread that owns the renderer.
+ */
+RenderTexture::~RenderTexture() {
+
+  if (texture != nullptr) {
+    Video::destroy_texture(texture);
+    MemoryStats::remove(MemoryCategory::TEXTURES, memory_size);
+  }
+}
+
+/**
+ * \brief Returns the SDL texture.
+ *
+ * This should only be called when executing render commands.
+ *
+ * \return The SDL texture, or nullptr if it is not created yet.
+ */
+SDL_Texture* RenderTexture::get_texture() const {
+  return texture;
+}
+
+/**
+ * \brief Sets the SDL texture.
+ *
+ * This should only be called when executing render commands.
+ *
+ * \param texture The SDL texture. This object takes ownership of it.
+ * \param memory_size Estimated size of the texture in bytes.
+ */
+void RenderTexture::set_texture(SDL_Texture* texture, int64_t memory_size) {
+
+  this->texture = texture;
+  this->memory_size = memory_size;
+  MemoryStats::add(MemoryCategory::TEXTURES, memory_size);
+}
+
+/**
+ * \brief Creates an empty command list.
+ * \param deferred \c true if the list will be executed after the
+ * surfaces recorded may have changed, typically by another thread.
+ * In this case, pixels to upload are copied.
+ */
+RenderCommandList::RenderCommandList(bool deferred):
+  deferred(deferred),
+  commands(),
+  texture_updates() {
+
+}
+
+/**
+ * \brief Returns whether pixels are copied when recorded.
+ * \return \c true if this list can be executed later.
+ */
+bool RenderCommandList::is_deferred() const {
+  return deferred;
+}
+
+/**
+ * \brief Returns whether no command was recorded.
+ * \return \c true if the list is empty.
+ */
+bool RenderCommandList::is_empty() const {
+  return commands.empty();
+}
+
+/**
+ * \brief Records the upload of the pixels of a software surface to a texture.
+ *
+ * The texture is created at execution time if it does not exist yet.
+ * The surface must already have the pixel format of the renderer.
+ *
+ * \param texture The texture to create or update.
+ * \param surface The pixels to upload.
+ */
+void RenderCommandList::add_texture_update(
+    const RenderTexturePtr& texture,
+    SDL_Surface& surface) {
+
+  TextureUpdate update;
+  update.width = surface.w;
+  update.height = surface.h;
+  update.pitch = surface.pitch;
+  if (deferred) {
+    update.surface = nullptr;
+    const uint8_t* pixels = static_cast<const uint8_t*>(surface.pixels);
+    update.pixels.assign(pixels, pixels + surface.pitch * surface.h);
+  }
+  else {
+    update.surface = &surface;
+  }
+  texture_updates.push_back(std::move(update));
+
+  Command command;
+  command.type = CommandType::UPDATE_TEXTURE;
+  command.texture = texture;
+  command.update_index = texture_updates.size() - 1;
+  command.r = command.g = command.b = command.a = 0;
+  commands.push_back(std::move(command));
+}
+
+/**
+ * \brief Records filling a rectangle with a color.
+ * \param color The color to fill with.
+ * \param opacity Maximum alpha value to use.
+ * \param rect The rectangle to fill, in renderer coordinates.
+ */
+void RenderCommandList::add_fill_rect(
+    const Color& color,
+    uint8_t opacity,
+    const Rectangle& rect) {
+
+  Command command;
+  command.type = CommandType::FILL_RECT;
+  command.update_index = 0;
+  command.dst_rect = rect;
+  color.get_components(command.r, command.g, command.b, command.a);
+  command.a = std::min(command.a, opacity);
+  commands.push_back(std::move(command));
+}
+
+/**
+ * \brief Records drawing a region of a texture.
+ * \param texture The texture to draw.
+ * \param opacity Alpha modulation to apply.
+ * \param src_rect The region of the texture to draw.
+ * \param dst_rect Where to draw it, in renderer coordinates.
+ */
+void RenderCommandList::add_copy(
+    const RenderTexturePtr& texture,
+    uint8_t opacity,
+    const Rectangle& src_rect,
+    const Rectangle& dst_rect) {
+
+  Command command;
+  command.type = CommandType::COPY;
+  command.texture = texture;
+  command.update_index = 0;
+  command.src_rect = src_rect;
+  command.dst_rect = dst_rect;
+  command.r = command.g = command.b = 0;
+  command.a = opacity;
+  commands.push_back(std::move(command));
+}
+
+/**
+ * \brief Executes the commands on a renderer.
+ *
+ * This must be called on the thread that owns the renderer.
+ *
+ * \param renderer The renderer to draw on.
+ */
+void RenderCommandList::execute(SDL_Renderer* renderer) const {
+
+  for (const Command& command: commands) {
+
+    switch (command.type) {
+
+    case CommandType::UPDATE_TEXTURE:
+      update_texture(renderer, command);
+      break;
+
+    case CommandType::FILL_RECT:
+      SDL_SetRenderDrawColor(renderer, command.r, command.g, command.b, command.a);
+      SDL_RenderFillRect(renderer, command.dst_rect.get_internal_rect());
+      break;
+
+    case CommandType::COPY:
+    {
+      SDL_Texture* texture = command.texture->get_texture();
+      if (texture == nullptr) {
+        break;
+      }
+      SDL_SetTextureAlphaMod(texture, command.a);
+      SDL_RenderCopy(
+          renderer,
+          texture,
+          command.src_rect.get_internal_rect(),
+          command.dst_rect.get_internal_rect()
+      );
+      break;
+    }
+    }
+  }
+}
+
+/**
+ * \brief Clears the renderer, executes the commands and shows the result.
+ *
+ * This must be called on the thread that owns the renderer.
+ * It may block until the next vertical synchronization.
+ *
+ * \param renderer The renderer to draw on.
+ */
+void RenderCommandList::present(SDL_Renderer* renderer) const {
+
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+  SDL_RenderSetClipRect(renderer, nullptr);
+  SDL_RenderClear(renderer);
+  execute(renderer);
+  SDL_RenderPresent(renderer);
+}
+
+/**
+ * \brief Executes an UPDATE_TEXTURE command.
+ * \param renderer The renderer that owns the texture.
+ * \param command The command to execute.
+ */
+void RenderCommandList::update_texture(
+    SDL_Renderer* renderer,
+    const Command& command) const {
+
+  const TextureUpdate& update = texture_updates[command.update_index];
+  RenderTexture& texture = *command.texture;
+
+  if (texture.get_texture() == nullptr) {
+    SDL_Texture* sdl_texture = SDL_CreateTexture(
+        renderer,
+        Video::get_pixel_format()->format,
+        SDL_TEXTUREACCESS_STATIC,
+        update.width,
+        update.height
+    );
+    if (sdl_texture == nullptr) {
+      Debug::error(std::string("Cannot create texture: ") + SDL_GetError());
+      return;
+    }
+    SDL_SetTextureBlendMode(sdl_texture, SDL_BLENDMODE_BLEND);
+    texture.set_texture(sdl_texture, static_cast<int64_t>(update.pitch) * update.height);
+  }
+
+  const void* pixels = update.surface != nullptr ?
+      update.surface->pixels : update.pixels.data();
+  SDL_UpdateTexture(texture.get_texture(), nullptr, pixels, update.pitch);
+}
+
+}
+
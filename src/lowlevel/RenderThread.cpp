@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Profiler.h"
+#include "solarus/lowlevel/RenderCommandList.h"
+#include "solarus/lowlevel/RenderThread.h"
+#include <SDL.h>
+
+namespace Solarus {
+
+/**
+ * \brief Starts the render thread.
+ * \param window The window rendered to.
+ * \param renderer The renderer to hand to the render thread.
+ * It must not be used directly by the caller anymore.
+ */
+RenderThread::RenderThread(SDL_Window* window, SDL_Renderer* renderer):
+  window(window),
+  renderer(renderer),
+  mutex(),
+  condition(),
+  pending_frame(nullptr),
+  pending_task(nullptr),
+  textures_to_destroy(),
+  busy(false),
+  stopping(false),
+  thread() {
+
+#if SOLARUS_HAVE_OPENGL == 1
+  // An OpenGL context can only be current in one thread at a time.
+  // The renderer makes it current again in the render thread when needed.
+  SDL_GL_MakeCurrent(window, nullptr);
+#endif
+
+  thread = std::thread(&RenderThread::run, this);
+}
+
+/**
+ * \brief Presents the last frame submitted if any and stops the thread.
+ *
+ * When this function returns, the renderer can be used again by the caller.
+ */
+RenderThread::~RenderThread() {
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  condition.notify_all();
+  thread.join();
+}
+
+/**
+ * \brief Submits a frame to be presented.
+ *
+ * Blocks while the previous frame submitted was not picked by the render
+ * thread yet.
+ *
+ * \param frame The recorded frame. It must be a deferred command list.
+ */
+void RenderThread::submit_frame(std::unique_ptr<RenderCommandList> frame) {
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this]() {
+      return pending_frame == nullptr;
+    });
+    pending_frame = std::move(frame);
+  }
+  condition.notify_all();
+}
+
+/**
+ * \brief Runs a function on the render thread and waits for it to finish.
+ *
+ * Use this for operations that touch the renderer, like changing its
+ * logical size.
+ *
+ * \param task The function to run.
+ */
+void RenderThread::run_sync(const std::function<void()>& task) {
+
+  std::unique_lock<std::mutex> lock(mutex);
+  pending_task = task;
+  condition.notify_all();
+  condition.wait(lock, [this]() {
+    return pending_task == nullptr && !busy;
+  });
+}
+
+/**
+ * \brief Waits until all submitted frames are presented.
+ */
+void RenderThread::wait_idle() {
+
+  std::unique_lock<std::mutex> lock(mutex);
+  condition.wait(lock, [this]() {
+    return pending_frame == nullptr && pending_task == nullptr && !busy;
+  });
+}
+
+/**
+ * \brief Destroys a texture on the render thread.
+ *
+ * If called from another thread, the destruction is delayed until the
+ * render thread wakes up.
+ *
+ * \param texture The texture to destroy.
+ */
+void RenderThread::destroy_texture(SDL_Texture* texture) {
+
+  if (std::this_thread::get_id() == thread.get_id()) {
+    SDL_DestroyTexture(texture);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    textures_to_destroy.push_back(texture);
+  }
+  condition.notify_all();
+}
+
+/**
+ * \brief Body of the render thread.
+ */
+void RenderThread::run() {
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+
+    condition.wait(lock, [this]() {
+      return stopping
+          || pending_frame != nullptr
+          || pending_task != nullptr
+          || !textures_to_destroy.empty();
+    });
+
+    if (stopping
+        && pending_frame == nullptr
+        && pending_task == nullptr
+        && textures_to_destroy.empty()) {
+      break;
+    }
+
+    // Take the work and release the lock so that the simulation can
+    // already record and submit the next frame.
+    std::unique_ptr<RenderCommandList> frame = std::move(pending_frame);
+    pending_frame = nullptr;
+    std::function<void()> task = std::move(pending_task);
+    pending_task = nullptr;
+    std::vector<SDL_Texture*> textures;
+    textures.swap(textures_to_destroy);
+    busy = true;
+    lock.unlock();
+    condition.notify_all();
+
+    for (SDL_Texture* texture: textures) {
+      SDL_DestroyTexture(texture);
+    }
+
+    if (task != nullptr) {
+      task();
+    }
+
+    if (frame != nullptr) {
+      Profiler::Zone zone("RenderThread::present");
+      frame->present(renderer);
+      frame = nullptr;  // Destroys textures no longer used by any surface.
+    }
+
+    lock.lock();
+    busy = false;
+    condition.notify_all();
+  }
+
+#if SOLARUS_HAVE_OPENGL == 1
+  // Give the OpenGL context back.
+  SDL_GL_MakeCurrent(window, nullptr);
+#endif
+}
+
+}
+
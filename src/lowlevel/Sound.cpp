@@ -18,6 +18,7 @@
 #include <cstring>  // memcpy
 #include <sstream>
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/MemoryStats.h"
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lowlevel/Music.h"
 #include "solarus/lowlevel/Sound.h"
@@ -72,6 +73,7 @@ Sound::~Sound() {
       alSourcei(source, AL_BUFFER, 0);
       alDeleteSources(1, &source);
     }
+    MemoryStats::remove(MemoryCategory::SOUNDS, get_buffer_size());
     alDeleteBuffers(1, &buffer);
     current_sounds.remove(this);
   }
@@ -289,6 +291,22 @@ void Sound::load() {
   buffer = decode_file(file_name);
 
   // buffer is now AL_NONE if there was an error.
+  MemoryStats::add(MemoryCategory::SOUNDS, get_buffer_size());
+}
+
+/**
+ * \brief Returns the size of the decoded sound.
+ * \return The size of the OpenAL buffer in bytes, or 0 if it is not loaded.
+ */
+int64_t Sound::get_buffer_size() const {
+
+  if (buffer == AL_NONE) {
+    return 0;
+  }
+
+  ALint size = 0;
+  alGetBufferi(buffer, AL_SIZE, &size);
+  return size;
 }
 
 /**
@@ -135,6 +135,7 @@ Surface::Surface(SDL_Surface* internal_surface):
 
   width = internal_surface->w;
   height = internal_surface->h;
+  MemoryStats::add(MemoryCategory::SURFACES, get_memory_size(internal_surface));
 }
 
 /**
@@ -249,20 +250,23 @@ void Surface::convert_software_surface() {
     Debug::check_assertion(converted_surface != nullptr,
         "Failed to convert software surface");
 
+    MemoryStats::add(MemoryCategory::SURFACES, get_memory_size(converted_surface));
     internal_surface = SDL_Surface_UniquePtr(converted_surface);
     SDL_SetSurfaceAlphaMod(internal_surface.get(), opacity);  // Re-apply the alpha.
   }
 }
 
 /**
- * \brief Creates a hardware texture from the software surface.
+ * \brief Records the upload of the software surface to the hardware texture.
  *
+ * Creates the texture first if necessary.
  * Also converts the software surface to a preferred format if necessary.
+ *
+ * \param commands The command list where to record the upload.
  */
-void Surface::create_texture_from_surface() {
+void Surface::update_texture(RenderCommandList& commands) {
 
-  SDL_Renderer* main_renderer = Video::get_renderer();
-  if (main_renderer != nullptr) {
+  if (Video::get_renderer() != nullptr) {
 
     Debug::check_assertion(internal_surface != nullptr,
         "Missing software surface to create texture from");
@@ -272,20 +276,12 @@ void Surface::create_texture_from_surface() {
     // for performance reasons.
     convert_software_surface();
 
-    // Create the texture.
-    internal_texture = SDL_Texture_UniquePtr(
-        SDL_CreateTexture(
-            main_renderer,
-            Video::get_pixel_format()->format,
-            SDL_TEXTUREACCESS_STATIC,
-            internal_surface->w,
-            internal_surface->h
-        )
-    );
-    SDL_SetTextureBlendMode(internal_texture.get(), SDL_BLENDMODE_BLEND);
+    if (internal_texture == nullptr) {
+      internal_texture = std::make_shared<RenderTexture>();
+    }
 
     // Copy the pixels of the software surface to the GPU texture.
-    SDL_UpdateTexture(internal_texture.get(), nullptr, internal_surface->pixels, internal_surface->pitch);
+    commands.add_texture_update(internal_texture, *internal_surface);
     SDL_GetSurfaceAlphaMod(internal_surface.get(), &internal_opacity);
   }
 }
@@ -341,6 +337,31 @@ void Surface::set_opacity(uint8_t opacity) {
   }
 }
 
+/**
+ * \brief Returns the number of bytes of pixels of an SDL surface.
+ * \param sdl_surface An SDL surface or nullptr.
+ * \return The size of its pixels in bytes.
+ */
+int64_t Surface::get_memory_size(const SDL_Surface* sdl_surface) {
+
+  if (sdl_surface == nullptr) {
+    return 0;
+  }
+  return static_cast<int64_t>(sdl_surface->pitch) * sdl_surface->h;
+}
+
+/**
+ * \brief Returns the number of bytes needed by the pixels of this surface.
+ *
+ * This is an estimation that does not depend on the current pixel format,
+ * so that it remains the same during the whole life of the surface.
+ *
+ * \return The size of the surface with 32 bits per pixel.
+ */
+int64_t Surface::get_memory_size() const {
+  return static_cast<int64_t>(width) * height * 4;
+}
+
 /**
  * \brief Returns a buffer of the raw pixels of this surface.
  *
@@ -472,6 +493,7 @@ void Surface::create_software_surface() {
 
   Debug::check_assertion(internal_surface != nullptr,
       "Failed to create software surface");
+  MemoryStats::add(MemoryCategory::SURFACES, get_memory_size(internal_surface.get()));
 }
 
 /**
@@ -763,14 +785,30 @@ void Surface::apply_pixel_filter(
  */
 void Surface::render(SDL_Renderer* renderer) {
 
+  RenderCommandList commands(false);
+  render(commands);
+  commands.execute(renderer);
+}
+
+/**
+ * \brief Records the drawing of the internal texture if any, and all
+ * subtextures.
+ *
+ * The commands can then be executed later, possibly on another thread if
+ * the list is deferred.
+ *
+ * \param commands The command list where to record the drawing.
+ */
+void Surface::render(RenderCommandList& commands) {
+
   const Rectangle size(get_size());
-  render(renderer, size, size, size, 255, subsurfaces);
+  render(commands, size, size, size, 255, subsurfaces);
 }
 
 /**
- * \brief Renders the internal texture if any, and all subsurfaces that are
- * drawn onto it.
- * \param renderer The renderer where to draw.
+ * \brief Records the rendering of the internal texture if any, and all
+ * subsurfaces that are drawn onto it.
+ * \param commands The command list where to record the drawing.
  * \param src_rect The subrectangle of the texture to draw.
  * \param dst_rect The position where to draw on the renderer.
  * \param clip_rect A portion of the renderer where to restrict the drawing.
@@ -779,7 +817,7 @@ void Surface::render(SDL_Renderer* renderer) {
  * renderered recursively.
  */
 void Surface::render(
-    SDL_Renderer* renderer,
+    RenderCommandList& commands,
     const Rectangle& src_rect,
     const Rectangle& dst_rect,
     const Rectangle& clip_rect,
@@ -794,22 +832,12 @@ void Surface::render(
   // Accelerate the internal software surface.
   if (internal_surface != nullptr) {
 
-    if (internal_texture == nullptr) {
-      create_texture_from_surface();
-    }
-
-    // If the software surface has changed, update the hardware texture.
-    else if (
-        (software_destination || !Video::is_acceleration_enabled())
-         && !is_rendered) {
-      convert_software_surface();
-      SDL_UpdateTexture(
-          internal_texture.get(),
-          nullptr,
-          internal_surface->pixels,
-          internal_surface->pitch
-      );
-      SDL_GetSurfaceAlphaMod(internal_surface.get(), &internal_opacity);
+    // Create the hardware texture, or update it if the software surface
+    // has changed.
+    if (internal_texture == nullptr
+        || ((software_destination || !Video::is_acceleration_enabled())
+            && !is_rendered)) {
+      update_texture(commands);
     }
   }
 
@@ -817,25 +845,12 @@ void Surface::render(
 
   // Draw the internal color as background color.
   if (internal_color != nullptr) {
-    uint8_t r, g, b, a;
-    internal_color->get_components(r, g, b, a);
-
-    SDL_SetRenderDrawColor(renderer, r, g, b, std::min((uint8_t) a, current_opacity));
-    //SDL_RenderSetClipRect(renderer, clip_rect.get_internal_rect());
-    SDL_RenderFillRect(renderer, clip_rect.get_internal_rect());
+    commands.add_fill_rect(*internal_color, current_opacity, clip_rect);
   }
 
   // Draw the internal texture.
   if (internal_texture != nullptr) {
-    SDL_SetTextureAlphaMod(internal_texture.get(), current_opacity);
-    //SDL_RenderSetClipRect(renderer, clip_rect.get_internal_rect());
-
-    SDL_RenderCopy(
-        renderer,
-        internal_texture.get(),
-        src_rect.get_internal_rect(),
-        dst_rect.get_internal_rect()
-    );
+    commands.add_copy(internal_texture, current_opacity, src_rect, dst_rect);
   }
 
   // The surface is rendered. Now draw all subtextures.
@@ -859,7 +874,7 @@ void Surface::render(
 
       // If there is an intersection, render the subsurface.
       subsurface->src_surface->render(
-          renderer,
+          commands,
           subsurface->src_rect,
           subsurface_dst_rect,
           superimposed_clip_rect,
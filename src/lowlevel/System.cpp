@@ -24,6 +24,7 @@
 #include "solarus/lowlevel/Video.h"
 #include "solarus/Sprite.h"
 #include <SDL.h>
+#include <thread>
 #ifdef SOLARUS_USE_APPLE_POOL
 #  include "lowlevel/apple/AppleInterface.h"
 #endif
@@ -32,6 +33,8 @@ namespace Solarus {
 
 uint32_t System::initial_time = 0;
 uint32_t System::ticks = 0;
+uint64_t System::initial_counter = 0;
+uint64_t System::counter_frequency = 1;
 
 /**
  * \brief Initializes the basic low-level system.
@@ -46,6 +49,8 @@ void System::initialize(const Arguments& args) {
   // initialize SDL
   SDL_Init(SDL_INIT_VIDEO | SDL_INIT_JOYSTICK);
   initial_time = get_real_time();
+  initial_counter = SDL_GetPerformanceCounter();
+  counter_frequency = SDL_GetPerformanceFrequency();
   ticks = 0;
 
   // files
@@ -147,5 +152,47 @@ void System::sleep(uint32_t duration) {
   SDL_Delay(duration);
 }
 
+/**
+ * \brief Returns the number of real microseconds elapsed since the
+ * initialization of the Solarus library.
+ *
+ * Uses the high-resolution counter of the system.
+ * This function is not deterministic, so use it at your own risks.
+ *
+ * \return The number of microseconds elapsed since the initialization.
+ */
+uint64_t System::get_real_time_us() {
+
+  const uint64_t elapsed = SDL_GetPerformanceCounter() - initial_counter;
+  // Split the conversion to avoid overflows with high frequencies.
+  return (elapsed / counter_frequency) * 1000000
+      + (elapsed % counter_frequency) * 1000000 / counter_frequency;
+}
+
+/**
+ * \brief Makes the program wait until a precise date.
+ *
+ * Sleeps while the date is far enough, then actively waits for the
+ * remaining time because the OS scheduling may oversleep.
+ *
+ * \param date The date to wait for, as returned by get_real_time_us().
+ */
+void System::wait_until_us(uint64_t date) {
+
+  // Margin left to the active wait to absorb the scheduling delay.
+  constexpr uint64_t spin_duration = 2000;
+
+  uint64_t now = get_real_time_us();
+  while (now + spin_duration < date) {
+    SDL_Delay(static_cast<uint32_t>((date - now - spin_duration) / 1000) + 1);
+    now = get_real_time_us();
+  }
+
+  while (now < date) {
+    std::this_thread::yield();
+    now = get_real_time_us();
+  }
+}
+
 }
 
@@ -26,8 +26,12 @@
 #include "solarus/lowlevel/Color.h"
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Profiler.h"
+#include "solarus/lowlevel/RenderCommandList.h"
+#include "solarus/lowlevel/RenderThread.h"
 #include "solarus/lowlevel/shaders/ShaderContext.h"
 #include "solarus/Arguments.h"
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -49,6 +53,9 @@ bool rendertarget_supported = false;      /**< True if rendering on texture is s
 bool shaders_enabled = false;             /**< True if shaded modes support is enabled. */
 bool acceleration_enabled = false;        /**< \c true if 2D GPU acceleration is available and enabled. */
 SurfacePtr scaled_surface = nullptr;      /**< The screen surface used with software-scaled modes. */
+bool render_thread_wanted = false;        /**< Whether frames are presented by a separate thread. */
+std::unique_ptr<RenderThread>
+    render_thread = nullptr;              /**< Thread presenting frames, if enabled. */
 
 std::vector<VideoMode> all_video_modes;   /**< Display information for each supported video mode. */
 const VideoMode* video_mode;              /**< Current video mode. */
@@ -64,6 +71,42 @@ Size window_size;                         /**< Size of the window. The quest siz
                                            * letterboxed to fit. In fullscreen, remembers the size
                                            * to use when returning to windowed mode. */
 
+/**
+ * \brief Runs a function that uses the renderer.
+ *
+ * If there is a render thread, the function is run by that thread and
+ * this call blocks until it finishes.
+ *
+ * \param task The function to run.
+ */
+void run_on_renderer(const std::function<void()>& task) {
+
+  if (render_thread != nullptr) {
+    render_thread->run_sync(task);
+  }
+  else {
+    task();
+  }
+}
+
+/**
+ * \brief SDL event filter that waits for the render thread on window events.
+ *
+ * SDL calls the filter before its own event watchers, and the renderer
+ * watches window events to update its viewport.
+ * Other events don't need to synchronize with the render thread.
+ *
+ * \param event The event being pushed.
+ * \return 1 to keep the event.
+ */
+int SDLCALL wait_rendering_on_window_event(void* /* userdata */, SDL_Event* event) {
+
+  if (event->type == SDL_WINDOWEVENT && render_thread != nullptr) {
+    render_thread->wait_idle();
+  }
+  return 1;
+}
+
 /**
  * \brief Creates the window but does not show it.
  * \param args Command-line arguments.
@@ -159,7 +202,10 @@ void create_window() {
 void initialize_video_modes() {
 
   // Decide whether we enable shaders.
-  shaders_enabled = rendertarget_supported && Video::is_acceleration_enabled() && ShaderContext::initialize();
+  // Shaders make OpenGL calls directly, which is not supported with a
+  // render thread.
+  shaders_enabled = !render_thread_wanted
+      && rendertarget_supported && Video::is_acceleration_enabled() && ShaderContext::initialize();
 
   // Initialize hardcoded video modes.
   all_video_modes.emplace_back(
@@ -251,6 +297,7 @@ void initialize_video_modes() {
  *   -no-video
  *   -video-acceleration=yes|no
  *   -quest-size=WIDTHxHEIGHT
+ *   -render-thread
  *
  * \param args Command-line arguments.
  */
@@ -259,6 +306,7 @@ void Video::initialize(const Arguments& args) {
   // Check the -no-video and the -quest-size options.
   const std::string& quest_size_string = args.get_argument_value("-quest-size");
   disable_window = args.has_argument("-no-video");
+  render_thread_wanted = args.has_argument("-render-thread");
 
   wanted_quest_size = {
       SOLARUS_DEFAULT_QUEST_WIDTH,
@@ -286,6 +334,12 @@ void Video::initialize(const Arguments& args) {
   }
   else {
     create_window();
+    if (render_thread_wanted) {
+      render_thread = std::unique_ptr<RenderThread>(
+          new RenderThread(main_window, main_renderer)
+      );
+      SDL_SetEventFilter(wait_rendering_on_window_event, nullptr);
+    }
   }
 }
 
@@ -294,6 +348,12 @@ void Video::initialize(const Arguments& args) {
  */
 void Video::quit() {
 
+  // Give the renderer back to this thread.
+  if (render_thread != nullptr) {
+    SDL_SetEventFilter(nullptr, nullptr);
+    render_thread = nullptr;
+  }
+
   ShaderContext::quit();
 
   if (is_fullscreen()) {
@@ -323,6 +383,7 @@ void Video::quit() {
   rendertarget_supported = false;
   shaders_enabled = false;
   acceleration_enabled = false;
+  render_thread_wanted = false;
   scaled_surface = nullptr;
   video_mode = nullptr;
   default_video_mode = nullptr;
@@ -384,6 +445,14 @@ void Video::show_window() {
   SDL_ShowWindow(main_window);
 }
 
+/**
+ * \brief Returns whether no window is displayed (option -no-video).
+ * \return \c true if nothing is ever rendered.
+ */
+bool Video::is_disabled() {
+  return disable_window;
+}
+
 /**
  * \brief Returns whether 2D hardware acceleration is currently enabled.
  *
@@ -542,6 +611,10 @@ bool Video::set_video_mode(const VideoMode& mode, bool fullscreen) {
       scaled_surface->fill_with_color(Color::black);  // To initialize the internal surface.
     }
 
+    // Window changes may recreate the renderer resources:
+    // let the render thread finish the frame it is presenting.
+    wait_rendering();
+
     // Initialize the window.
     // Set fullscreen flag first to set the size on the right mode.
     SDL_SetWindowFullscreen(main_window, fullscreen_flag);
@@ -554,10 +627,12 @@ bool Video::set_video_mode(const VideoMode& mode, bool fullscreen) {
       SDL_SetWindowPosition(main_window,
           SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
     }
-    SDL_RenderSetLogicalSize(
-        main_renderer,
-        render_size.width,
-        render_size.height);
+    run_on_renderer([&render_size]() {
+      SDL_RenderSetLogicalSize(
+          main_renderer,
+          render_size.width,
+          render_size.height);
+    });
     SDL_ShowCursor(show_cursor);
 
     if (mode_changed) {
@@ -617,6 +692,8 @@ const VideoMode* Video::get_video_mode_by_name(
  */
 void Video::render(const SurfacePtr& quest_surface) {
 
+  Profiler::Zone zone("Video::render");
+
   if (disable_window) {
     return;
   }
@@ -645,11 +722,49 @@ void Video::render(const SurfacePtr& quest_surface) {
       surface_to_render = quest_surface.get();
     }
 
-    SDL_SetRenderDrawColor(main_renderer, 0, 0, 0, 255);
-    SDL_RenderSetClipRect(main_renderer, nullptr);
-    SDL_RenderClear(main_renderer);
-    surface_to_render->render(main_renderer);
-    SDL_RenderPresent(main_renderer);
+    if (render_thread != nullptr) {
+      // Record the frame and let the render thread present it
+      // while the simulation continues.
+      std::unique_ptr<RenderCommandList> frame(new RenderCommandList(true));
+      surface_to_render->render(*frame);
+      render_thread->submit_frame(std::move(frame));
+    }
+    else {
+      RenderCommandList frame(false);
+      surface_to_render->render(frame);
+      frame.present(main_renderer);
+    }
+  }
+}
+
+/**
+ * \brief Waits until all frames submitted to the render thread are presented.
+ *
+ * Does nothing if there is no render thread.
+ * This should be called before changing the window from this thread,
+ * since SDL may then access the renderer.
+ */
+void Video::wait_rendering() {
+
+  if (render_thread != nullptr) {
+    render_thread->wait_idle();
+  }
+}
+
+/**
+ * \brief Destroys a texture of the renderer.
+ *
+ * If there is a render thread, the texture is destroyed by that thread.
+ *
+ * \param texture The texture to destroy.
+ */
+void Video::destroy_texture(SDL_Texture* texture) {
+
+  if (render_thread != nullptr) {
+    render_thread->destroy_texture(texture);
+  }
+  else if (main_renderer != nullptr) {
+    SDL_DestroyTexture(texture);
   }
 }
 
@@ -824,6 +939,7 @@ void Video::set_window_size(const Size& size) {
     int height = 0;
     SDL_GetWindowSize(main_window, &width, &height);
     if (width != size.width || height != size.height) {
+      wait_rendering();
       SDL_SetWindowSize(
           main_window,
           size.width,
@@ -859,7 +975,9 @@ Rectangle Video::get_viewport() {
 
   SDL_Rect viewport;
 
-  SDL_RenderGetViewport(get_renderer(), &viewport);
+  run_on_renderer([&viewport]() {
+    SDL_RenderGetViewport(get_renderer(), &viewport);
+  });
 
   return Rectangle(viewport.x, viewport.y, viewport.w, viewport.h);
 }
@@ -875,11 +993,14 @@ bool Video::window_to_quest_coordinates(
     const Point& window_xy,
     Point& quest_xy
 ) {
-  Rectangle viewport = get_viewport();
-
+  SDL_Rect sdl_viewport;
   float scale_x = 0.0;
   float scale_y = 0.0;
-  SDL_RenderGetScale(get_renderer(), &scale_x, &scale_y);
+  run_on_renderer([&sdl_viewport, &scale_x, &scale_y]() {
+    SDL_RenderGetViewport(get_renderer(), &sdl_viewport);
+    SDL_RenderGetScale(get_renderer(), &scale_x, &scale_y);
+  });
+  const Rectangle viewport(sdl_viewport.x, sdl_viewport.y, sdl_viewport.w, sdl_viewport.h);
 
   const double x_position = window_xy.x - viewport.get_x() * scale_x;
   const double y_position = window_xy.y - viewport.get_y() * scale_y;
@@ -918,7 +1039,9 @@ bool Video::renderer_to_quest_coordinates(
 
   int renderer_width = 0;
   int renderer_height = 0;
-  SDL_RenderGetLogicalSize(get_renderer(), &renderer_width, &renderer_height);
+  run_on_renderer([&renderer_width, &renderer_height]() {
+    SDL_RenderGetLogicalSize(get_renderer(), &renderer_width, &renderer_height);
+  });
 
   const double quest_width = quest_size.width;
   const double quest_height = quest_size.height;
@@ -4453,6 +4453,35 @@ void LuaContext::do_custom_entity_collision_callback(
   LuaTools::call_function(l, 4, 0, "collision callback");
 }
 
+/**
+ * \brief Executes a callback after a batched collision test of a custom
+ * entity detected entities.
+ * \param callback_ref Ref of the function to call.
+ * \param custom_entity A custom entity that detected collisions.
+ * \param other_entities The entities that were detected.
+ */
+void LuaContext::do_custom_entity_collision_callback(
+    const ScopedLuaRef& callback_ref,
+    CustomEntity& custom_entity,
+    const std::vector<EntityPtr>& other_entities
+) {
+  Debug::check_assertion(!callback_ref.is_empty(),
+      "Missing collision callback");
+
+  push_ref(l, callback_ref);
+  Debug::check_assertion(lua_isfunction(l, -1),
+      "Collision callback is not a function");
+  push_custom_entity(l, custom_entity);
+  lua_createtable(l, other_entities.size(), 0);
+  int i = 1;
+  for (const EntityPtr& other_entity: other_entities) {
+    push_entity(l, *other_entity);
+    lua_rawseti(l, -2, i);
+    ++i;
+  }
+  LuaTools::call_function(l, 2, 0, "collision callback");
+}
+
 /**
  * \brief Implementation of custom_entity:get_model().
  * \param l The Lua context that is calling this function.
@@ -4752,8 +4781,57 @@ int LuaContext::custom_entity_api_add_collision_test(lua_State* l) {
       const ScopedLuaRef& collision_test_ref = LuaTools::check_function(l, 2);
       entity.add_collision_test(collision_test_ref, callback_ref);
     }
+    else if (lua_istable(l, 2)) {
+      // Native collision test.
+      CustomEntity::CollisionPredicate predicate;
+      predicate.radius = LuaTools::opt_int_field(l, 2, "radius", -1);
+      predicate.facing_cone = LuaTools::opt_number_field(l, 2, "facing_cone", -1.0);
+      predicate.batched = LuaTools::opt_boolean_field(l, 2, "batched", false);
+
+      lua_getfield(l, 2, "entity_types");
+      if (!lua_isnil(l, -1)) {
+        if (!lua_istable(l, -1)) {
+          LuaTools::arg_error(l, 2, "Bad field 'entity_types' (table expected)");
+        }
+        lua_pushnil(l);
+        while (lua_next(l, -2) != 0) {
+          const std::string type_name = lua_isstring(l, -1) ? lua_tostring(l, -1) : "";
+          bool found = false;
+          for (const auto& kvp: EntityTypeInfo::get_entity_type_names()) {
+            if (kvp.second == type_name) {
+              predicate.entity_types.insert(kvp.first);
+              found = true;
+              break;
+            }
+          }
+          if (!found) {
+            LuaTools::arg_error(l, 2, "Bad field 'entity_types' (invalid entity type '" + type_name + "')");
+          }
+          lua_pop(l, 1);
+        }
+      }
+      lua_pop(l, 1);
+
+      lua_getfield(l, 2, "layers");
+      if (!lua_isnil(l, -1)) {
+        if (!lua_istable(l, -1)) {
+          LuaTools::arg_error(l, 2, "Bad field 'layers' (table expected)");
+        }
+        lua_pushnil(l);
+        while (lua_next(l, -2) != 0) {
+          if (!LuaTools::is_layer(l, -1)) {
+            LuaTools::arg_error(l, 2, "Bad field 'layers' (invalid layer)");
+          }
+          predicate.layers.insert(Layer(lua_tointeger(l, -1)));
+          lua_pop(l, 1);
+        }
+      }
+      lua_pop(l, 1);
+
+      entity.add_collision_test(predicate, callback_ref);
+    }
     else {
-      LuaTools::type_error(l, 2, "string or function");
+      LuaTools::type_error(l, 2, "string, function or table");
     }
 
     return 0;
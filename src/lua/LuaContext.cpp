@@ -31,6 +31,7 @@
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lua/ExportableToLuaPtr.h"
 #include "solarus/lua/LuaContext.h"
+#include "solarus/lua/LuaProfiler.h"
 #include "solarus/lua/LuaTools.h"
 #include "solarus/AbilityInfo.h"
 #include "solarus/Equipment.h"
@@ -94,6 +95,19 @@ MainLoop& LuaContext::get_main_loop() {
   return main_loop;
 }
 
+/**
+ * \brief Returns the memory currently used by Lua.
+ * \return The size of the Lua heap in bytes.
+ */
+int64_t LuaContext::get_heap_size() {
+
+  if (l == nullptr) {
+    return 0;
+  }
+  return static_cast<int64_t>(lua_gc(l, LUA_GCCOUNT, 0)) * 1024
+      + lua_gc(l, LUA_GCCOUNTB, 0);
+}
+
 /**
  * \brief Initializes Lua.
  */
@@ -103,6 +117,7 @@ void LuaContext::initialize() {
   l = luaL_newstate();
   lua_atpanic(l, l_panic);
   luaL_openlibs(l);
+  LuaProfiler::attach(l);
 
   print_lua_version();
 
@@ -177,6 +192,7 @@ void LuaContext::exit() {
     destroy_drawables();
 
     // Finalize Lua.
+    LuaProfiler::detach(l);
     lua_close(l);
     lua_contexts.erase(l);
     l = nullptr;
@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Profiler.h"
+#include "solarus/lua/LuaProfiler.h"
+#include "solarus/Arguments.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <lua.hpp>
+
+namespace Solarus {
+
+namespace LuaProfiler {
+
+namespace {
+
+/**
+ * \brief Number of Lua instructions executed between two samples
+ * when no function is called or returns.
+ */
+constexpr int sample_interval = 1000;
+
+/**
+ * \brief Time statistics of an engine-originated callback.
+ */
+struct CallbackStats {
+  uint64_t total_time;      /**< Inclusive time in microseconds. */
+  int num_calls;            /**< Number of calls. */
+};
+
+/**
+ * \brief What the Lua code was doing when sampled.
+ */
+struct Location {
+  std::string stack;        /**< Folded stack, outermost frame first. */
+  std::string function;     /**< Innermost function. */
+  std::string script;       /**< Script file of the innermost function. */
+};
+
+/**
+ * \brief A callback currently being executed.
+ */
+struct RunningCallback {
+  std::string name;         /**< Callback name and location of its function. */
+  uint64_t start_time;      /**< Date when the callback was called. */
+  Location location;        /**< Last known location in this callback. */
+  lua_State* l;             /**< The Lua state that called the callback. */
+  int stack_depth;          /**< Number of frames of this state below the callback. */
+};
+
+bool enabled = false;                  /**< Whether the profiler is active. */
+std::string report_file_name;          /**< Where to write the report. */
+std::vector<RunningCallback>
+    running_callbacks;                 /**< Stack of nested callbacks being run. */
+uint64_t last_sample_date = 0;         /**< Date of the last sample. */
+
+std::map<std::string, CallbackStats>
+    callback_stats;                    /**< Inclusive time of each callback. */
+std::map<std::string, uint64_t>
+    stack_times;                       /**< Sampled time of each folded stack. */
+std::map<std::string, uint64_t>
+    function_times;                    /**< Sampled self time of each function. */
+std::map<std::string, uint64_t>
+    script_times;                      /**< Sampled self time of each script. */
+
+/**
+ * \brief Returns a readable description of a function.
+ * \param info Debug information filled with at least "Sn".
+ * \return The function name and where it is defined.
+ */
+std::string get_function_description(const lua_Debug& info) {
+
+  const std::string name = (info.name != nullptr) ? info.name : "?";
+  if (std::string(info.what) == "C") {
+    return "[C] " + name;
+  }
+
+  std::ostringstream oss;
+  oss << name << " (" << info.short_src << ":" << info.linedefined << ")";
+  return oss.str();
+}
+
+/**
+ * \brief Returns the script file of a function.
+ * \param info Debug information filled with at least "S".
+ * \return The script file, or "[C]" for a C function.
+ */
+std::string get_script_name(const lua_Debug& info) {
+
+  if (std::string(info.what) == "C") {
+    return "[C]";
+  }
+  return info.short_src;
+}
+
+/**
+ * \brief Returns the number of frames on the call stack of a Lua state.
+ * \param l The Lua state, or a coroutine.
+ * \return The depth of its stack.
+ */
+int get_stack_depth(lua_State* l) {
+
+  lua_Debug info;
+  int depth = 0;
+  while (lua_getstack(l, depth, &info)) {
+    ++depth;
+  }
+  return depth;
+}
+
+/**
+ * \brief Attributes some time to a location.
+ * \param location The location.
+ * \param duration The time to add in microseconds.
+ */
+void add_time(const Location& location, uint64_t duration) {
+
+  if (duration == 0 || location.stack.empty()) {
+    return;
+  }
+  stack_times[location.stack] += duration;
+  function_times[location.function] += duration;
+  script_times[location.script] += duration;
+}
+
+/**
+ * \brief Attributes the time elapsed since the last sample to the location
+ * of the innermost running callback.
+ * \param now The current date.
+ */
+void flush_time(uint64_t now) {
+
+  if (!running_callbacks.empty()) {
+    add_time(running_callbacks.back().location, now - last_sample_date);
+  }
+  last_sample_date = now;
+}
+
+/**
+ * \brief Hook called by Lua when a function is called or returns, and
+ * every sample_interval instructions.
+ *
+ * The time elapsed since the previous event is attributed to the location
+ * known at that event, and the current stack becomes the new location.
+ * Call and return events make the time of short functions exact, while
+ * count events also split long running functions.
+ *
+ * \param l The Lua state, or a coroutine.
+ * \param ar The hook event.
+ */
+void sample_hook(lua_State* l, lua_Debug* ar) {
+
+  if (running_callbacks.empty()) {
+    return;
+  }
+
+  // When a function returns, it is still on the stack:
+  // what follows belongs to its caller.
+  const int first_level = (ar->event == LUA_HOOKRET) ? 1 : 0;
+
+  // Only keep the frames of the innermost callback: frames below it
+  // belong to enclosing callbacks.
+  RunningCallback& callback = running_callbacks.back();
+  int end_level = get_stack_depth(l);
+  if (l == callback.l) {
+    end_level -= callback.stack_depth;
+  }
+
+  // Walk the stack from the innermost frame.
+  std::vector<std::string> frames;
+  Location location;
+  lua_Debug info;
+  for (int level = first_level; level < end_level && lua_getstack(l, level, &info); ++level) {
+    lua_getinfo(l, "Sn", &info);
+    frames.push_back(get_function_description(info));
+    if (level == first_level) {
+      location.function = frames.back();
+      location.script = get_script_name(info);
+    }
+  }
+
+  if (frames.empty()) {
+    return;
+  }
+
+  location.stack = callback.name;
+  for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+    location.stack += ";" + *it;
+  }
+
+  flush_time(Profiler::get_time());
+  callback.location = std::move(location);
+}
+
+/**
+ * \brief Returns map entries sorted by decreasing time.
+ * \param times The map to sort.
+ * \return The sorted entries.
+ */
+std::vector<std::pair<std::string, uint64_t>> sort_by_time(
+    const std::map<std::string, uint64_t>& times
+) {
+  std::vector<std::pair<std::string, uint64_t>> sorted(times.begin(), times.end());
+  std::sort(sorted.begin(), sorted.end(), [](
+      const std::pair<std::string, uint64_t>& first,
+      const std::pair<std::string, uint64_t>& second) {
+    return first.second > second.second;
+  });
+  return sorted;
+}
+
+/**
+ * \brief Writes a section of the report.
+ * \param out The output stream.
+ * \param title Title of the section.
+ * \param times Time of each entry of the section.
+ */
+void write_section(
+    std::ostream& out,
+    const std::string& title,
+    const std::map<std::string, uint64_t>& times
+) {
+  out << title << std::endl;
+  for (const auto& kvp: sort_by_time(times)) {
+    out << "  " << (kvp.second / 1000.0) << " ms  " << kvp.first << std::endl;
+  }
+  out << std::endl;
+}
+
+/**
+ * \brief Writes the report and the folded stacks.
+ */
+void write_report() {
+
+  std::ofstream report(report_file_name);
+  if (!report.good()) {
+    Debug::error("Cannot write Lua profiling report '" + report_file_name + "'");
+    return;
+  }
+
+  std::map<std::string, uint64_t> callback_times;
+  for (const auto& kvp: callback_stats) {
+    callback_times[kvp.first] = kvp.second.total_time;
+  }
+
+  report << "Callbacks (inclusive time, calls)" << std::endl;
+  for (const auto& kvp: sort_by_time(callback_times)) {
+    report << "  " << (kvp.second / 1000.0) << " ms  "
+        << callback_stats[kvp.first].num_calls << "  " << kvp.first << std::endl;
+  }
+  report << std::endl;
+  write_section(report, "Functions (sampled self time)", function_times);
+  write_section(report, "Scripts (sampled self time)", script_times);
+
+  std::ofstream folded(report_file_name + ".folded");
+  for (const auto& kvp: stack_times) {
+    folded << kvp.first << " " << kvp.second << std::endl;
+  }
+}
+
+}
+
+/**
+ * \brief Initializes the Lua profiler.
+ *
+ * Options recognized:
+ *   -lua-profile=<path>
+ *
+ * \param args Command-line arguments.
+ */
+void initialize(const Arguments& args) {
+
+  report_file_name = args.get_argument_value("-lua-profile");
+  enabled = !report_file_name.empty();
+}
+
+/**
+ * \brief Writes the report if the profiler was enabled and stops it.
+ */
+void quit() {
+
+  if (!enabled) {
+    return;
+  }
+
+  write_report();
+
+  enabled = false;
+  report_file_name.clear();
+  running_callbacks.clear();
+  callback_stats.clear();
+  stack_times.clear();
+  function_times.clear();
+  script_times.clear();
+}
+
+/**
+ * \brief Returns whether Lua code is being profiled.
+ * \return \c true if the profiler is enabled.
+ */
+bool is_enabled() {
+  return enabled;
+}
+
+/**
+ * \brief Starts sampling a Lua state if the profiler is enabled.
+ * \param l The Lua state just created.
+ */
+void attach(lua_State* l) {
+
+  if (!enabled) {
+    return;
+  }
+  lua_sethook(l, sample_hook, LUA_MASKCALL | LUA_MASKRET | LUA_MASKCOUNT, sample_interval);
+}
+
+/**
+ * \brief Stops sampling a Lua state that is about to be closed.
+ * \param l The Lua state.
+ */
+void detach(lua_State* l) {
+
+  if (!enabled) {
+    return;
+  }
+  lua_sethook(l, nullptr, 0, 0);
+}
+
+/**
+ * \brief Notifies the profiler that the engine is about to call a Lua
+ * function.
+ * \param l The Lua state.
+ * \param function_index Index of the function in the stack.
+ * \param callback_name Name describing the callback.
+ */
+void enter_callback(lua_State* l, int function_index, const char* callback_name) {
+
+  if (!enabled) {
+    return;
+  }
+
+  std::string description = callback_name;
+  std::string script = "?";
+  if (lua_isfunction(l, function_index)) {
+    lua_Debug info;
+    lua_pushvalue(l, function_index);
+    lua_getinfo(l, ">S", &info);
+    info.name = callback_name;
+    description = get_function_description(info);
+    script = get_script_name(info);
+  }
+
+  const uint64_t now = Profiler::get_time();
+  flush_time(now);  // The time so far belongs to the enclosing callback if any.
+
+  Location location;
+  location.stack = description;
+  location.function = description;
+  location.script = script;
+  running_callbacks.push_back({ description, now, std::move(location), l, get_stack_depth(l) });
+}
+
+/**
+ * \brief Notifies the profiler that the Lua function called since the last
+ * enter_callback() has returned.
+ */
+void leave_callback() {
+
+  if (!enabled || running_callbacks.empty()) {
+    return;
+  }
+
+  const uint64_t now = Profiler::get_time();
+  flush_time(now);
+
+  const RunningCallback& callback = running_callbacks.back();
+  CallbackStats& stats = callback_stats[callback.name];
+  stats.total_time += now - callback.start_time;
+  ++stats.num_calls;
+  running_callbacks.pop_back();
+}
+
+}
+
+}
+
@@ -17,6 +17,7 @@
 #include "solarus/lua/LuaTools.h"
 #include "solarus/lowlevel/Color.h"
 #include "solarus/lua/LuaException.h"
+#include "solarus/lua/LuaProfiler.h"
 #include "solarus/lua/ScopedLuaRef.h"
 #include <cctype>
 #include <sstream>
@@ -113,7 +114,11 @@ bool call_function(
     int nb_results,
     const char* function_name
 ) {
-  if (lua_pcall(l, nb_arguments, nb_results, 0) != 0) {
+  LuaProfiler::enter_callback(l, -(nb_arguments + 1), function_name);
+  const int status = lua_pcall(l, nb_arguments, nb_results, 0);
+  LuaProfiler::leave_callback();
+
+  if (status != 0) {
     Debug::error(std::string("In ") + function_name + ": "
         + lua_tostring(l, -1)
     );
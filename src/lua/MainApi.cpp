@@ -16,7 +16,9 @@
  */
 #include "solarus/lua/LuaContext.h"
 #include "solarus/lua/LuaTools.h"
+#include "solarus/lowlevel/FrameStats.h"
 #include "solarus/lowlevel/Geometry.h"
+#include "solarus/lowlevel/MemoryStats.h"
 #include "solarus/lowlevel/QuestFiles.h"
 #include "solarus/lowlevel/System.h"
 #include "solarus/MainLoop.h"
@@ -50,6 +52,8 @@ void LuaContext::register_main_module() {
       { "get_type", main_api_get_type },
       { "get_metatable", main_api_get_metatable },
       { "get_os", main_api_get_os },
+      { "get_frame_stats", main_api_get_frame_stats },
+      { "get_memory_stats", main_api_get_memory_stats },
       { nullptr, nullptr }
   };
 
@@ -404,5 +408,60 @@ bool LuaContext::main_on_input(const InputEvent& event) {
   return handled;
 }
 
+/**
+ * \brief Implementation of sol.main.get_frame_stats().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::main_api_get_frame_stats(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const FrameStats& stats = get_lua_context(l).get_main_loop().get_frame_stats();
+
+    lua_createtable(l, 0, 6);
+    lua_pushinteger(l, stats.get_num_frames());
+    lua_setfield(l, -2, "num_frames");
+    lua_pushnumber(l, stats.get_min_duration() / 1000.0);
+    lua_setfield(l, -2, "min");
+    lua_pushnumber(l, stats.get_max_duration() / 1000.0);
+    lua_setfield(l, -2, "max");
+    lua_pushnumber(l, stats.get_average_duration() / 1000.0);
+    lua_setfield(l, -2, "average");
+    lua_pushnumber(l, stats.get_jitter() / 1000.0);
+    lua_setfield(l, -2, "jitter");
+
+    const std::vector<int>& histogram = stats.get_histogram();
+    lua_createtable(l, histogram.size(), 0);
+    for (size_t i = 0; i < histogram.size(); ++i) {
+      lua_pushinteger(l, histogram[i]);
+      lua_rawseti(l, -2, i + 1);
+    }
+    lua_setfield(l, -2, "histogram");
+
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of sol.main.get_memory_stats().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::main_api_get_memory_stats(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    lua_createtable(l, 0, MemoryStats::num_categories + 1);
+    for (int i = 0; i < MemoryStats::num_categories; ++i) {
+      const MemoryCategory category = static_cast<MemoryCategory>(i);
+      lua_pushnumber(l, static_cast<lua_Number>(MemoryStats::get(category)));
+      lua_setfield(l, -2, MemoryStats::get_category_name(category).c_str());
+    }
+    lua_pushnumber(l, static_cast<lua_Number>(get_lua_context(l).get_heap_size()));
+    lua_setfield(l, -2, "lua");
+
+    return 1;
+  });
+}
+
 }
 
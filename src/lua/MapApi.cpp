@@ -102,6 +102,9 @@ void LuaContext::register_map_module() {
       { "get_hero", map_api_get_hero },
       { "set_entities_enabled", map_api_set_entities_enabled },
       { "remove_entities", map_api_remove_entities },
+      { "set_performance_stats_enabled", map_api_set_performance_stats_enabled },
+      { "get_performance_stats", map_api_get_performance_stats },
+      { "set_performance_overlay_enabled", map_api_set_performance_overlay_enabled },
       { nullptr, nullptr }
   };
 
@@ -1877,6 +1880,105 @@ int LuaContext::map_api_remove_entities(lua_State* l) {
   });
 }
 
+/**
+ * \brief Implementation of map:set_performance_stats_enabled().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::map_api_set_performance_stats_enabled(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    Map& map = *check_map(l, 1);
+    bool enabled = LuaTools::opt_boolean(l, 2, true);
+
+    map.get_entities().get_performance_stats().set_enabled(enabled);
+
+    return 0;
+  });
+}
+
+namespace {
+
+/**
+ * \brief Pushes onto the stack a table with the costs of some entities.
+ *
+ * Durations are pushed in milliseconds.
+ *
+ * \param l A Lua state.
+ * \param cost The time spent by the entities.
+ */
+void push_entity_cost(lua_State* l, const EntityPerformanceStats::Cost& cost) {
+
+  lua_createtable(l, 0, 2);
+  lua_pushnumber(l, cost.update_time / 1000.0);
+  lua_setfield(l, -2, "update");
+  lua_pushnumber(l, cost.draw_time / 1000.0);
+  lua_setfield(l, -2, "draw");
+}
+
+}
+
+/**
+ * \brief Implementation of map:get_performance_stats().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::map_api_get_performance_stats(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    Map& map = *check_map(l, 1);
+
+    const EntityPerformanceStats& stats = map.get_entities().get_performance_stats();
+
+    lua_createtable(l, 0, 5);
+    lua_pushinteger(l, stats.get_num_update_frames());
+    lua_setfield(l, -2, "num_updates");
+    lua_pushinteger(l, stats.get_num_draw_frames());
+    lua_setfield(l, -2, "num_draws");
+
+    lua_createtable(l, 0, stats.get_type_costs().size());
+    for (const auto& kvp: stats.get_type_costs()) {
+      push_entity_cost(l, kvp.second);
+      lua_setfield(l, -2, EntityTypeInfo::get_entity_type_name(kvp.first).c_str());
+    }
+    lua_setfield(l, -2, "types");
+
+    lua_createtable(l, 0, stats.get_entity_costs().size());
+    for (const auto& kvp: stats.get_entity_costs()) {
+      push_entity_cost(l, kvp.second);
+      lua_setfield(l, -2, kvp.first.c_str());
+    }
+    lua_setfield(l, -2, "entities");
+
+    const PathFindingCache& path_finding_cache = map.get_entities().get_path_finding_cache();
+    lua_createtable(l, 0, 2);
+    lua_pushinteger(l, path_finding_cache.get_num_hits());
+    lua_setfield(l, -2, "hits");
+    lua_pushinteger(l, path_finding_cache.get_num_misses());
+    lua_setfield(l, -2, "misses");
+    lua_setfield(l, -2, "path_cache");
+
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of map:set_performance_overlay_enabled().
+ * \param l The Lua context that is calling this function.
+ * \return Number of values to return to Lua.
+ */
+int LuaContext::map_api_set_performance_overlay_enabled(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    Map& map = *check_map(l, 1);
+    bool enabled = LuaTools::opt_boolean(l, 2, true);
+
+    map.get_entities().set_performance_overlay_enabled(enabled);
+
+    return 0;
+  });
+}
+
 /**
  * \brief Implementation of all entity creation functions: map_api_create_*.
  * \param l The Lua context that is calling this function.
@@ -14,6 +14,7 @@
  * You should have received a copy of the GNU General Public License along
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
+#include "solarus/lowlevel/Profiler.h"
 #include "solarus/lowlevel/Surface.h"
 #include "solarus/lua/ExportableToLuaPtr.h"
 #include "solarus/lua/LuaContext.h"
@@ -157,6 +158,8 @@ void LuaContext::destroy_menus() {
  */
 void LuaContext::update_menus() {
 
+  Profiler::Zone zone("LuaContext::update_menus");
+
   // Destroy the ones that should be removed.
   for (auto it = menus.begin(); it != menus.end(); ++it) {
 
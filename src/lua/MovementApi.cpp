@@ -23,6 +23,7 @@
 #include "solarus/movements/CircleMovement.h"
 #include "solarus/movements/JumpMovement.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Profiler.h"
 #include "solarus/lua/ExportableToLua.h"
 #include "solarus/lua/ExportableToLuaPtr.h"
 #include "solarus/lua/LuaContext.h"
@@ -225,6 +226,8 @@ void LuaContext::register_movement_module() {
       { "set_target", path_finding_movement_api_set_target },
       { "get_speed", path_finding_movement_api_get_speed },
       { "set_speed", path_finding_movement_api_set_speed },
+      { "is_flow_field_enabled", path_finding_movement_api_is_flow_field_enabled },
+      { "set_flow_field_enabled", path_finding_movement_api_set_flow_field_enabled },
       { nullptr, nullptr }
   };
   register_type(
@@ -457,6 +460,8 @@ void LuaContext::stop_movement_on_point(const std::shared_ptr<Movement>& movemen
  */
 void LuaContext::update_movements() {
 
+  Profiler::Zone zone("LuaContext::update_movements");
+
   lua_getfield(l, LUA_REGISTRYINDEX, "sol.movements_on_points");
   lua_pushnil(l);  // First key.
   while (lua_next(l, -2)) {
@@ -1374,6 +1379,35 @@ int LuaContext::path_finding_movement_api_set_speed(lua_State* l) {
   });
 }
 
+/**
+ * \brief Implementation of path_finding_movement:is_flow_field_enabled().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::path_finding_movement_api_is_flow_field_enabled(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    const PathFindingMovement& movement = *check_path_finding_movement(l, 1);
+    lua_pushboolean(l, movement.is_flow_field_enabled());
+    return 1;
+  });
+}
+
+/**
+ * \brief Implementation of path_finding_movement:set_flow_field_enabled().
+ * \param l the Lua context that is calling this function
+ * \return number of values to return to Lua
+ */
+int LuaContext::path_finding_movement_api_set_flow_field_enabled(lua_State* l) {
+
+  return LuaTools::exception_boundary_handle(l, [&] {
+    PathFindingMovement& movement = *check_path_finding_movement(l, 1);
+    bool flow_field_enabled = LuaTools::opt_boolean(l, 2, true);
+    movement.set_flow_field_enabled(flow_field_enabled);
+    return 0;
+  });
+}
+
 /**
  * \brief Returns whether a value is a userdata of type circle movement.
  * \param l A Lua context.
@@ -16,6 +16,7 @@
  */
 #include "solarus/entities/Entity.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Profiler.h"
 #include "solarus/lowlevel/System.h"
 #include "solarus/lua/ExportableToLuaPtr.h"
 #include "solarus/lua/LuaContext.h"
@@ -232,6 +233,8 @@ void LuaContext::destroy_timers() {
  */
 void LuaContext::update_timers() {
 
+  Profiler::Zone zone("LuaContext::update_timers");
+
   // Update all timers.
   for (const auto& kvp: timers) {
 
@@ -59,6 +59,22 @@ void print_help(const Solarus::Arguments& args) {
     << std::endl
     << "  -quest-size=<width>x<height>  sets the size of the drawing area (if compatible with the quest)"
     << std::endl
+    << "  -turbo                        simulates as fast as possible instead of real time"
+    << std::endl
+    << "  -turbo-draw-interval=<steps>  in turbo mode, redraws every <steps> steps (default 10, 0 means never)"
+    << std::endl
+    << "  -render-thread                presents frames from a separate thread"
+    << std::endl
+    << "  -path-finding-threads=<n>     searches paths of enemies in <n> background threads (default 0)"
+    << std::endl
+    << "  -record-input=<path>          records input events and the random seed to a file"
+    << std::endl
+    << "  -replay-input=<path>          replays input events recorded with -record-input, then exits"
+    << std::endl
+    << "  -trace-file=<path>            writes profiling zones to a Chrome trace event file"
+    << std::endl
+    << "  -lua-profile=<path>           writes a profiling report of Lua scripts at exit"
+    << std::endl
     << "  -win-console=yes|no           allows to see output in a console, only needed on Windows (default no)"
     << std::endl;
 }
@@ -85,6 +101,14 @@ void print_help(const Solarus::Arguments& args) {
  *   -no-video                         Disables displaying (used for unit tests).
  *   -video-acceleration=yes|no        Enables or disables 2D accelerated graphics if available (default yes).
  *   -quest-size=<width>x<height>      Sets the size of the drawing area (if compatible with the quest).
+ *   -turbo                            Simulates as fast as possible instead of real time.
+ *   -turbo-draw-interval=<steps>      In turbo mode, redraws every <steps> steps (default 10, 0 means never).
+ *   -render-thread                    Presents frames from a separate thread.
+ *   -path-finding-threads=<n>         Searches paths of enemies in <n> background threads (default 0).
+ *   -record-input=<path>              Records input events and the random seed to a file.
+ *   -replay-input=<path>              Replays input events recorded with -record-input, then exits.
+ *   -trace-file=<path>                Writes profiling zones to a Chrome trace event file.
+ *   -lua-profile=<path>               Writes a profiling report of Lua scripts at exit.
  *   -win-console=yes|no               Opens a console to see debug output (default: no).
  *                                     Windows only (other systems use their existing console if any).
  *
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/movements/AsyncPathFinding.h"
+#include "solarus/movements/PathFinding.h"
+#include "solarus/movements/PathFindingSnapshot.h"
+#include "solarus/entities/Entity.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/Arguments.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace Solarus {
+
+namespace AsyncPathFinding {
+
+namespace {
+
+int num_threads = 0;                 /**< Number of worker threads, 0 means synchronous. */
+std::vector<std::thread> threads;    /**< Worker threads, started on the first request. */
+std::deque<RequestPtr> queue;        /**< Requests waiting for a worker. */
+std::mutex mutex;                    /**< Protects the queue and the stopping flag. */
+std::condition_variable condition;   /**< Notified when a request is queued or when stopping. */
+bool stopping = false;               /**< Whether the workers should finish. */
+
+/**
+ * \brief Main function of a worker thread.
+ *
+ * Computes queued requests until quit() is called.
+ */
+void run_worker() {
+
+  while (true) {
+
+    RequestPtr request;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [] { return stopping || !queue.empty(); });
+      if (stopping) {
+        return;
+      }
+      request = std::move(queue.front());
+      queue.pop_front();
+    }
+
+    if (request.use_count() > 1) {
+      // Otherwise, whoever submitted this request does not need it anymore.
+      request->compute();
+    }
+  }
+}
+
+}
+
+/**
+ * \brief Creates a request.
+ * \param snapshot The query and the obstacles around it.
+ */
+Request::Request(std::unique_ptr<PathFindingSnapshot> snapshot):
+  snapshot(std::move(snapshot)),
+  path(),
+  done(false) {
+
+}
+
+/**
+ * \brief Destructor.
+ */
+Request::~Request() {
+}
+
+/**
+ * \brief Returns the query of this request.
+ * \return The snapshot the path is searched in.
+ */
+const PathFindingSnapshot& Request::get_snapshot() const {
+  return *snapshot;
+}
+
+/**
+ * \brief Returns whether the path was computed.
+ * \return \c true if get_path() can be called.
+ */
+bool Request::is_done() const {
+  return done.load(std::memory_order_acquire);
+}
+
+/**
+ * \brief Returns the path found.
+ *
+ * Must only be called once the request is done.
+ *
+ * \return The path, or an empty string if no path was found.
+ */
+const std::string& Request::get_path() const {
+
+  Debug::check_assertion(is_done(), "This path request is not done yet");
+  return path;
+}
+
+/**
+ * \brief Computes the path.
+ *
+ * This is called by a worker thread.
+ */
+void Request::compute() {
+
+  PathFinding path_finding(*snapshot);
+  path = path_finding.compute_path();
+  done.store(true, std::memory_order_release);
+}
+
+/**
+ * \brief Initializes asynchronous path finding.
+ *
+ * Options recognized:
+ *   -path-finding-threads=<n>
+ *
+ * \param args Command-line arguments.
+ */
+void initialize(const Arguments& args) {
+
+  num_threads = 0;
+  const std::string& num_threads_string = args.get_argument_value("-path-finding-threads");
+  if (!num_threads_string.empty()) {
+    std::istringstream iss(num_threads_string);
+    if (!(iss >> num_threads) || num_threads < 0) {
+      Debug::error("Invalid number of path finding threads: '" + num_threads_string + "'");
+      num_threads = 0;
+    }
+  }
+
+#if defined(SOLARUS_OSX) || defined(SOLARUS_IOS)
+  if (num_threads > 0) {
+    // Search nodes of PathFinding cannot be thread-local on these systems.
+    Debug::warning("Asynchronous path finding is not supported on this system");
+    num_threads = 0;
+  }
+#endif
+}
+
+/**
+ * \brief Stops the worker threads.
+ *
+ * Pending requests are dropped and will never be done.
+ */
+void quit() {
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    queue.clear();
+  }
+  condition.notify_all();
+  for (std::thread& thread: threads) {
+    thread.join();
+  }
+  threads.clear();
+  stopping = false;
+  num_threads = 0;
+}
+
+/**
+ * \brief Returns whether paths are computed on worker threads.
+ * \return \c true if there is at least one worker thread.
+ */
+bool is_enabled() {
+  return num_threads > 0;
+}
+
+/**
+ * \brief Returns the number of worker threads.
+ * \return The number of threads, 0 if paths are computed synchronously.
+ */
+int get_num_threads() {
+  return num_threads;
+}
+
+/**
+ * \brief Asks a worker thread to find a path from a node to an entity.
+ *
+ * Must be called from the main thread.
+ * Only close targets can be searched asynchronously: far targets need
+ * the abstract graph of the map.
+ *
+ * \param source_entity The entity that will move.
+ * \param source Location of the source node. It can be different from
+ * the current position of the entity, for example where its current path
+ * will end.
+ * \param target_entity The entity to reach.
+ * \return The request, or nullptr if asynchronous path finding is
+ * disabled or if the path cannot be searched asynchronously.
+ * In this case, use PathFinding directly.
+ */
+RequestPtr submit(
+    Entity& source_entity,
+    const Point& source,
+    const Entity& target_entity) {
+
+  if (!is_enabled()
+      || target_entity.get_layer() != source_entity.get_layer()) {
+    return nullptr;
+  }
+
+  const Point target = PathFinding::get_target_location(target_entity);
+  if (!PathFinding::is_local_search(source, target)) {
+    return nullptr;
+  }
+
+  RequestPtr request = std::make_shared<Request>(
+      std::unique_ptr<PathFindingSnapshot>(new PathFindingSnapshot(source_entity, source, target))
+  );
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (threads.empty()) {
+      for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back(run_worker);
+      }
+    }
+    queue.push_back(request);
+  }
+  condition.notify_one();
+  return request;
+}
+
+}
+
+}
+
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/movements/FlowField.h"
+#include "solarus/entities/Entity.h"
+#include "solarus/lowlevel/System.h"
+#include "solarus/movements/PathFindingGraph.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace Solarus {
+
+namespace {
+
+constexpr int infinite_cost = std::numeric_limits<int>::max();
+
+}
+
+/**
+ * \brief Creates a flow field towards an entity.
+ *
+ * The field is computed by the first call to update().
+ *
+ * \param graph Terrain of the layer of the target.
+ * \param target The entity to reach.
+ * \param width8 Number of 8x8 squares on a row of the map.
+ * \param height8 Number of 8x8 squares on a column of the map.
+ */
+FlowField::FlowField(
+    PathFindingGraph& graph,
+    const Entity& target,
+    int width8,
+    int height8):
+  graph(graph),
+  target(target),
+  width8(width8),
+  height8(height8),
+  target_node(-1),
+  terrain_version(0),
+  next_refresh_date(0) {
+
+}
+
+/**
+ * \brief Returns the entity this field leads to.
+ * \return The target.
+ */
+const Entity& FlowField::get_target() const {
+  return target;
+}
+
+/**
+ * \brief Returns the layer of this field.
+ * \return The layer.
+ */
+Layer FlowField::get_layer() const {
+  return graph.get_layer();
+}
+
+/**
+ * \brief Returns the grounds considered as obstacles in this field.
+ * \return Bits of the obstacle grounds (see GroundBitmaps::get_ground_bit()).
+ */
+uint32_t FlowField::get_obstacle_grounds() const {
+  return graph.get_obstacle_grounds();
+}
+
+/**
+ * \brief Computes the field again if the target or the terrain has changed.
+ */
+void FlowField::update() {
+
+  const uint32_t now = System::now();
+  if (target_node != -1 && now < next_refresh_date) {
+    return;
+  }
+
+  // Snap the target to the grid like PathFinding does.
+  Point location = target.get_bounding_box().get_xy();
+  location.x += 4;
+  location.x += -location.x % 8;
+  location.y += 4;
+  location.y += -location.y % 8;
+  const int x8 = std::min(std::max(location.x / 8, 0), width8 - 2);
+  const int y8 = std::min(std::max(location.y / 8, 0), height8 - 2);
+  const int node = y8 * width8 + x8;
+
+  graph.update();
+  if (node == target_node && graph.get_terrain_version() == terrain_version) {
+    return;
+  }
+
+  compute(node);
+  terrain_version = graph.get_terrain_version();
+  next_refresh_date = now + refresh_delay;
+}
+
+/**
+ * \brief Returns the direction to take to reach the target.
+ * \param location Top-left corner of a 16x16 box aligned to the grid.
+ * \return The direction to take (0 to 7), or -1 if the target cannot be
+ * reached or is already reached.
+ */
+int FlowField::get_direction8(const Point& location) const {
+
+  if (target_node == -1
+      || location.x < 0 || location.y < 0
+      || location.x / 8 > width8 - 2 || location.y / 8 > height8 - 2) {
+    return -1;
+  }
+
+  return directions[(location.y / 8) * width8 + location.x / 8];
+}
+
+/**
+ * \brief Computes the cost and the direction to the target from every node.
+ * \param target_node Square index of the node of the target.
+ */
+void FlowField::compute(int target_node) {
+
+  this->target_node = target_node;
+  costs.assign(width8 * height8, infinite_cost);
+  directions.assign(width8 * height8, -1);
+
+  using QueueElement = std::pair<int, int>;  // Cost, node.
+  std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> queue;
+
+  const int target_x8 = target_node % width8;
+  const int target_y8 = target_node / width8;
+  if (graph.is_node_free(target_x8, target_y8)) {
+    costs[target_node] = 0;
+    queue.emplace(0, target_node);
+  }
+  else {
+    // The target overlaps an obstacle ground, like a wall it is against:
+    // lead to the free nodes around it.
+    for (int direction = 0; direction < 8; ++direction) {
+      const int x8 = target_x8 - Entity::direction_to_xy_move(direction).x;
+      const int y8 = target_y8 - Entity::direction_to_xy_move(direction).y;
+      if (x8 < 0 || y8 < 0 || x8 > width8 - 2 || y8 > height8 - 2
+          || !graph.is_node_free(x8, y8)) {
+        continue;
+      }
+      const int node = y8 * width8 + x8;
+      costs[node] = (direction & 1) ? 11 : 8;
+      directions[node] = direction;
+      queue.emplace(costs[node], node);
+    }
+  }
+
+  while (!queue.empty()) {
+
+    const int cost = queue.top().first;
+    const int node = queue.top().second;
+    queue.pop();
+    if (cost > costs[node]) {
+      continue;  // Already reached with a lower cost.
+    }
+
+    const int x8 = node % width8;
+    const int y8 = node / width8;
+    for (int direction = 0; direction < 8; ++direction) {
+
+      // Look at the node that would come here with this direction.
+      const int dx8 = Entity::direction_to_xy_move(direction).x;
+      const int dy8 = Entity::direction_to_xy_move(direction).y;
+      const int new_x8 = x8 - dx8;
+      const int new_y8 = y8 - dy8;
+      if (new_x8 < 0 || new_y8 < 0 || new_x8 > width8 - 2 || new_y8 > height8 - 2
+          || !graph.is_transition_free(new_x8, new_y8, dx8, dy8)) {
+        continue;
+      }
+
+      const int new_node = new_y8 * width8 + new_x8;
+      const int new_cost = cost + ((direction & 1) ? 11 : 8);
+      if (new_cost < costs[new_node]) {
+        costs[new_node] = new_cost;
+        directions[new_node] = direction;
+        queue.emplace(new_cost, new_node);
+      }
+    }
+  }
+}
+
+}
+
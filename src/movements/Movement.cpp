@@ -16,12 +16,15 @@
  */
 #include "solarus/movements/Movement.h"
 #include "solarus/entities/Entity.h"
+#include "solarus/entities/MapEntities.h"
 #include "solarus/lua/LuaContext.h"
 #include "solarus/lowlevel/System.h"
 #include "solarus/lowlevel/Debug.h"
 #include "solarus/Map.h"
 #include "solarus/Drawable.h"
+#include <algorithm>
 #include <lua.hpp>
+#include <vector>
 
 namespace Solarus {
 
@@ -466,6 +469,110 @@ bool Movement::test_collision_with_obstacles(const Point& dxy) const {
   return test_collision_with_obstacles(dxy.x, dxy.y);
 }
 
+/**
+ * \brief Returns how many one-pixel steps the object can make in a direction
+ * without anything happening between its current position and the last one.
+ *
+ * The steps are free if there is no obstacle on the way, no detector
+ * that could notice intermediate positions, and if the entity does not
+ * observe grounds, no ground change under it.
+ * A detector also needs no other entity close to the way,
+ * since it could detect that entity from intermediate positions.
+ * Ground modifiers and entities whose position changes are
+ * listened to by Lua never make more than one step at a time:
+ * others may need to notice each of their positions.
+ * The movement can then make all these steps at once instead of one by one.
+ *
+ * \param direction The move of one step: each coordinate must be
+ * -1, 0 or 1.
+ * \param max_distance Maximum number of steps to check.
+ * \return The number of free steps, between 0 and \c max_distance.
+ */
+int Movement::get_free_distance(const Point& direction, int max_distance) const {
+
+  if (entity == nullptr) {
+    // Nothing can be on the way.
+    return max_distance;
+  }
+
+  if (max_distance <= 0) {
+    return 0;
+  }
+
+  Map& map = entity->get_map();
+  const Layer layer = entity->get_layer();
+
+  int free_distance = max_distance;
+  if (!current_ignore_obstacles) {
+    free_distance = map.get_obstacle_free_distance(
+        layer, entity->get_bounding_box(), direction, max_distance, *entity
+    );
+    if (free_distance < max_distance) {
+      Rectangle collision_box = entity->get_bounding_box();
+      collision_box.add_xy(direction * (free_distance + 1));
+      last_collision_box_on_obstacle = collision_box;
+    }
+    if (free_distance <= 1) {
+      return free_distance;
+    }
+  }
+
+  // Entities that act on others or that notify Lua scripts
+  // need to stop at each intermediate position.
+  if (entity->is_ground_modifier()) {
+    return std::min(free_distance, 1);
+  }
+  const LuaContext& lua_context = entity->get_lua_context();
+  if (lua_context.userdata_has_field(*this, "on_position_changed") ||
+      (entity->are_movement_notifications_enabled() &&
+       lua_context.userdata_has_field(*entity, "on_position_changed"))) {
+    return std::min(free_distance, 1);
+  }
+
+  // A detector checks the entities around it at each position:
+  // don't skip any when another entity is close to the way.
+  Rectangle first_box = entity->get_extended_bounding_box(8);
+  if (entity->is_detector()) {
+    first_box |= entity->get_max_bounding_box();
+  }
+  Rectangle last_box = first_box;
+  last_box.add_xy(direction * free_distance);
+  const Rectangle swept_box = first_box | last_box;
+  if (entity->is_detector()) {
+    std::vector<EntityPtr> entities;
+    map.get_entities().get_entities_in_rectangle(swept_box, entities);
+    for (const EntityPtr& other: entities) {
+      if (other.get() != entity) {
+        return std::min(free_distance, 1);
+      }
+    }
+  }
+
+  // Detectors check the entity at each position:
+  // don't skip any when one of them is close to the way.
+  std::vector<EntityPtr> detectors;
+  map.get_entities().get_detectors_in_rectangle(swept_box, false, detectors);
+  map.get_entities().get_detectors_in_rectangle(swept_box, true, detectors);
+  for (const EntityPtr& detector: detectors) {
+    if (detector.get() != entity) {
+      return std::min(free_distance, 1);
+    }
+  }
+
+  // Grounds have an effect as soon as the ground point is on them.
+  if (entity->is_ground_observer()) {
+    const Point ground_point = entity->get_ground_point();
+    const Ground ground = map.get_ground(layer, ground_point);
+    for (int distance = 1; distance <= free_distance; ++distance) {
+      if (map.get_ground(layer, ground_point + direction * distance) != ground) {
+        return std::max(distance - 1, 1);
+      }
+    }
+  }
+
+  return free_distance;
+}
+
 /**
  * \brief Returns the collision box of the last collision check that detected an obstacle.
  * \return the collision box of the last collision detected, or (-1, -1) if no obstacle was detected
@@ -15,10 +15,20 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "solarus/movements/PathFinding.h"
+#include "solarus/entities/CustomEntity.h"
 #include "solarus/entities/Entity.h"
+#include "solarus/entities/Hero.h"
+#include "solarus/entities/MapEntities.h"
 #include "solarus/lowlevel/Geometry.h"
 #include "solarus/Map.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/movements/PathFindingCache.h"
+#include "solarus/movements/PathFindingGraph.h"
+#include "solarus/movements/PathFindingSnapshot.h"
+
+#if defined(SOLARUS_OSX) || defined(SOLARUS_IOS)
+#  define thread_local
+#endif
 
 namespace Solarus {
 
@@ -55,140 +65,341 @@ PathFinding::PathFinding(
     Map& map,
     Entity& source_entity,
     Entity& target_entity):
-  map(map),
-  source_entity(source_entity),
-  target_entity(target_entity) {
+  map(&map),
+  source_entity(&source_entity),
+  target_entity(&target_entity),
+  snapshot(nullptr),
+  map_width(map.get_width()),
+  map_height(map.get_height()),
+  search(get_search_nodes()) {
 
   Debug::check_assertion(source_entity.is_aligned_to_grid(),
       "The source must be aligned on the map grid");
 }
 
+/**
+ * \brief Creates a path finding that only reads a snapshot of the map.
+ *
+ * The snapshot must outlive this object.
+ *
+ * \param snapshot the source, the target and the obstacles around them
+ */
+PathFinding::PathFinding(const PathFindingSnapshot& snapshot):
+  map(nullptr),
+  source_entity(nullptr),
+  target_entity(nullptr),
+  snapshot(&snapshot),
+  map_width(snapshot.get_map_width()),
+  map_height(snapshot.get_map_height()),
+  search(get_search_nodes()) {
+
+}
+
+/**
+ * \brief Returns the A* nodes of the current thread.
+ *
+ * They are reused from one search to another to avoid allocations.
+ *
+ * \return The search nodes.
+ */
+PathFinding::SearchNodes& PathFinding::get_search_nodes() {
+
+  thread_local SearchNodes search_nodes;
+  return search_nodes;
+}
+
 /**
  * \brief Tries to find a path between the source point and the target point.
+ *
+ * Close targets are searched directly with A*.
+ * For far targets, a path is first searched in the abstract graph of the
+ * map and then only its beginning is refined.
+ * Paths searched recently are reused if no obstacle has changed since
+ * in the area that the search could explore.
+ *
  * \return the path found, or an empty string if no path was found
- * (because there is no path or the target is too far)
  */
 std::string PathFinding::compute_path() {
 
-  //std::cout << "will compute a path from " << source_entity.get_top_left_x() << ","
-  //  << source_entity.get_top_left_y() << " to " << target_entity.get_top_left_x() << ","
-  //  << target_entity.get_top_left_y() << std::endl;
+  if (snapshot != nullptr) {
+    return compute_local_path(snapshot->get_source(), snapshot->get_target());
+  }
+
+  const Point source = source_entity->get_bounding_box().get_xy();
+  const Point target = get_target_location(*target_entity);
+
+  const Layer layer = source_entity->get_layer();
+  if (target_entity->get_layer() != layer) {
+    return "";
+  }
+
+  const bool local_search = is_local_search(source, target);
+  if (!can_share_paths()) {
+    return local_search ?
+        compute_local_path(source, target) :
+        compute_hierarchical_path(source, target);
+  }
+
+  MapEntities& entities = map->get_entities();
+  PathFindingCache& cache = entities.get_path_finding_cache();
+  const PathFindingCache::Key key = {
+      layer,
+      source_entity->get_type(),
+      PathFindingGraph::get_obstacle_grounds(*source_entity),
+      entities.get_obstacle_version(layer, get_search_area(source, target)),
+      local_search ? 0 : entities.get_terrain_version(),
+      source,
+      target
+  };
+  std::string path;
+  if (cache.find_path(key, path)) {
+    return path;
+  }
+
+  if (local_search) {
+    path = compute_local_path(source, target);
+  }
+  else {
+    path = compute_hierarchical_path(source, target);
+  }
+  cache.add_path(key, path);
+  return path;
+}
+
+/**
+ * \brief Returns the node where a path to an entity should end.
+ * \param target_entity the target entity
+ * \return the location of the target node, aligned on the map grid
+ */
+Point PathFinding::get_target_location(const Entity& target_entity) {
 
-  Point source = source_entity.get_bounding_box().get_xy();
   Point target = target_entity.get_bounding_box().get_xy();
 
   target.x += 4;
   target.x += -target.x % 8;
   target.y += 4;
   target.y += -target.y % 8;
-  const int target_index = get_square_index(target);
 
   Debug::check_assertion(target.x % 8 == 0 && target.y % 8 == 0,
       "Could not snap the target to the map grid");
 
+  return target;
+}
+
+/**
+ * \brief Returns whether a path between two nodes is searched directly
+ * with A* rather than in the abstract graph of the map.
+ * \param source location of the source node
+ * \param target location of the target node
+ * \return true if the target is close enough for a local search
+ */
+bool PathFinding::is_local_search(const Point& source, const Point& target) {
+
+  return Geometry::get_manhattan_distance(source, target) <= max_local_distance;
+}
+
+/**
+ * \brief Returns the area whose obstacles may change the result of a search.
+ *
+ * A local search only explores nodes close to the target.
+ * A hierarchical search refines a few local searches from the source.
+ *
+ * \param source Location of the source node.
+ * \param target Location of the target node.
+ * \return The area that the search may explore, including the 16x16 boxes
+ * of the nodes.
+ */
+Rectangle PathFinding::get_search_area(const Point& source, const Point& target) {
+
+  if (is_local_search(source, target)) {
+    return Rectangle(
+        target.x - max_local_distance,
+        target.y - max_local_distance,
+        2 * max_local_distance + 16,
+        2 * max_local_distance + 16
+    );
+  }
+
+  const int radius = (max_refined_segments + 1) * max_local_distance;
+  return Rectangle(
+      source.x - radius,
+      source.y - radius,
+      2 * radius + 16,
+      2 * radius + 16
+  );
+}
+
+/**
+ * \brief Returns whether the entity to move can use paths searched
+ * by other entities of its type.
+ * \return \c false if the obstacles of this entity depend on the entity
+ * itself or on the hero.
+ */
+bool PathFinding::can_share_paths() const {
+
+  if (source_entity->get_type() == EntityType::CUSTOM &&
+      static_cast<const CustomEntity&>(*source_entity).has_can_traverse_entities_rules()) {
+    // Its own Lua rules decide what it can traverse.
+    return false;
+  }
+
+  // Obstacle versions ignore the hero.
+  return !map->get_entities().get_hero().is_obstacle_for(*source_entity);
+}
+
+/**
+ * \brief Finds a path to a far target by using the abstract graph of the map.
+ *
+ * Only the first waypoints of the abstract path are refined: entities
+ * recompute their path regularly anyway, and this keeps the cost of a
+ * query bounded.
+ *
+ * \param source Location of the source node.
+ * \param target Location of the target node.
+ * \return The beginning of the path found, or an empty string if no path
+ * was found.
+ */
+std::string PathFinding::compute_hierarchical_path(const Point& source, const Point& target) {
+
+  const Layer layer = source_entity->get_layer();
+  PathFindingGraph& graph = map->get_entities().get_path_finding_graph(
+      layer, PathFindingGraph::get_obstacle_grounds(*source_entity)
+  );
+  const std::vector<Point> waypoints = graph.compute_waypoints(source, target);
+
+  std::string path;
+  Point location = source;
+  int num_segments = 0;
+  size_t i = 0;
+  while (i < waypoints.size() && num_segments < max_refined_segments) {
+
+    // Go as far as possible along the waypoints in one local search.
+    size_t next = i;
+    while (next + 1 < waypoints.size()
+        && Geometry::get_manhattan_distance(location, waypoints[next + 1]) <= max_local_distance) {
+      ++next;
+    }
+
+    const std::string segment = compute_local_path(location, waypoints[next]);
+    if (segment.empty()) {
+      // Obstacles not in the graph block the way.
+      break;
+    }
+    path += segment;
+    location = waypoints[next];
+    i = next + 1;
+    ++num_segments;
+  }
+
+  return path;
+}
+
+/**
+ * \brief Finds a path to a close target with A*.
+ * \param source Location of the source node.
+ * \param target Location of the target node.
+ * \return The path found, or an empty string if no path was found
+ * (because there is no path or the target is too far).
+ */
+std::string PathFinding::compute_local_path(const Point& source, const Point& target) {
+
+  const int target_index = get_square_index(target);
   const int total_mdistance = Geometry::get_manhattan_distance(source, target);
-  if (total_mdistance > 200 || target_entity.get_layer() != source_entity.get_layer()) {
-    //std::cout << "too far, not computing a path\n";
+  if (total_mdistance > max_local_distance) {
     return ""; // too far to compute a path
   }
 
-  std::string path = "";
+  if (source.x < 0 || source.y < 0
+      || source.x >= map_width || source.y >= map_height) {
+    return "";  // outside the map
+  }
+
+  // Start a new search: nodes of previous ones become unvisited.
+  const size_t num_squares = (map_width / 8) * (map_height / 8);
+  if (search.nodes.size() < num_squares) {
+    search.nodes.resize(num_squares);
+    for (Node& node: search.nodes) {
+      node.generation = 0;
+    }
+    search.generation = 0;
+  }
+  ++search.generation;
+  if (search.generation == 0) {
+    // The counter wrapped: really clear the nodes this time.
+    for (Node& node: search.nodes) {
+      node.generation = 0;
+    }
+    search.generation = 1;
+  }
+  search.open_heap.clear();
+  uint32_t num_opened = 0;
 
-  Node starting_node;
-  const int index = get_square_index(source);
-  starting_node.location = source;
-  starting_node.index = index;
+  const int source_index = get_square_index(source);
+  Node& starting_node = search.nodes[source_index];
+  starting_node.generation = search.generation;
+  starting_node.order = num_opened++;
   starting_node.previous_cost = 0;
-  starting_node.heuristic = total_mdistance;
   starting_node.total_cost = total_mdistance;
   starting_node.direction = ' ';
   starting_node.parent_index = -1;
+  push_open_node(source_index);
 
-  open_list[index] = starting_node;
-  open_list_indices.push_front(index);
-
-  bool finished = false;
-  while (!finished) {
+  while (!search.open_heap.empty()) {
 
     // pick the node with the lowest total cost in the open list
-    const int index = open_list_indices.front();
-    Node* current_node = &open_list[index];
-    open_list_indices.pop_front();
-    closed_list[index] = *current_node;
-    open_list.erase(index);
-    current_node = &closed_list[index];
-
-    //std::cout << System::now() << " picking the lowest cost node in the open list ("
-    //  << (open_list_indices.size() + 1) << " elements): "
-    //  << current_node->location << ", index = " << current_node->index
-    //  << ", cost = " << current_node->previous_cost << " + " << current_node->heuristic << "\n";
-
+    const int index = pop_open_node();
     if (index == target_index) {
-      //std::cout << "target node was added to the closed list\n";
-      finished = true;
-      path = rebuild_path(current_node);
-      //std::cout << "rebuild done\n";
+      return rebuild_path(index);
     }
-    else {
-      // look at the accessible nodes from it
-      //std::cout << System::now() << " looking for accessible states\n";
-      for (int i = 0; i < 8; i++) {
-
-        Node new_node;
-        const int immediate_cost = (i & 1) ? 11 : 8;
-        new_node.previous_cost = current_node->previous_cost + immediate_cost;
-        new_node.location = current_node->location;
-        new_node.location += neighbours_locations[i];
-        new_node.index = get_square_index(new_node.location);
-        //std::cout << "  node in direction " << i << ": index = " << new_node.index << std::endl;
-
-        const bool in_closed_list = (closed_list.find(new_node.index) != closed_list.end());
-        if (!in_closed_list && Geometry::get_manhattan_distance(new_node.location, target) < 200
-            && is_node_transition_valid(*current_node, i)) {
-          //std::cout << "  node in direction " << i << " is not in the closed list\n";
-          // not in the closed list: look in the open list
-
-          const bool in_open_list = open_list.find(new_node.index) != open_list.end();
-
-          if (!in_open_list) {
-            // not in the open list: add it
-            new_node.heuristic = Geometry::get_manhattan_distance(new_node.location, target);
-            new_node.total_cost = new_node.previous_cost + new_node.heuristic;
-            new_node.parent_index = index;
-            new_node.direction = '0' + i;
-            open_list[new_node.index] = new_node;
-            add_index_sorted(&open_list[new_node.index]);
-            //std::cout << "  node in direction " << i << " is not in the open list, adding it with cost "
-            //  << new_node.previous_cost << " (" << current_node->previous_cost << " + "
-            //  << immediate_cost << ") + " << new_node.heuristic << " and parent " << new_node.parent_index << "\n";
-          }
-          else {
-            //std::cout << "  node in direction " << i << " is already in the open list\n";
-            Node* existing_node = &open_list[new_node.index];
-            // already in the open list: see if the current path is better
-            if (new_node.previous_cost < existing_node->previous_cost) {
-              existing_node->previous_cost = new_node.previous_cost;
-              existing_node->total_cost = existing_node->previous_cost + existing_node->heuristic;
-              existing_node->parent_index = index;
-              open_list_indices.sort();
-            }
-          }
-        }
-        else {
-          //std::cout << "skipping node in direction " << i << ": already in closed list = "
-          //  << in_closed_list << ", too far from target = "
-          //  << (get_manhattan_distance(new_node.location, target) >= 200) << ", invalid transition = "
-          //  << (!is_node_transition_valid(*current_node, i)) << std::endl;
-        }
+
+    // look at the accessible nodes from it
+    const Point location = get_square_location(index);
+    const int previous_cost = search.nodes[index].previous_cost;
+    for (int i = 0; i < 8; i++) {
+
+      const Point new_location = location + neighbours_locations[i];
+      if (new_location.x < 0 || new_location.y < 0
+          || new_location.x >= map_width || new_location.y >= map_height) {
+        continue;
+      }
+
+      const int new_index = get_square_index(new_location);
+      Node& new_node = search.nodes[new_index];
+      const bool visited = new_node.generation == search.generation;
+      if (visited && new_node.heap_position == -1) {
+        // already in the closed list
+        continue;
+      }
+
+      const int heuristic = Geometry::get_manhattan_distance(new_location, target);
+      if (heuristic >= max_local_distance || !is_node_transition_valid(location, i)) {
+        continue;
+      }
+
+      const int immediate_cost = (i & 1) ? 11 : 8;
+      const int new_previous_cost = previous_cost + immediate_cost;
+      if (!visited) {
+        // not in the open list: add it
+        new_node.generation = search.generation;
+        new_node.order = num_opened++;
+        new_node.previous_cost = new_previous_cost;
+        new_node.total_cost = new_previous_cost + heuristic;
+        new_node.parent_index = index;
+        new_node.direction = '0' + i;
+        push_open_node(new_index);
       }
-      if (open_list_indices.empty()) {
-        finished = true;
+      else if (new_previous_cost < new_node.previous_cost) {
+        // already in the open list: the current path is better
+        new_node.previous_cost = new_previous_cost;
+        new_node.total_cost = new_previous_cost + heuristic;
+        new_node.parent_index = index;
+        new_node.direction = '0' + i;
+        move_up_open_node(new_index);
       }
     }
   }
 
-  //std::cout << "path found: " << path << ", open nodes: " << open_list.size() << ", closed nodes: " << closed_list.size() << std::endl;
-  return path;
+  return "";
 }
 
 /**
@@ -201,72 +412,166 @@ int PathFinding::get_square_index(const Point& location) const {
 
   const int x8 = location.x / 8;
   const int y8 = location.y / 8;
-  return y8 * map.get_width8() + x8;
+  return y8 * (map_width / 8) + x8;
 }
 
 /**
- * \brief Compares two nodes according to their total estimated cost.
- * \param other the other node
+ * \brief Returns the location of a node from the index of its 8*8 square.
+ * \param index index of a square on the map
+ * \return location of the node with this index
  */
-bool PathFinding::Node::operator<(const Node& other) const {
-  return total_cost < other.total_cost;
+Point PathFinding::get_square_location(int index) const {
+
+  const int width8 = map_width / 8;
+  return { (index % width8) * 8, (index / width8) * 8 };
 }
 
 /**
- * \brief Adds the index of a node to the sorted list of indices of the open
- * list, making sure that the list remains sorted.
- * \param node The node.
+ * \brief Returns whether an open node should be explored before another one.
+ *
+ * Nodes with the lowest total cost go first.
+ * On equal costs, the most recently opened node goes first.
+ *
+ * \param index1 index of a node in the open list
+ * \param index2 index of another node in the open list
+ * \return true if the first node has a higher priority
  */
-void PathFinding::add_index_sorted(Node* node) {
-
-  bool inserted = false;
-  for (auto it = open_list_indices.begin();
-      it != open_list_indices.end() && !inserted;
-      ++it) {
-    const int index = *it;
-    const Node* current_node = &open_list[index];
-    if (current_node->total_cost >= node->total_cost) {
-      open_list_indices.insert(it, node->index);
-      inserted = true;
+bool PathFinding::is_before(int index1, int index2) const {
+
+  const Node& node1 = search.nodes[index1];
+  const Node& node2 = search.nodes[index2];
+  if (node1.total_cost != node2.total_cost) {
+    return node1.total_cost < node2.total_cost;
+  }
+  return node1.order > node2.order;
+}
+
+/**
+ * \brief Adds a node to the open heap.
+ * \param index index of the node
+ */
+void PathFinding::push_open_node(int index) {
+
+  search.open_heap.push_back(index);
+  search.nodes[index].heap_position = search.open_heap.size() - 1;
+  move_up_open_node(index);
+}
+
+/**
+ * \brief Removes the node with the highest priority from the open heap
+ * and puts it in the closed list.
+ * \return index of this node
+ */
+int PathFinding::pop_open_node() {
+
+  std::vector<int>& heap = search.open_heap;
+  const int index = heap.front();
+  search.nodes[index].heap_position = -1;
+
+  const int last_index = heap.back();
+  heap.pop_back();
+  if (!heap.empty()) {
+    set_heap_position(0, last_index);
+    move_down_open_node(last_index);
+  }
+  return index;
+}
+
+/**
+ * \brief Moves a node towards the top of the open heap until
+ * its parent has a higher priority.
+ *
+ * This is called when a node is added or when its cost decreases.
+ *
+ * \param index index of the node
+ */
+void PathFinding::move_up_open_node(int index) {
+
+  int position = search.nodes[index].heap_position;
+  while (position > 0) {
+    const int parent_position = (position - 1) / 2;
+    const int parent_index = search.open_heap[parent_position];
+    if (!is_before(index, parent_index)) {
+      break;
     }
+    set_heap_position(position, parent_index);
+    position = parent_position;
   }
+  set_heap_position(position, index);
+}
 
-  if (!inserted) {
-    open_list_indices.push_back(node->index);
+/**
+ * \brief Moves a node towards the bottom of the open heap until
+ * its children have a lower priority.
+ * \param index index of the node
+ */
+void PathFinding::move_down_open_node(int index) {
+
+  const int size = search.open_heap.size();
+  int position = search.nodes[index].heap_position;
+  while (true) {
+    int child_position = 2 * position + 1;
+    if (child_position >= size) {
+      break;
+    }
+    if (child_position + 1 < size
+        && is_before(search.open_heap[child_position + 1], search.open_heap[child_position])) {
+      ++child_position;
+    }
+    const int child_index = search.open_heap[child_position];
+    if (!is_before(child_index, index)) {
+      break;
+    }
+    set_heap_position(position, child_index);
+    position = child_position;
   }
+  set_heap_position(position, index);
+}
+
+/**
+ * \brief Puts a node at a position of the open heap.
+ * \param position position in the heap
+ * \param index index of the node
+ */
+void PathFinding::set_heap_position(int position, int index) {
+
+  search.open_heap[position] = index;
+  search.nodes[index].heap_position = position;
 }
 
 /**
  * \brief Builds the string representation of the path found by the algorithm.
- * \param closed_list The closed list of A*.
- * \return final_node The final node of the path.
+ * \param final_index Index of the final node of the path.
+ * \return The path.
  */
-std::string PathFinding::rebuild_path(const Node* final_node) {
-
-  const Node* current_node = final_node;
-  std::string path = "";
-  while (current_node->direction != ' ') {
-    path = current_node->direction + path;
-    current_node = &closed_list[current_node->parent_index];
-    //std::cout << "current_node: " << current_node->index << ", path = " << path << std::endl;
+std::string PathFinding::rebuild_path(int final_index) const {
+
+  std::string path;
+  int index = final_index;
+  while (search.nodes[index].direction != ' ') {
+    path += search.nodes[index].direction;
+    index = search.nodes[index].parent_index;
   }
-  return path;
+  return std::string(path.rbegin(), path.rend());
 }
 
 /**
  * \brief Returns whether a transition between two nodes is valid, i.e.
  * whether there is no collision with the map.
- * \param initial_node the first node
+ * \param location location of the first node
  * \param direction the direction to take (0 to 7)
  * \return true if there is no collision for this transition
  */
 bool PathFinding::is_node_transition_valid(
-    const Node& initial_node, int direction) const {
+    const Point& location, int direction) const {
 
   Rectangle collision_box = transition_collision_boxes[direction];
-  collision_box.add_xy(initial_node.location);
+  collision_box.add_xy(location);
 
-  return !map.test_collision_with_obstacles(source_entity.get_layer(), collision_box, source_entity);
+  if (snapshot != nullptr) {
+    return !snapshot->test_collision_with_obstacles(collision_box);
+  }
+  return !map->test_collision_with_obstacles(source_entity->get_layer(), collision_box, *source_entity);
 }
 
 }
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/movements/PathFindingCache.h"
+#include "solarus/lowlevel/System.h"
+#include <tuple>
+
+namespace Solarus {
+
+/**
+ * \brief Compares two keys.
+ * \param other Another key.
+ * \return \c true if this key is before the other one.
+ */
+bool PathFindingCache::Key::operator<(const Key& other) const {
+
+  return std::tie(layer, source_type, obstacle_grounds, obstacle_version, terrain_version,
+                  source.x, source.y, target.x, target.y)
+      < std::tie(other.layer, other.source_type, other.obstacle_grounds, other.obstacle_version,
+                 other.terrain_version, other.source.x, other.source.y, other.target.x, other.target.y);
+}
+
+/**
+ * \brief Creates an empty cache.
+ */
+PathFindingCache::PathFindingCache():
+  entries(),
+  entries_by_key(),
+  num_hits(0),
+  num_misses(0) {
+
+}
+
+/**
+ * \brief Looks for a path searched recently.
+ * \param key What the path depends on.
+ * \param[out] path The path if found. It may be empty if the search did not
+ * find any path.
+ * \return \c true if the path was found in the cache.
+ */
+bool PathFindingCache::find_path(const Key& key, std::string& path) {
+
+  const auto it = entries_by_key.find(key);
+  if (it == entries_by_key.end()) {
+    ++num_misses;
+    return false;
+  }
+
+  const std::list<Entry>::iterator entry = it->second;
+  if (System::now() - entry->date >= max_age) {
+    // Too old: some obstacles may have changed without being noticed.
+    entries.erase(entry);
+    entries_by_key.erase(it);
+    ++num_misses;
+    return false;
+  }
+
+  // Move the entry to the front.
+  entries.splice(entries.begin(), entries, entry);
+  path = entry->path;
+  ++num_hits;
+  return true;
+}
+
+/**
+ * \brief Stores the result of a search.
+ * \param key What the path depends on.
+ * \param path The path found, or an empty string if there was no path.
+ */
+void PathFindingCache::add_path(const Key& key, const std::string& path) {
+
+  const auto it = entries_by_key.find(key);
+  if (it != entries_by_key.end()) {
+    entries.erase(it->second);
+    entries_by_key.erase(it);
+  }
+
+  entries.push_front({ key, path, System::now() });
+  entries_by_key[key] = entries.begin();
+
+  if (entries.size() > capacity) {
+    // Forget the least recently used path.
+    entries_by_key.erase(entries.back().key);
+    entries.pop_back();
+  }
+}
+
+/**
+ * \brief Returns how many searches were avoided thanks to the cache.
+ * \return The number of paths found in the cache.
+ */
+uint64_t PathFindingCache::get_num_hits() const {
+  return num_hits;
+}
+
+/**
+ * \brief Returns how many searches could not be avoided.
+ * \return The number of paths not found in the cache.
+ */
+uint64_t PathFindingCache::get_num_misses() const {
+  return num_misses;
+}
+
+}
+
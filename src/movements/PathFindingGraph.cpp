@@ -0,0 +1,705 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/movements/PathFindingGraph.h"
+#include "solarus/entities/Entity.h"
+#include "solarus/entities/GroundBitmaps.h"
+#include "solarus/entities/MapEntities.h"
+#include "solarus/lowlevel/Debug.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace Solarus {
+
+namespace {
+
+constexpr int infinite_cost = std::numeric_limits<int>::max();
+
+/**
+ * \brief Bits of the grounds that are obstacles for every entity
+ * as far as the graph is concerned.
+ */
+const uint32_t always_obstacle_grounds =
+    GroundBitmaps::get_ground_bit(Ground::WALL)
+    | GroundBitmaps::get_ground_bit(Ground::WALL_TOP_RIGHT)
+    | GroundBitmaps::get_ground_bit(Ground::WALL_TOP_LEFT)
+    | GroundBitmaps::get_ground_bit(Ground::WALL_BOTTOM_LEFT)
+    | GroundBitmaps::get_ground_bit(Ground::WALL_BOTTOM_RIGHT)
+    | GroundBitmaps::get_ground_bit(Ground::WALL_TOP_RIGHT_WATER)
+    | GroundBitmaps::get_ground_bit(Ground::WALL_TOP_LEFT_WATER)
+    | GroundBitmaps::get_ground_bit(Ground::WALL_BOTTOM_LEFT_WATER)
+    | GroundBitmaps::get_ground_bit(Ground::WALL_BOTTOM_RIGHT_WATER);
+
+}
+
+/**
+ * \brief Creates the graph of a map layer.
+ *
+ * All clusters are dirty at first: the graph is built by the first query.
+ *
+ * \param entities The entities of the map.
+ * \param layer The layer to represent.
+ * \param obstacle_grounds Bits of the grounds that are obstacles
+ * (see get_obstacle_grounds()).
+ * \param width8 Number of 8x8 squares on a row of the map.
+ * \param height8 Number of 8x8 squares on a column of the map.
+ */
+PathFindingGraph::PathFindingGraph(
+    MapEntities& entities,
+    Layer layer,
+    uint32_t obstacle_grounds,
+    int width8,
+    int height8):
+  entities(entities),
+  layer(layer),
+  obstacle_grounds(obstacle_grounds),
+  width8(width8),
+  height8(height8),
+  num_clusters_x((width8 + cluster_size8 - 1) / cluster_size8),
+  num_clusters_y((height8 + cluster_size8 - 1) / cluster_size8),
+  dirty(true),
+  terrain_version(0),
+  free_squares(width8 * height8, false),
+  clusters(num_clusters_x * num_clusters_y) {
+
+  for (const Entity* ground_modifier: entities.get_ground_modifiers(layer)) {
+    ground_modifier_boxes[ground_modifier] = ground_modifier->get_bounding_box();
+  }
+}
+
+/**
+ * \brief Returns the layer represented by this graph.
+ * \return The layer.
+ */
+Layer PathFindingGraph::get_layer() const {
+  return layer;
+}
+
+/**
+ * \brief Returns the grounds considered as obstacles in this graph.
+ * \return Bits of the obstacle grounds (see GroundBitmaps::get_ground_bit()).
+ */
+uint32_t PathFindingGraph::get_obstacle_grounds() const {
+  return obstacle_grounds;
+}
+
+/**
+ * \brief Returns the grounds that are obstacles for an entity.
+ *
+ * Entities with the same obstacle grounds can share the same graph.
+ *
+ * \param entity An entity.
+ * \return Bits of the obstacle grounds (see GroundBitmaps::get_ground_bit()).
+ */
+uint32_t PathFindingGraph::get_obstacle_grounds(const Entity& entity) {
+
+  const Ground conditional_grounds[] = {
+      Ground::LOW_WALL,
+      Ground::SHALLOW_WATER,
+      Ground::DEEP_WATER,
+      Ground::HOLE,
+      Ground::LAVA,
+      Ground::PRICKLE,
+      Ground::LADDER
+  };
+
+  uint32_t grounds = always_obstacle_grounds;
+  for (Ground ground: conditional_grounds) {
+    if (entity.is_ground_obstacle(ground)) {
+      grounds |= GroundBitmaps::get_ground_bit(ground);
+    }
+  }
+  return grounds;
+}
+
+/**
+ * \brief Returns a number that changes whenever the terrain of the graph
+ * changes.
+ * \return The terrain version.
+ */
+uint32_t PathFindingGraph::get_terrain_version() const {
+  return terrain_version;
+}
+
+/**
+ * \brief Notifies the graph that the ground has changed in an area.
+ * \param area The rectangle whose ground has changed, in pixels.
+ */
+void PathFindingGraph::notify_ground_changed(const Rectangle& area) {
+  set_dirty(area);
+}
+
+/**
+ * \brief Notifies the graph that a dynamic entity that modifies the ground
+ * has been added, moved or removed.
+ * \param ground_modifier The entity.
+ * \param present \c false if it is no longer a ground modifier of the layer.
+ */
+void PathFindingGraph::notify_ground_modifier_changed(
+    const Entity& ground_modifier, bool present) {
+
+  const auto it = ground_modifier_boxes.find(&ground_modifier);
+  if (it != ground_modifier_boxes.end()) {
+    set_dirty(it->second);
+    if (!present) {
+      ground_modifier_boxes.erase(it);
+    }
+  }
+
+  if (present) {
+    const Rectangle& box = ground_modifier.get_bounding_box();
+    set_dirty(box);
+    ground_modifier_boxes[&ground_modifier] = box;
+  }
+}
+
+/**
+ * \brief Marks the clusters depending on the ground of an area as dirty.
+ * \param area A rectangle in pixels.
+ */
+void PathFindingGraph::set_dirty(const Rectangle& area) {
+
+  if (area.is_flat()) {
+    return;
+  }
+
+  // A node also covers the squares on its right and below,
+  // so the cluster on the left and above depend on this area too.
+  const int x8_min = std::max(area.get_x() / 8 - 1, 0);
+  const int y8_min = std::max(area.get_y() / 8 - 1, 0);
+  const int x8_max = std::min((area.get_x() + area.get_width() - 1) / 8, width8 - 1);
+  const int y8_max = std::min((area.get_y() + area.get_height() - 1) / 8, height8 - 1);
+  if (x8_min > x8_max || y8_min > y8_max) {
+    // Outside the map.
+    return;
+  }
+
+  for (int cy = y8_min / cluster_size8; cy <= y8_max / cluster_size8; ++cy) {
+    for (int cx = x8_min / cluster_size8; cx <= x8_max / cluster_size8; ++cx) {
+      clusters[cy * num_clusters_x + cx].dirty = true;
+      dirty = true;
+    }
+  }
+  ++terrain_version;
+}
+
+/**
+ * \brief Rebuilds the dirty clusters and their neighbors.
+ *
+ * compute_waypoints() does it automatically.
+ * Call this function before is_node_free() and is_transition_free()
+ * to get the current terrain.
+ */
+void PathFindingGraph::update() {
+
+  if (!dirty) {
+    return;
+  }
+
+  const int num_clusters = clusters.size();
+  std::vector<bool> crossings_to_update(num_clusters * 2, false);
+  std::vector<bool> edges_to_update(num_clusters, false);
+
+  for (int i = 0; i < num_clusters; ++i) {
+
+    if (!clusters[i].dirty) {
+      continue;
+    }
+    update_free_squares(i);
+
+    // The borders of this cluster change, and so do
+    // the entrances of its neighbors.
+    const int cx = i % num_clusters_x;
+    const int cy = i / num_clusters_x;
+    crossings_to_update[i * 2] = true;
+    crossings_to_update[i * 2 + 1] = true;
+    edges_to_update[i] = true;
+    if (cx > 0) {
+      crossings_to_update[(i - 1) * 2] = true;
+      edges_to_update[i - 1] = true;
+    }
+    if (cy > 0) {
+      crossings_to_update[(i - num_clusters_x) * 2 + 1] = true;
+      edges_to_update[i - num_clusters_x] = true;
+    }
+    if (cx < num_clusters_x - 1) {
+      edges_to_update[i + 1] = true;
+    }
+    if (cy < num_clusters_y - 1) {
+      edges_to_update[i + num_clusters_x] = true;
+    }
+    clusters[i].dirty = false;
+  }
+
+  for (int i = 0; i < num_clusters; ++i) {
+    if (crossings_to_update[i * 2]) {
+      update_crossings(i, true);
+    }
+    if (crossings_to_update[i * 2 + 1]) {
+      update_crossings(i, false);
+    }
+  }
+
+  for (int i = 0; i < num_clusters; ++i) {
+    if (edges_to_update[i]) {
+      update_edges(i);
+    }
+  }
+
+  dirty = false;
+}
+
+/**
+ * \brief Computes which squares of a cluster are free of obstacle ground.
+ * \param cluster_index Index of the cluster.
+ */
+void PathFindingGraph::update_free_squares(int cluster_index) {
+
+  const int x8_min = (cluster_index % num_clusters_x) * cluster_size8;
+  const int y8_min = (cluster_index / num_clusters_x) * cluster_size8;
+  const int x8_max = std::min(x8_min + cluster_size8, width8) - 1;
+  const int y8_max = std::min(y8_min + cluster_size8, height8) - 1;
+
+  for (int y8 = y8_min; y8 <= y8_max; ++y8) {
+    for (int x8 = x8_min; x8 <= x8_max; ++x8) {
+      const Ground ground = entities.get_tile_ground(layer, x8 * 8, y8 * 8);
+      free_squares[y8 * width8 + x8] =
+          (obstacle_grounds & GroundBitmaps::get_ground_bit(ground)) == 0;
+    }
+  }
+
+  // Dynamic entities that change the ground hide the tiles.
+  // The last ones are above the others.
+  const Rectangle cluster_box(
+      x8_min * 8, y8_min * 8, (x8_max - x8_min + 1) * 8, (y8_max - y8_min + 1) * 8
+  );
+  for (const Entity* ground_modifier: entities.get_ground_modifiers(layer)) {
+
+    const Ground ground = ground_modifier->get_modified_ground();
+    if (ground == Ground::EMPTY
+        || !ground_modifier->is_enabled()
+        || ground_modifier->is_being_removed()) {
+      continue;
+    }
+
+    const Rectangle box = ground_modifier->get_bounding_box() & cluster_box;
+    if (box.is_flat()) {
+      continue;
+    }
+
+    const bool obstacle = (obstacle_grounds & GroundBitmaps::get_ground_bit(ground)) != 0;
+    for (int y8 = box.get_y() / 8; y8 <= (box.get_y() + box.get_height() - 1) / 8; ++y8) {
+      for (int x8 = box.get_x() / 8; x8 <= (box.get_x() + box.get_width() - 1) / 8; ++x8) {
+        const Rectangle square(x8 * 8, y8 * 8, 8, 8);
+        const bool covered = (box & square) == square;
+        const int index = y8 * width8 + x8;
+        if (covered) {
+          free_squares[index] = !obstacle;
+        }
+        else if (obstacle) {
+          free_squares[index] = false;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * \brief Computes the crossings between a cluster and its right or bottom
+ * neighbor.
+ *
+ * Along the border, each run of consecutive places where the crossing is
+ * possible gives one crossing in its middle, or two at its ends if it is
+ * long.
+ *
+ * \param cluster_index Index of the cluster.
+ * \param right \c true for the border with the right neighbor,
+ * \c false for the bottom one.
+ */
+void PathFindingGraph::update_crossings(int cluster_index, bool right) {
+
+  Cluster& cluster = clusters[cluster_index];
+  std::vector<Crossing>& crossings = right ? cluster.right_crossings : cluster.bottom_crossings;
+  crossings.clear();
+
+  const int cx = cluster_index % num_clusters_x;
+  const int cy = cluster_index / num_clusters_x;
+
+  // Position of the first node after the border and range of nodes along it.
+  // Nodes cover 2x2 squares, so the last node of a row or column is at size - 2.
+  const int border = right ? (cx + 1) * cluster_size8 : (cy + 1) * cluster_size8;
+  const int first = right ? cy * cluster_size8 : cx * cluster_size8;
+  const int last = std::min(first + cluster_size8, right ? height8 - 1 : width8 - 1) - 1;
+  if (border > (right ? width8 : height8) - 2) {
+    // No neighbor on this side.
+    return;
+  }
+
+  const auto get_node = [&](int along, int across) {
+    return right ? along * width8 + across : across * width8 + along;
+  };
+  const auto is_crossing_free = [&](int along) {
+    return right ?
+        is_transition_free(border - 1, along, 1, 0) :
+        is_transition_free(along, border - 1, 0, 1);
+  };
+  const auto add_crossing = [&](int along) {
+    crossings.push_back({ get_node(along, border - 1), get_node(along, border) });
+  };
+
+  int run_start = -1;
+  for (int along = first; along <= last + 1; ++along) {
+    const bool free = along <= last && is_crossing_free(along);
+    if (free && run_start == -1) {
+      run_start = along;
+    }
+    else if (!free && run_start != -1) {
+      const int run_end = along - 1;
+      if (run_end - run_start + 1 >= 6) {
+        add_crossing(run_start);
+        add_crossing(run_end);
+      }
+      else {
+        add_crossing((run_start + run_end) / 2);
+      }
+      run_start = -1;
+    }
+  }
+}
+
+/**
+ * \brief Computes the entrances of a cluster and the edges between them.
+ * \param cluster_index Index of the cluster.
+ */
+void PathFindingGraph::update_edges(int cluster_index) {
+
+  Cluster& cluster = clusters[cluster_index];
+  const int cx = cluster_index % num_clusters_x;
+  const int cy = cluster_index / num_clusters_x;
+
+  // Gather the crossings of the four borders with the node on our side.
+  std::vector<std::pair<int, int>> crossings;  // Our node, the other node.
+  for (const Crossing& crossing: cluster.right_crossings) {
+    crossings.emplace_back(crossing.node1, crossing.node2);
+  }
+  for (const Crossing& crossing: cluster.bottom_crossings) {
+    crossings.emplace_back(crossing.node1, crossing.node2);
+  }
+  if (cx > 0) {
+    for (const Crossing& crossing: clusters[cluster_index - 1].right_crossings) {
+      crossings.emplace_back(crossing.node2, crossing.node1);
+    }
+  }
+  if (cy > 0) {
+    for (const Crossing& crossing: clusters[cluster_index - num_clusters_x].bottom_crossings) {
+      crossings.emplace_back(crossing.node2, crossing.node1);
+    }
+  }
+
+  cluster.entrances.clear();
+  cluster.edges.clear();
+  for (const std::pair<int, int>& crossing: crossings) {
+    auto it = std::find(cluster.entrances.begin(), cluster.entrances.end(), crossing.first);
+    if (it == cluster.entrances.end()) {
+      cluster.entrances.push_back(crossing.first);
+      cluster.edges.emplace_back();
+      it = cluster.entrances.end() - 1;
+    }
+    cluster.edges[it - cluster.entrances.begin()].push_back({ crossing.second, 8 });
+  }
+
+  // Costs between entrances inside the cluster.
+  std::vector<int> costs;
+  for (size_t i = 0; i < cluster.entrances.size(); ++i) {
+    search_cluster(cluster_index, cluster.entrances[i], costs);
+    for (size_t j = 0; j < cluster.entrances.size(); ++j) {
+      const int cost = costs[get_local_index(cluster_index, cluster.entrances[j])];
+      if (j != i && cost != infinite_cost) {
+        cluster.edges[i].push_back({ cluster.entrances[j], cost });
+      }
+    }
+  }
+}
+
+/**
+ * \brief Computes the cost of the best path from a node to every node of
+ * a cluster, staying inside the cluster.
+ * \param cluster_index Index of the cluster.
+ * \param start_node Square index of the starting node, in the cluster.
+ * \param[out] costs Cost to each node of the cluster by local index,
+ * or infinite_cost if a node cannot be reached.
+ */
+void PathFindingGraph::search_cluster(
+    int cluster_index, int start_node, std::vector<int>& costs) const {
+
+  costs.assign(cluster_size8 * cluster_size8, infinite_cost);
+
+  const int x8_min = (cluster_index % num_clusters_x) * cluster_size8;
+  const int y8_min = (cluster_index / num_clusters_x) * cluster_size8;
+  const int x8_max = std::min(x8_min + cluster_size8, width8 - 1) - 1;
+  const int y8_max = std::min(y8_min + cluster_size8, height8 - 1) - 1;
+
+  if (!is_node_free(start_node % width8, start_node / width8)) {
+    return;
+  }
+
+  using QueueElement = std::pair<int, int>;  // Cost, node.
+  std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> queue;
+  costs[get_local_index(cluster_index, start_node)] = 0;
+  queue.emplace(0, start_node);
+
+  while (!queue.empty()) {
+
+    const int cost = queue.top().first;
+    const int node = queue.top().second;
+    queue.pop();
+    if (cost > costs[get_local_index(cluster_index, node)]) {
+      continue;  // Already reached with a lower cost.
+    }
+
+    const int x8 = node % width8;
+    const int y8 = node / width8;
+    for (int dy8 = -1; dy8 <= 1; ++dy8) {
+      for (int dx8 = -1; dx8 <= 1; ++dx8) {
+        const int new_x8 = x8 + dx8;
+        const int new_y8 = y8 + dy8;
+        if ((dx8 == 0 && dy8 == 0)
+            || new_x8 < x8_min || new_x8 > x8_max
+            || new_y8 < y8_min || new_y8 > y8_max
+            || !is_transition_free(x8, y8, dx8, dy8)) {
+          continue;
+        }
+        const int new_node = new_y8 * width8 + new_x8;
+        const int new_cost = cost + ((dx8 != 0 && dy8 != 0) ? 11 : 8);
+        int& best_cost = costs[get_local_index(cluster_index, new_node)];
+        if (new_cost < best_cost) {
+          best_cost = new_cost;
+          queue.emplace(new_cost, new_node);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * \brief Searches a path in the abstract graph.
+ *
+ * The result is a sequence of node locations that can each be reached from
+ * the previous one by a short path, to be refined by the usual A* algorithm.
+ *
+ * \param source Location of the starting node (aligned to the 8x8 grid).
+ * \param target Location of the target node (aligned to the 8x8 grid).
+ * \return The locations of the nodes to go through, ending with the target
+ * and not including the source, or an empty vector if no path was found.
+ */
+std::vector<Point> PathFindingGraph::compute_waypoints(
+    const Point& source, const Point& target) {
+
+  std::vector<Point> waypoints;
+
+  const auto is_in_grid = [&](const Point& location) {
+    return location.x >= 0 && location.y >= 0
+        && location.x / 8 <= width8 - 2 && location.y / 8 <= height8 - 2;
+  };
+  if (!is_in_grid(source) || !is_in_grid(target)) {
+    return waypoints;
+  }
+
+  update();
+
+  const int source_node = (source.y / 8) * width8 + source.x / 8;
+  const int target_node = (target.y / 8) * width8 + target.x / 8;
+  const int source_cluster = get_cluster_index(source_node);
+  const int target_cluster = get_cluster_index(target_node);
+
+  // Connect the source and the target to the entrances of their clusters.
+  std::vector<int> source_costs;
+  std::vector<int> target_costs;
+  search_cluster(source_cluster, source_node, source_costs);
+  search_cluster(target_cluster, target_node, target_costs);
+
+  const auto get_edges = [&](int node, std::vector<Edge>& edges) {
+    edges.clear();
+    const int cluster_index = get_cluster_index(node);
+    const Cluster& cluster = clusters[cluster_index];
+    if (node == source_node) {
+      for (int entrance: cluster.entrances) {
+        const int cost = source_costs[get_local_index(cluster_index, entrance)];
+        if (cost != infinite_cost) {
+          edges.push_back({ entrance, cost });
+        }
+      }
+    }
+    const auto it = std::find(cluster.entrances.begin(), cluster.entrances.end(), node);
+    if (it != cluster.entrances.end()) {
+      const std::vector<Edge>& entrance_edges = cluster.edges[it - cluster.entrances.begin()];
+      edges.insert(edges.end(), entrance_edges.begin(), entrance_edges.end());
+    }
+    if (cluster_index == target_cluster) {
+      const int cost = target_costs[get_local_index(cluster_index, node)];
+      if (cost != infinite_cost) {
+        edges.push_back({ target_node, cost });
+      }
+    }
+  };
+
+  // A* on the abstract graph.
+  struct Record {
+    int cost;
+    int parent;
+    bool closed;
+  };
+  std::unordered_map<int, Record> records;
+  using QueueElement = std::pair<int, int>;  // Total cost, node.
+  std::priority_queue<QueueElement, std::vector<QueueElement>, std::greater<QueueElement>> open_list;
+
+  records[source_node] = { 0, -1, false };
+  open_list.emplace(get_heuristic(source_node, target_node), source_node);
+
+  std::vector<Edge> edges;
+  bool found = false;
+  while (!open_list.empty() && !found) {
+
+    const int node = open_list.top().second;
+    open_list.pop();
+    Record& record = records[node];
+    if (record.closed) {
+      continue;
+    }
+    record.closed = true;
+    if (node == target_node) {
+      found = true;
+      break;
+    }
+
+    const int cost = record.cost;
+    get_edges(node, edges);
+    for (const Edge& edge: edges) {
+      const int new_cost = cost + edge.cost;
+      const auto it = records.find(edge.node);
+      if (it == records.end() || (!it->second.closed && new_cost < it->second.cost)) {
+        records[edge.node] = { new_cost, node, false };
+        open_list.emplace(new_cost + get_heuristic(edge.node, target_node), edge.node);
+      }
+    }
+  }
+
+  if (!found) {
+    return waypoints;
+  }
+
+  for (int node = target_node; node != source_node; node = records[node].parent) {
+    waypoints.emplace_back((node % width8) * 8, (node / width8) * 8);
+  }
+  std::reverse(waypoints.begin(), waypoints.end());
+  return waypoints;
+}
+
+/**
+ * \brief Returns the cluster of a node.
+ * \param node Square index of the node.
+ * \return Index of the cluster containing its top-left square.
+ */
+int PathFindingGraph::get_cluster_index(int node) const {
+
+  const int x8 = node % width8;
+  const int y8 = node / width8;
+  return (y8 / cluster_size8) * num_clusters_x + x8 / cluster_size8;
+}
+
+/**
+ * \brief Returns the index of a node relative to its cluster.
+ * \param cluster_index Index of the cluster containing the node.
+ * \param node Square index of the node.
+ * \return Index of the node in the cluster, row by row.
+ */
+int PathFindingGraph::get_local_index(int cluster_index, int node) const {
+
+  const int x8 = node % width8 - (cluster_index % num_clusters_x) * cluster_size8;
+  const int y8 = node / width8 - (cluster_index / num_clusters_x) * cluster_size8;
+  return y8 * cluster_size8 + x8;
+}
+
+/**
+ * \brief Returns whether an 8x8 square has no obstacle ground.
+ * \param x8 X coordinate of the square.
+ * \param y8 Y coordinate of the square.
+ * \return \c true if the square is free.
+ */
+bool PathFindingGraph::is_square_free(int x8, int y8) const {
+
+  return x8 >= 0 && x8 < width8 && y8 >= 0 && y8 < height8
+      && free_squares[y8 * width8 + x8];
+}
+
+/**
+ * \brief Returns whether a 16x16 node has no obstacle ground.
+ * \param x8 X coordinate of the top-left square of the node.
+ * \param y8 Y coordinate of the top-left square of the node.
+ * \return \c true if the node is free.
+ */
+bool PathFindingGraph::is_node_free(int x8, int y8) const {
+  return is_transition_free(x8, y8, 0, 0);
+}
+
+/**
+ * \brief Returns whether a 16x16 node can move to a neighbor one,
+ * that is, whether all squares covered during the move are free.
+ * \param x8 X coordinate of the top-left square of the initial node.
+ * \param y8 Y coordinate of the top-left square of the initial node.
+ * \param dx8 Move on x: -1, 0 or 1.
+ * \param dy8 Move on y: -1, 0 or 1.
+ * \return \c true if the transition is possible.
+ */
+bool PathFindingGraph::is_transition_free(int x8, int y8, int dx8, int dy8) const {
+
+  const int x8_min = std::min(x8, x8 + dx8);
+  const int y8_min = std::min(y8, y8 + dy8);
+  const int x8_max = std::max(x8, x8 + dx8) + 1;
+  const int y8_max = std::max(y8, y8 + dy8) + 1;
+  for (int j = y8_min; j <= y8_max; ++j) {
+    for (int i = x8_min; i <= x8_max; ++i) {
+      if (!is_square_free(i, j)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * \brief Estimates the cost between two nodes.
+ *
+ * This is the cost without obstacles, so the estimation is never too high.
+ *
+ * \param node1 Square index of a node.
+ * \param node2 Square index of another node.
+ * \return The estimated cost.
+ */
+int PathFindingGraph::get_heuristic(int node1, int node2) const {
+
+  const int dx8 = std::abs(node1 % width8 - node2 % width8);
+  const int dy8 = std::abs(node1 / width8 - node2 / width8);
+  return 8 * std::max(dx8, dy8) + 3 * std::min(dx8, dy8);
+}
+
+}
+
@@ -16,11 +16,17 @@
  */
 #include "solarus/movements/PathFindingMovement.h"
 #include "solarus/movements/PathFinding.h"
+#include "solarus/movements/FlowField.h"
+#include "solarus/movements/PathFindingGraph.h"
+#include "solarus/movements/PathFindingSnapshot.h"
 #include "solarus/lua/LuaContext.h"
 #include "solarus/entities/Entity.h"
+#include "solarus/entities/MapEntities.h"
 #include "solarus/lowlevel/Random.h"
 #include "solarus/lowlevel/System.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Geometry.h"
+#include "solarus/Map.h"
 
 namespace Solarus {
 
@@ -31,7 +37,10 @@ namespace Solarus {
 PathFindingMovement::PathFindingMovement(int speed):
   PathMovement("", speed, false, false, true),
   target(),
-  next_recomputation_date(0) {
+  next_recomputation_date(0),
+  flow_field_enabled(false),
+  path_end(-1, -1),
+  path_request() {
 
 }
 
@@ -42,6 +51,27 @@ void PathFindingMovement::set_target(const EntityPtr& target) {
 
   this->target = target;
   next_recomputation_date = System::now() + 100;
+  path_request = nullptr;
+}
+
+/**
+ * \brief Returns whether the path is read from a shared flow field.
+ * \return \c true if the flow field is used instead of A*.
+ */
+bool PathFindingMovement::is_flow_field_enabled() const {
+  return flow_field_enabled;
+}
+
+/**
+ * \brief Sets whether the path is read from a shared flow field.
+ *
+ * The flow field only considers the terrain, not obstacle entities,
+ * but its cost does not depend on the number of entities using it.
+ *
+ * \param flow_field_enabled \c true to use the flow field instead of A*.
+ */
+void PathFindingMovement::set_flow_field_enabled(bool flow_field_enabled) {
+  this->flow_field_enabled = flow_field_enabled;
 }
 
 /**
@@ -59,6 +89,16 @@ void PathFindingMovement::update() {
     return;
   }
 
+  if (target != nullptr
+      && !flow_field_enabled
+      && path_request == nullptr
+      && path_end.x >= 0
+      && System::now() >= next_recomputation_date
+      && AsyncPathFinding::is_enabled()) {
+    // search the next path from where the current one ends while it is being made
+    path_request = AsyncPathFinding::submit(*get_entity(), path_end, *target);
+  }
+
   if (PathMovement::is_finished()) {
 
     // there was a collision or the path was made
@@ -68,7 +108,7 @@ void PathFindingMovement::update() {
       recompute_movement();
     }
     else {
-      set_path(create_random_path());
+      start_path(create_random_path());
     }
   }
 }
@@ -80,11 +120,18 @@ void PathFindingMovement::update() {
 void PathFindingMovement::recompute_movement() {
 
   if (target != nullptr) {
-    PathFinding path_finding(get_entity()->get_map(), *get_entity(), *target);
-    std::string path = path_finding.compute_path();
+    std::string path;
+    if (flow_field_enabled) {
+      path = compute_flow_field_path();
+    }
+    else if (!get_computed_path(path)) {
+      // a worker thread is still searching: wait for the result
+      return;
+    }
 
+    const bool path_found = !path.empty();
     uint32_t min_delay;
-    if (path.size() == 0) {
+    if (!path_found) {
       // the target is too far or there is no path
       path = create_random_path();
 
@@ -96,12 +143,116 @@ void PathFindingMovement::recompute_movement() {
       // a path was found: we need to update it frequently (and the A* algorithm is much faster in general when there is a solution)
       min_delay = 300;
     }
-    // compute a new path every random delay to avoid
-    // having all path-finding entities of the map compute a path at the same time
-    next_recomputation_date = System::now() + min_delay + Random::get_number(200);
 
-    set_path(path);
+    if (flow_field_enabled && path_found) {
+      // reading the flow field is cheap: follow it again as soon as this path is made
+      next_recomputation_date = System::now();
+    }
+    else {
+      // compute a new path every random delay to avoid
+      // having all path-finding entities of the map compute a path at the same time
+      next_recomputation_date = System::now() + min_delay + Random::get_number(200);
+    }
+
+    start_path(path);
+  }
+}
+
+/**
+ * \brief Returns the path to the target found by A*.
+ *
+ * The path may have been searched by a worker thread.
+ * Results that no longer match the situation are discarded: if the entity
+ * is not where the search started, if the terrain has changed or if the
+ * target has moved too much.
+ *
+ * \param[out] path the path found, or an empty string if there is no path
+ * \return false if the path is still being searched by a worker thread
+ */
+bool PathFindingMovement::get_computed_path(std::string& path) {
+
+  Entity& entity = *get_entity();
+  const Point source = entity.get_bounding_box().get_xy();
+
+  if (path_request != nullptr) {
+    const PathFindingSnapshot& snapshot = path_request->get_snapshot();
+    if (snapshot.get_source() != source
+        || snapshot.get_terrain_version() != entity.get_map().get_entities().get_terrain_version()
+        || Geometry::get_manhattan_distance(
+            snapshot.get_target(), PathFinding::get_target_location(*target)) > max_target_move) {
+      path_request = nullptr;
+    }
+  }
+
+  if (path_request == nullptr) {
+    path_request = AsyncPathFinding::submit(entity, source, *target);
+  }
+
+  if (path_request == nullptr) {
+    // synchronous mode, or a far target that needs the graph of the map
+    PathFinding path_finding(entity.get_map(), entity, *target);
+    path = path_finding.compute_path();
+    return true;
+  }
+
+  if (!path_request->is_done()) {
+    return false;
+  }
+
+  path = path_request->get_path();
+  path_request = nullptr;
+  return true;
+}
+
+/**
+ * \brief Starts following a path and remembers where it should end.
+ * \param path the path to follow
+ */
+void PathFindingMovement::start_path(const std::string& path) {
+
+  const Entity& entity = *get_entity();
+  if (entity.is_aligned_to_grid()) {
+    path_end = entity.get_bounding_box().get_xy();
+    for (char direction: path) {
+      path_end += Entity::direction_to_xy_move(direction - '0') * 8;
+    }
+  }
+  else {
+    path_end = { -1, -1 };
+  }
+
+  set_path(path);
+}
+
+/**
+ * \brief Reads the next steps to the target from the shared flow field.
+ * \return The path to follow, or an empty string if the target cannot be
+ * reached.
+ */
+std::string PathFindingMovement::compute_flow_field_path() {
+
+  Entity& entity = *get_entity();
+  FlowField& flow_field = entity.get_map().get_entities().get_flow_field(
+      *target, PathFindingGraph::get_obstacle_grounds(entity)
+  );
+  flow_field.update();
+
+  if (flow_field.get_layer() != entity.get_layer()) {
+    return "";
+  }
+
+  // A few steps are enough: the field is read again when they are made.
+  std::string path;
+  Point location = entity.get_bounding_box().get_xy();
+  for (int i = 0; i < 4; ++i) {
+    const int direction8 = flow_field.get_direction8(location);
+    if (direction8 == -1) {
+      break;
+    }
+    path += static_cast<char>('0' + direction8);
+    location += Entity::direction_to_xy_move(direction8) * 8;
   }
+  return path;
 }
 
 /**
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/movements/PathFindingSnapshot.h"
+#include "solarus/entities/Entity.h"
+#include "solarus/entities/GroundBitmaps.h"
+#include "solarus/entities/MapEntities.h"
+#include "solarus/movements/PathFindingGraph.h"
+#include "solarus/Map.h"
+
+namespace Solarus {
+
+/**
+ * \brief Copies the obstacles that a path finding query may encounter.
+ *
+ * Must be called from the main thread.
+ *
+ * \param source_entity The entity that will move (used to decide what is
+ * considered as obstacle).
+ * \param source Location of the source node (aligned on the map grid).
+ * \param target Location of the target node (aligned on the map grid).
+ */
+PathFindingSnapshot::PathFindingSnapshot(
+    Entity& source_entity,
+    const Point& source,
+    const Point& target):
+  layer(source_entity.get_layer()),
+  source(source),
+  target(target),
+  map_width(source_entity.get_map().get_width()),
+  map_height(source_entity.get_map().get_height()),
+  terrain_version(source_entity.get_map().get_entities().get_terrain_version()),
+  obstacle_grounds(PathFindingGraph::get_obstacle_grounds(source_entity)),
+  area(),
+  tile_grounds(),
+  ground_modifiers(),
+  obstacle_boxes() {
+
+  MapEntities& entities = source_entity.get_map().get_entities();
+
+  // A local search only explores nodes close to the target,
+  // and its collision boxes go at most 24 pixels further.
+  area = Rectangle(target.x - margin, target.y - margin, 2 * margin, 2 * margin)
+      & Rectangle(0, 0, map_width, map_height);
+
+  const int x8_min = area.get_x() / 8;
+  const int y8_min = area.get_y() / 8;
+  const int width8 = area.get_width() / 8;
+  const int height8 = area.get_height() / 8;
+  tile_grounds.reserve(width8 * height8);
+  for (int y8 = y8_min; y8 < y8_min + height8; ++y8) {
+    for (int x8 = x8_min; x8 < x8_min + width8; ++x8) {
+      tile_grounds.push_back(entities.get_tile_ground(layer, x8 * 8, y8 * 8));
+    }
+  }
+
+  for (const Entity* ground_modifier: entities.get_ground_modifiers(layer)) {
+    if (ground_modifier->get_modified_ground() != Ground::EMPTY
+        && ground_modifier->overlaps(area)
+        && ground_modifier->is_enabled()
+        && !ground_modifier->is_being_removed()) {
+      ground_modifiers.push_back({
+          ground_modifier->get_bounding_box(),
+          ground_modifier->get_modified_ground()
+      });
+    }
+  }
+
+  // Whether an entity is an obstacle may depend on the position of the
+  // other one: use the current position of the source entity.
+  std::vector<Entity*> obstacle_entities;
+  entities.get_obstacle_entities_in_rectangle(layer, area, obstacle_entities);
+  const Rectangle& source_box = source_entity.get_bounding_box();
+  for (Entity* entity: obstacle_entities) {
+    if (entity->is_enabled()
+        && entity != &source_entity
+        && entity->is_obstacle_for(source_entity, source_box)) {
+      obstacle_boxes.push_back(entity->get_bounding_box());
+    }
+  }
+}
+
+/**
+ * \brief Returns the layer where the path is searched.
+ * \return The layer.
+ */
+Layer PathFindingSnapshot::get_layer() const {
+  return layer;
+}
+
+/**
+ * \brief Returns the location of the source node.
+ * \return The source location.
+ */
+const Point& PathFindingSnapshot::get_source() const {
+  return source;
+}
+
+/**
+ * \brief Returns the location of the target node.
+ * \return The target location.
+ */
+const Point& PathFindingSnapshot::get_target() const {
+  return target;
+}
+
+/**
+ * \brief Returns the width of the map.
+ * \return The width in pixels.
+ */
+int PathFindingSnapshot::get_map_width() const {
+  return map_width;
+}
+
+/**
+ * \brief Returns the height of the map.
+ * \return The height in pixels.
+ */
+int PathFindingSnapshot::get_map_height() const {
+  return map_height;
+}
+
+/**
+ * \brief Returns the version of the terrain when the snapshot was made.
+ * \return The terrain version (see MapEntities::get_terrain_version()).
+ */
+uint32_t PathFindingSnapshot::get_terrain_version() const {
+  return terrain_version;
+}
+
+/**
+ * \brief Tests whether a rectangle collides with the copied obstacles.
+ *
+ * This can be called from any thread.
+ *
+ * \param collision_box The rectangle to check (its dimensions should be
+ * multiples of 8).
+ * \return \c true if the rectangle is overlapping an obstacle.
+ */
+bool PathFindingSnapshot::test_collision_with_obstacles(
+    const Rectangle& collision_box) const {
+
+  // Same border points as Map::test_collision_with_terrain().
+  const int x1 = collision_box.get_x();
+  const int x2 = x1 + collision_box.get_width() - 1;
+  const int y1 = collision_box.get_y();
+  const int y2 = y1 + collision_box.get_height() - 1;
+
+  bool found_diagonal_wall = false;
+  for (int x = x1; x <= x2; x += 8) {
+    if (test_collision_with_ground(x, y1, found_diagonal_wall)
+        || test_collision_with_ground(x, y2, found_diagonal_wall)
+        || test_collision_with_ground(x + 7, y1, found_diagonal_wall)
+        || test_collision_with_ground(x + 7, y2, found_diagonal_wall)) {
+      return true;
+    }
+  }
+
+  for (int y = y1; y <= y2; y += 8) {
+    if (test_collision_with_ground(x1, y, found_diagonal_wall)
+        || test_collision_with_ground(x2, y, found_diagonal_wall)
+        || test_collision_with_ground(x1, y + 7, found_diagonal_wall)
+        || test_collision_with_ground(x2, y + 7, found_diagonal_wall)) {
+      return true;
+    }
+  }
+
+  if (found_diagonal_wall) {
+    for (int x = x1; x <= x2; ++x) {
+      if (test_collision_with_ground(x, y1, found_diagonal_wall)
+          || test_collision_with_ground(x, y2, found_diagonal_wall)) {
+        return true;
+      }
+    }
+
+    for (int y = y1; y <= y2; ++y) {
+      if (test_collision_with_ground(x1, y, found_diagonal_wall)
+          || test_collision_with_ground(x2, y, found_diagonal_wall)) {
+        return true;
+      }
+    }
+  }
+
+  for (const Rectangle& obstacle_box: obstacle_boxes) {
+    if (obstacle_box.overlaps(collision_box)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * \brief Returns the ground at a point of the copied area.
+ * \param x X coordinate of the point.
+ * \param y Y coordinate of the point.
+ * \return The ground at this place.
+ */
+Ground PathFindingSnapshot::get_ground(int x, int y) const {
+
+  // The last ground modifier wins, like in Map::get_ground().
+  for (auto it = ground_modifiers.rbegin(); it != ground_modifiers.rend(); ++it) {
+    if (it->box.contains(x, y)) {
+      return it->ground;
+    }
+  }
+
+  const int x8 = (x - area.get_x()) / 8;
+  const int y8 = (y - area.get_y()) / 8;
+  return tile_grounds[y8 * (area.get_width() / 8) + x8];
+}
+
+/**
+ * \brief Tests whether a point is on an obstacle ground.
+ *
+ * Points outside the map or outside the copied area are obstacles.
+ *
+ * \param x X of the point in pixels.
+ * \param y Y of the point in pixels.
+ * \param[out] found_diagonal_wall \c true if the ground under this point
+ * was a diagonal wall, unchanged otherwise.
+ * \return \c true if this point is on an obstacle.
+ */
+bool PathFindingSnapshot::test_collision_with_ground(
+    int x, int y, bool& found_diagonal_wall) const {
+
+  if (!area.contains(x, y)) {
+    return true;
+  }
+
+  const int x_in_tile = x & 7;
+  const int y_in_tile = y & 7;
+  const Ground ground = get_ground(x, y);
+  switch (ground) {
+
+  case Ground::WALL_TOP_RIGHT:
+  case Ground::WALL_TOP_RIGHT_WATER:
+    found_diagonal_wall = true;
+    return y_in_tile <= x_in_tile;
+
+  case Ground::WALL_TOP_LEFT:
+  case Ground::WALL_TOP_LEFT_WATER:
+    found_diagonal_wall = true;
+    return y_in_tile <= 7 - x_in_tile;
+
+  case Ground::WALL_BOTTOM_LEFT:
+  case Ground::WALL_BOTTOM_LEFT_WATER:
+    found_diagonal_wall = true;
+    return y_in_tile >= x_in_tile;
+
+  case Ground::WALL_BOTTOM_RIGHT:
+  case Ground::WALL_BOTTOM_RIGHT_WATER:
+    found_diagonal_wall = true;
+    return y_in_tile >= 7 - x_in_tile;
+
+  default:
+    return (obstacle_grounds & GroundBitmaps::get_ground_bit(ground)) != 0;
+  }
+}
+
+}
+
@@ -601,6 +601,60 @@ void StraightMovement::update_y() {
   }
 }
 
+/**
+ * \brief Makes several one-pixel steps at once if the movement is late
+ * and nothing is on the way.
+ *
+ * This only applies to horizontal and vertical movements:
+ * diagonal ones need to alternate x and y steps.
+ *
+ * \param now The current date.
+ * \return \c true if several steps were made.
+ */
+bool StraightMovement::update_several_steps(uint32_t now) {
+
+  if (x_move != 0 && y_move != 0) {
+    return false;
+  }
+
+  const bool horizontal = x_move != 0;
+  const uint32_t next_move_date = horizontal ? next_move_date_x : next_move_date_y;
+  const uint32_t delay = horizontal ? x_delay : y_delay;
+  if (delay == 0 || now < next_move_date + delay) {
+    // At most one step to make.
+    return false;
+  }
+
+  const Point direction(x_move, y_move);
+  int nb_steps = (now - next_move_date) / delay + 1;
+  if (max_distance != 0) {
+    // Stop at the first step that reaches the maximum distance.
+    const Point xy = get_xy();
+    int steps = 1;
+    while (steps < nb_steps
+        && Geometry::get_distance(initial_xy, xy + direction * steps) < max_distance) {
+      ++steps;
+    }
+    nb_steps = steps;
+  }
+
+  if (nb_steps >= 2) {
+    nb_steps = get_free_distance(direction, nb_steps);
+  }
+  if (nb_steps < 2) {
+    return false;
+  }
+
+  translate_xy(direction * nb_steps);
+  if (horizontal) {
+    next_move_date_x += x_delay * nb_steps;
+  }
+  else {
+    next_move_date_y += y_delay * nb_steps;
+  }
+  return true;
+}
+
 /**
  * \brief Updates the position of the object controlled by this movement.
  *
@@ -619,7 +673,11 @@ void StraightMovement::update() {
       // save the current coordinates
       Point old_xy = get_xy();
 
-      if (x_move_now) {
+      if (update_several_steps(now)) {
+        // The movement was late and the way was free:
+        // several steps were made at once.
+      }
+      else if (x_move_now) {
         // it's time to make an x move
 
         if (y_move_now) {
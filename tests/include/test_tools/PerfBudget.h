@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SOLARUS_PERF_BUDGET_H
+#define SOLARUS_PERF_BUDGET_H
+
+#include "solarus/Common.h"
+#include <cstdint>
+#include <string>
+
+namespace Solarus {
+
+class Arguments;
+
+/**
+ * \brief Checks a measured duration against a time budget.
+ *
+ * The budget is given in microseconds with the -budget=<n> argument and
+ * the tolerance with -margin=<factor> (2 by default).
+ * check() makes the test fail if the duration exceeds the budget
+ * multiplied by the margin.
+ * Without -budget, durations are only printed.
+ */
+class PerfBudget {
+
+  public:
+
+    PerfBudget(const Arguments& args, const std::string& what);
+
+    void check(uint64_t duration) const;
+
+  private:
+
+    std::string what;     /**< Description of what is measured. */
+    uint64_t budget;      /**< Expected duration in microseconds, or 0. */
+    double margin;        /**< Factor by which the budget may be exceeded. */
+
+};
+
+}
+
+#endif
+
@@ -59,6 +59,7 @@ class TestEnvironment {
     MapEntities& get_entities();
     Hero& get_hero();
 
+    void start_map(const std::string& map_id);
     void run_map(const std::string& map_id);
 
     // Creating entities.
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Profiler.h"
+#include "test_tools/TestEnvironment.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Solarus;
+
+namespace {
+
+/**
+ * \brief Phases always reported, even if they were never entered.
+ */
+const std::vector<std::string> main_phases = {
+    "Game::update",
+    "LuaContext::update",
+    "MapEntities::update",
+    "MapEntities::draw",
+    "Video::render"
+};
+
+/**
+ * \brief Returns the value at the given percentile of sorted values.
+ * \param sorted_values Values in increasing order. Must not be empty.
+ * \param percentile A percentile between 0 and 100.
+ * \return The corresponding value.
+ */
+uint64_t get_percentile(const std::vector<uint64_t>& sorted_values, int percentile) {
+
+  const size_t index = (sorted_values.size() - 1) * percentile / 100;
+  return sorted_values[index];
+}
+
+/**
+ * \brief Writes JSON statistics of a series of per-frame durations.
+ * \param out The output stream.
+ * \param values Time spent at each frame in microseconds.
+ */
+void write_stats(std::ostream& out, std::vector<uint64_t> values) {
+
+  uint64_t total = 0;
+  for (uint64_t value: values) {
+    total += value;
+  }
+  std::sort(values.begin(), values.end());
+
+  out << "{ \"total_ms\": " << (total / 1000.0)
+      << ", \"min_ms\": " << (values.front() / 1000.0)
+      << ", \"median_ms\": " << (get_percentile(values, 50) / 1000.0)
+      << ", \"p99_ms\": " << (get_percentile(values, 99) / 1000.0)
+      << ", \"max_ms\": " << (values.back() / 1000.0)
+      << " }";
+}
+
+}
+
+/**
+ * \brief Simulates a map for a fixed number of steps and reports timings.
+ *
+ * Usage: solarus_bench -no-audio -no-video -map=<map_id> [-steps=<n>]
+ *        [-output=<file.json>] [quest_path]
+ *
+ * Each step updates the world once and redraws it, as fast as possible.
+ * The time spent in the main engine phases is written as JSON to the
+ * output file, or to the standard output by default.
+ * The simulation stops earlier if the quest requests to exit.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+  const Arguments& args = env.get_arguments();
+
+  const std::string& map_id = args.get_argument_value("-map");
+  Debug::check_assertion(!map_id.empty(), "No map specified");
+
+  int num_steps = 1000;
+  const std::string& steps_string = args.get_argument_value("-steps");
+  if (!steps_string.empty()) {
+    std::istringstream iss(steps_string);
+    Debug::check_assertion((iss >> num_steps) && num_steps > 0,
+        "Invalid number of steps: '" + steps_string + "'");
+  }
+
+  env.start_map(map_id);
+  MainLoop& main_loop = env.get_main_loop();
+
+  std::vector<uint64_t> frame_times;
+  std::map<std::string, std::vector<uint64_t>> phase_times;
+  for (const std::string& phase: main_phases) {
+    phase_times[phase];
+  }
+
+  Profiler::set_enabled(true);
+  int step = 0;
+  for (step = 0; step < num_steps && !main_loop.is_exiting(); ++step) {
+
+    Profiler::reset_zone_stats();
+    const uint64_t start_time = Profiler::get_time();
+    main_loop.step();
+    main_loop.draw();
+    frame_times.push_back(Profiler::get_time() - start_time);
+
+    for (const Profiler::ZoneStats& stats: Profiler::get_zone_stats()) {
+      std::vector<uint64_t>& times = phase_times[stats.name];
+      // Phases discovered late were not entered at previous steps.
+      times.resize(step, 0);
+      times.push_back(stats.total_time);
+    }
+  }
+  Profiler::set_enabled(false);
+
+  Debug::check_assertion(step > 0, "No step was simulated");
+
+  std::ostringstream oss;
+  oss << "{" << std::endl
+      << "  \"map\": \"" << map_id << "\"," << std::endl
+      << "  \"steps\": " << step << "," << std::endl
+      << "  \"frame\": ";
+  write_stats(oss, frame_times);
+  oss << "," << std::endl
+      << "  \"phases\": {";
+  bool first = true;
+  for (auto& kvp: phase_times) {
+    kvp.second.resize(step, 0);
+    oss << (first ? "" : ",") << std::endl
+        << "    \"" << kvp.first << "\": ";
+    write_stats(oss, kvp.second);
+    first = false;
+  }
+  oss << std::endl << "  }" << std::endl
+      << "}" << std::endl;
+
+  const std::string& output_file_name = args.get_argument_value("-output");
+  if (output_file_name.empty()) {
+    std::cout << oss.str();
+  }
+  else {
+    std::ofstream output_file(output_file_name);
+    Debug::check_assertion(output_file.good(),
+        "Cannot write file '" + output_file_name + "'");
+    output_file << oss.str();
+  }
+
+  return 0;
+}
+
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/Arguments.h"
+#include "test_tools/PerfBudget.h"
+#include <iostream>
+#include <sstream>
+
+namespace Solarus {
+
+/**
+ * \brief Creates a budget from the command-line arguments.
+ * \param args The arguments of the test.
+ * \param what Description of what is measured, used in messages.
+ */
+PerfBudget::PerfBudget(const Arguments& args, const std::string& what):
+    what(what),
+    budget(0),
+    margin(2.0) {
+
+  const std::string& budget_string = args.get_argument_value("-budget");
+  if (!budget_string.empty()) {
+    std::istringstream iss(budget_string);
+    Debug::check_assertion(bool(iss >> budget),
+        "Invalid budget: '" + budget_string + "'");
+  }
+
+  const std::string& margin_string = args.get_argument_value("-margin");
+  if (!margin_string.empty()) {
+    std::istringstream iss(margin_string);
+    Debug::check_assertion((iss >> margin) && margin > 0.0,
+        "Invalid margin: '" + margin_string + "'");
+  }
+}
+
+/**
+ * \brief Prints a measured duration and fails if it exceeds the budget.
+ * \param duration The duration measured in microseconds.
+ */
+void PerfBudget::check(uint64_t duration) const {
+
+  std::cout << what << ": " << duration << " us";
+  if (budget != 0) {
+    std::cout << " (budget " << budget << " us, margin " << margin << ")";
+  }
+  std::cout << std::endl;
+
+  if (budget != 0 && duration > budget * margin) {
+    std::ostringstream oss;
+    oss << what << " took " << duration << " us, more than "
+        << margin << " times the budget of " << budget << " us";
+    Debug::die(oss.str());
+  }
+}
+
+}
+
@@ -103,6 +103,19 @@ Hero& TestEnvironment::get_hero() {
   return *get_game().get_hero();
 }
 
+/**
+ * \brief Starts a game on the specified map without running the main loop.
+ *
+ * The simulation then only advances when you call step().
+ *
+ * \param map_id Id of the map to open.
+ */
+void TestEnvironment::start_map(const std::string& map_id) {
+
+  this->map_id = map_id;
+  get_map();  // Create a game and start it on the map.
+}
+
 /**
  * \brief Runs the main loop on the specified map.
  * \param map_id Id of the map to open.
@@ -16,10 +16,17 @@
  */
 #include "solarus/entities/CustomEntity.h"
 #include "solarus/entities/EntityPtr.h"
+#include "solarus/entities/Ground.h"
 #include "solarus/entities/Hero.h"
+#include "solarus/entities/MapEntities.h"
 #include "solarus/lowlevel/Debug.h"
+#include "solarus/movements/FlowField.h"
 #include "solarus/movements/PathFinding.h"
+#include "solarus/movements/PathFindingCache.h"
+#include "solarus/movements/PathFindingGraph.h"
+#include "solarus/movements/PathFindingSnapshot.h"
 #include "solarus/Game.h"
+#include "solarus/Map.h"
 #include "test_tools/TestEnvironment.h"
 
 using namespace Solarus;
@@ -43,6 +50,144 @@ void basic_test(TestEnvironment& env) {
   Debug::check_assertion(path == "7777700", "Unexpected path");
 }
 
+/**
+ * \brief Checks that a path is found to a target too far for a direct search.
+ *
+ * A wall with an opening at the bottom is between the entity and the target.
+ * Long paths are only refined up to some distance, so like path finding
+ * movements, the entity follows successive paths.
+ * They must reach the target node without going through the wall.
+ */
+void long_distance_test(TestEnvironment& env) {
+
+  Map& map = env.get_map();
+  Hero& hero = env.get_hero();
+  CustomEntity& entity = *env.make_entity<CustomEntity>();
+
+  for (int y = 0; y < 192; y += 16) {
+    CustomEntity& wall = *env.make_entity<CustomEntity>(Point(72, y + 13));
+    wall.set_modified_ground(Ground::WALL);
+  }
+
+  entity.set_top_left_xy(8, 8);
+  hero.set_top_left_xy(296, 216);
+
+  const Layer layer = entity.get_layer();
+  const Point target = PathFinding::get_target_location(hero);
+  for (int i = 0; i < 4 && entity.get_top_left_xy() != target; ++i) {
+    PathFinding path_finder(map, entity, hero);
+    const std::string path = path_finder.compute_path();
+    Debug::check_assertion(!path.empty(), "No path found to a far target");
+
+    Rectangle box = entity.get_bounding_box();
+    for (char direction: path) {
+      box.add_xy(Entity::direction_to_xy_move(direction - '0') * 8);
+      Debug::check_assertion(!map.test_collision_with_obstacles(layer, box, entity),
+          "The path goes through an obstacle");
+    }
+    entity.set_top_left_xy(box.get_xy());
+  }
+
+  Debug::check_assertion(entity.get_top_left_xy() == target,
+      "The paths do not reach the target");
+}
+
+/**
+ * \brief Checks the directions given by a flow field.
+ */
+void flow_field_test(TestEnvironment& env) {
+
+  Hero& hero = env.get_hero();
+  CustomEntity& entity = *env.make_entity<CustomEntity>();
+
+  entity.set_top_left_xy(144, 104);
+  hero.set_top_left_xy(200, 144);
+
+  FlowField& flow_field = env.get_map().get_entities().get_flow_field(
+      hero, PathFindingGraph::get_obstacle_grounds(entity)
+  );
+  flow_field.update();
+
+  const int direction8 = flow_field.get_direction8(entity.get_top_left_xy());
+  Debug::check_assertion(direction8 == 0 || direction8 == 7, "Unexpected flow field direction");
+  Debug::check_assertion(flow_field.get_direction8(Point(200, 144)) == -1,
+      "The target should have no direction");
+}
+
+/**
+ * \brief Checks that a path searched in a snapshot of the map is the same
+ * as a path searched in the map itself.
+ */
+void snapshot_test(TestEnvironment& env) {
+
+  Hero& hero = env.get_hero();
+  CustomEntity& entity = *env.make_entity<CustomEntity>();
+
+  entity.set_top_left_xy(144, 104);
+  hero.set_top_left_xy(200, 144);
+
+  const Point source = entity.get_top_left_xy();
+  const Point target = PathFinding::get_target_location(hero);
+  PathFindingSnapshot snapshot(entity, source, target);
+  PathFinding path_finder(snapshot);
+  std::string path = path_finder.compute_path();
+
+  Debug::check_assertion(path == "7777700", "Unexpected path in the snapshot");
+}
+
+/**
+ * \brief Checks that a path is reused, even by another entity of the same
+ * type, until an obstacle moves.
+ */
+void cache_test(TestEnvironment& env) {
+
+  Hero& hero = env.get_hero();
+  CustomEntity& entity = *env.make_entity<CustomEntity>();
+  CustomEntity& obstacle = *env.make_entity<CustomEntity>();
+
+  entity.set_top_left_xy(144, 104);
+  hero.set_top_left_xy(200, 144);
+  obstacle.set_top_left_xy(16, 16);
+  obstacle.set_traversable_by_entities(false);
+
+  const PathFindingCache& cache = env.get_map().get_entities().get_path_finding_cache();
+  PathFinding path_finder(env.get_map(), entity, hero);
+  const std::string path = path_finder.compute_path();
+
+  const uint64_t num_hits = cache.get_num_hits();
+  Debug::check_assertion(path_finder.compute_path() == path, "Unexpected path from the cache");
+  Debug::check_assertion(cache.get_num_hits() == num_hits + 1, "The path was not reused");
+
+  CustomEntity& other_entity = *env.make_entity<CustomEntity>();
+  other_entity.set_top_left_xy(144, 104);
+  PathFinding other_path_finder(env.get_map(), other_entity, hero);
+  Debug::check_assertion(other_path_finder.compute_path() == path,
+      "Unexpected path from the cache for another entity");
+  Debug::check_assertion(cache.get_num_hits() == num_hits + 2,
+      "The path was not reused by another entity");
+
+  // The hero moving inside the target node does not change the path.
+  hero.set_top_left_xy(201, 145);
+  Debug::check_assertion(other_path_finder.compute_path() == path,
+      "Unexpected path after the hero moved");
+  Debug::check_assertion(cache.get_num_hits() == num_hits + 3,
+      "The path was not reused after the hero moved");
+
+  obstacle.set_top_left_xy(32, 16);
+  Debug::check_assertion(path_finder.compute_path() == path, "Unexpected path after a move");
+  Debug::check_assertion(cache.get_num_hits() == num_hits + 3,
+      "The path was reused after an obstacle moved");
+
+  // Entities with their own traversal rules don't use the cache.
+  other_entity.set_can_traverse_entities(true);
+  const uint64_t num_misses = cache.get_num_misses();
+  Debug::check_assertion(other_path_finder.compute_path() == path,
+      "Unexpected path for an entity with traversal rules");
+  Debug::check_assertion(cache.get_num_hits() == num_hits + 3 &&
+      cache.get_num_misses() == num_misses,
+      "The cache was used by an entity with traversal rules");
+}
+
 }
 
 /**
@@ -53,6 +198,10 @@ int main(int argc, char** argv) {
   TestEnvironment env(argc, argv);
 
   basic_test(env);
+  long_distance_test(env);
+  flow_field_test(env);
+  snapshot_test(env);
+  cache_test(env);
 
   return 0;
 }
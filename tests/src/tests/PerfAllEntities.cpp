@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Profiler.h"
+#include "test_tools/PerfBudget.h"
+#include "test_tools/TestEnvironment.h"
+
+using namespace Solarus;
+
+namespace {
+
+constexpr int num_steps = 1000;
+
+}
+
+/**
+ * \brief Measures simulating the map that contains every type of entity.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+  PerfBudget budget(env.get_arguments(), "Simulating all_entities");
+
+  env.start_map("all_entities");
+
+  // The map script exits the main loop right away, but steps can still be
+  // simulated manually.
+  const uint64_t start_time = Profiler::get_time();
+  for (int i = 0; i < num_steps; ++i) {
+    env.step();
+  }
+  budget.check(Profiler::get_time() - start_time);
+
+  return 0;
+}
+
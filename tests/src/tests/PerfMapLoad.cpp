@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Profiler.h"
+#include "test_tools/PerfBudget.h"
+#include "test_tools/TestEnvironment.h"
+
+using namespace Solarus;
+
+/**
+ * \brief Measures the time to start a game on the map given by -map.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+  const std::string& map_id = env.get_arguments().get_argument_value("-map");
+  Debug::check_assertion(!map_id.empty(), "Missing -map argument");
+
+  PerfBudget budget(env.get_arguments(), "Loading map '" + map_id + "'");
+
+  const uint64_t start_time = Profiler::get_time();
+  env.start_map(map_id);
+  budget.check(Profiler::get_time() - start_time);
+
+  return 0;
+}
+
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/CustomEntity.h"
+#include "solarus/entities/Hero.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Profiler.h"
+#include "solarus/movements/PathFinding.h"
+#include "solarus/Map.h"
+#include "test_tools/PerfBudget.h"
+#include "test_tools/TestEnvironment.h"
+
+using namespace Solarus;
+
+namespace {
+
+// Fewer than the number of distinct sources on the smallest map,
+// so that the queries measure searches and not the path finding cache.
+constexpr int num_queries = 100;
+
+/**
+ * \brief Measures path finding queries from sources spread over the map.
+ * \param env The test environment.
+ * \param entity The entity to move along the paths.
+ * \param[out] num_paths Incremented for each path found.
+ * \return The total duration of the queries in microseconds.
+ */
+uint64_t measure_queries(TestEnvironment& env, CustomEntity& entity, int& num_paths) {
+
+  Hero& hero = env.get_hero();
+  const Size map_size = env.get_map().get_size();
+
+  uint64_t total_time = 0;
+  for (int i = 0; i < num_queries; ++i) {
+    // Spread the sources over the map on the 8-pixel grid.
+    const int x = ((i * 37) % (map_size.width / 8)) * 8;
+    const int y = ((i * 53) % (map_size.height / 8)) * 8;
+    entity.set_top_left_xy(x, y);
+
+    const uint64_t start_time = Profiler::get_time();
+    PathFinding path_finder(env.get_map(), entity, hero);
+    const std::string& path = path_finder.compute_path();
+    total_time += Profiler::get_time() - start_time;
+
+    if (!path.empty()) {
+      ++num_paths;
+    }
+  }
+  return total_time;
+}
+
+/**
+ * \brief Builds vertical walls with alternating openings.
+ *
+ * Paths across the map have to go around each wall, which exercises
+ * the search much more than an open area.
+ *
+ * \param env The test environment.
+ */
+void make_walls(TestEnvironment& env) {
+
+  const Size map_size = env.get_map().get_size();
+  int wall_index = 0;
+  for (int x = 64; x < map_size.width - 16; x += 96) {
+    // Leave a 32-pixel opening, alternately at the bottom and at the top.
+    const bool opening_at_bottom = (wall_index % 2) == 0;
+    for (int y = 0; y < map_size.height; y += 16) {
+      const bool opening = opening_at_bottom ?
+          y >= map_size.height - 32 : y < 32;
+      if (opening) {
+        continue;
+      }
+      CustomEntity& wall = *env.make_entity<CustomEntity>(
+          Point(x + 8, y + 13), env.get_hero().get_layer()
+      );
+      wall.set_traversable_by_entities(false);
+    }
+    ++wall_index;
+  }
+}
+
+}
+
+/**
+ * \brief Measures the average duration of a path finding query to the hero
+ * on the map given by -map, as it is and then with walls to go around.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+  const std::string& map_id = env.get_arguments().get_argument_value("-map");
+  Debug::check_assertion(!map_id.empty(), "Missing -map argument");
+
+  PerfBudget budget(env.get_arguments(),
+      "Path finding query on map '" + map_id + "' (average)");
+
+  env.start_map(map_id);
+  CustomEntity& entity = *env.make_entity<CustomEntity>(
+      Point(0, 0), env.get_hero().get_layer()
+  );
+
+  int num_paths = 0;
+  uint64_t total_time = measure_queries(env, entity, num_paths);
+
+  make_walls(env);
+  total_time += measure_queries(env, entity, num_paths);
+
+  budget.check(total_time / (2 * num_queries));
+
+  Debug::check_assertion(num_paths > 0, "No path found");
+
+  return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/containers/Quadtree.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Profiler.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include "test_tools/PerfBudget.h"
+#include "test_tools/TestEnvironment.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace Solarus;
+
+namespace {
+
+constexpr int num_elements = 2000;
+constexpr int num_rounds = 50;
+constexpr int num_queries = 20000;
+
+using ElementPtr = std::shared_ptr<Rectangle>;
+
+/**
+ * \brief Returns a random 16x16 rectangle in the given space.
+ */
+Rectangle make_random_box(std::mt19937& random, const Rectangle& space) {
+
+  std::uniform_int_distribution<int> x(space.get_x(), space.get_x() + space.get_width() - 16);
+  std::uniform_int_distribution<int> y(space.get_y(), space.get_y() + space.get_height() - 16);
+  return Rectangle(x(random), y(random), 16, 16);
+}
+
+}
+
+/**
+ * \brief Measures adding, moving and querying many quadtree elements.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+  PerfBudget budget(env.get_arguments(), "Quadtree add/move/query");
+
+  Rectangle space(0, 0, 4096, 4096);
+  Quadtree<ElementPtr> quadtree(space);
+  std::mt19937 random(42);  // Fixed seed to always measure the same work.
+
+  const uint64_t start_time = Profiler::get_time();
+
+  std::vector<ElementPtr> elements;
+  for (int i = 0; i < num_elements; ++i) {
+    ElementPtr element = std::make_shared<Rectangle>(make_random_box(random, space));
+    Debug::check_assertion(quadtree.add(element, *element), "Failed to add element");
+    elements.push_back(element);
+  }
+
+  for (int round = 0; round < num_rounds; ++round) {
+    for (const ElementPtr& element: elements) {
+      *element = make_random_box(random, space);
+      Debug::check_assertion(quadtree.move(element, *element), "Failed to move element");
+    }
+  }
+
+  size_t num_found = 0;
+  std::vector<ElementPtr> found_elements;
+  for (int i = 0; i < num_queries; ++i) {
+    Rectangle region = make_random_box(random, space);
+    region.set_size(320, 240);
+    found_elements.clear();
+    quadtree.get_elements(region, found_elements);
+    num_found += found_elements.size();
+  }
+
+  budget.check(Profiler::get_time() - start_time);
+
+  Debug::check_assertion(quadtree.get_num_elements() == num_elements, "Wrong number of elements");
+  Debug::check_assertion(num_found > 0, "No element found");
+
+  return 0;
+}
+
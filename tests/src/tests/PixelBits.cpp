@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/lowlevel/Color.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/PixelBits.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include "solarus/lowlevel/Surface.h"
+#include "test_tools/TestEnvironment.h"
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace Solarus;
+
+namespace {
+
+/**
+ * \brief An image with random opaque pixels and its expected opacity mask.
+ */
+struct Image {
+  SurfacePtr surface;          /**< The image. */
+  Rectangle position;          /**< Part of the surface to check, clipped. */
+  std::vector<bool> opaque;    /**< Opacity of each pixel of that part. */
+};
+
+/**
+ * \brief Creates an image made of random opaque rectangles.
+ *
+ * Images are up to 200 pixels wide so that rows use several 64-bit words.
+ */
+Image make_image(std::mt19937& random) {
+
+  std::uniform_int_distribution<int> width_distribution(1, 200);
+  std::uniform_int_distribution<int> height_distribution(1, 40);
+  const Size size(width_distribution(random), height_distribution(random));
+
+  Image image;
+  image.surface = Surface::create(size);
+  std::vector<bool> surface_opaque(size.width * size.height, false);
+
+  // Thin rectangles and single pixels give shapes with holes.
+  const int num_rectangles = std::uniform_int_distribution<int>(1, 8)(random);
+  for (int i = 0; i < num_rectangles; ++i) {
+    const int x = std::uniform_int_distribution<int>(0, size.width - 1)(random);
+    const int y = std::uniform_int_distribution<int>(0, size.height - 1)(random);
+    const int max_width = (i % 2 == 0) ? size.width - x : 1;
+    const int width = std::uniform_int_distribution<int>(1, max_width)(random);
+    const int height = std::uniform_int_distribution<int>(1, size.height - y)(random);
+    image.surface->fill_with_color(Color::white, Rectangle(x, y, width, height));
+    for (int j = y; j < y + height; ++j) {
+      for (int k = x; k < x + width; ++k) {
+        surface_opaque[j * size.width + k] = true;
+      }
+    }
+  }
+
+  // Check a random part of the surface, possibly partly outside.
+  const Rectangle wanted_position(
+      std::uniform_int_distribution<int>(-5, size.width - 1)(random),
+      std::uniform_int_distribution<int>(-5, size.height - 1)(random),
+      width_distribution(random),
+      height_distribution(random)
+  );
+  image.position = wanted_position.get_intersection(Rectangle(size));
+  for (int y = 0; y < image.position.get_height(); ++y) {
+    for (int x = 0; x < image.position.get_width(); ++x) {
+      const int index = (image.position.get_y() + y) * size.width + image.position.get_x() + x;
+      image.opaque.push_back(surface_opaque[index]);
+    }
+  }
+  return image;
+}
+
+/**
+ * \brief Checks pixel by pixel whether two images overlap.
+ */
+bool test_collision_brute_force(
+    const Image& image1, const Image& image2,
+    const Point& location1, const Point& location2) {
+
+  const int width1 = image1.position.get_width();
+  const int height1 = image1.position.get_height();
+  const int width2 = image2.position.get_width();
+  const int height2 = image2.position.get_height();
+  for (int y1 = 0; y1 < height1; ++y1) {
+    for (int x1 = 0; x1 < width1; ++x1) {
+      if (!image1.opaque[y1 * width1 + x1]) {
+        continue;
+      }
+      const int x2 = location1.x + x1 - location2.x;
+      const int y2 = location1.y + y1 - location2.y;
+      if (x2 >= 0 && y2 >= 0 && x2 < width2 && y2 < height2 &&
+          image2.opaque[y2 * width2 + x2]) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * \brief Compares PixelBits::test_collision() with a pixel by pixel check
+ * on random images and random offsets.
+ */
+void test_random_images() {
+
+  std::mt19937 random(42);
+  std::uniform_int_distribution<int> dx_distribution(-220, 220);
+  std::uniform_int_distribution<int> dy_distribution(-50, 50);
+
+  int num_collisions = 0;
+  for (int i = 0; i < 200; ++i) {
+    const Image image1 = make_image(random);
+    const Image image2 = make_image(random);
+    const PixelBits bits1(*image1.surface, image1.position);
+    const PixelBits bits2(*image2.surface, image2.position);
+
+    for (int j = 0; j < 20; ++j) {
+      const Point location1(dx_distribution(random), dy_distribution(random));
+      const Point location2(location1.x + dx_distribution(random), location1.y + dy_distribution(random));
+
+      const bool expected = test_collision_brute_force(image1, image2, location1, location2);
+      if (bits1.test_collision(bits2, location1, location2) != expected ||
+          bits2.test_collision(bits1, location2, location1) != expected) {
+        std::ostringstream oss;
+        oss << "Wrong pixel collision result for images " << i
+            << " at offset " << j << ": expected " << expected;
+        Debug::die(oss.str());
+      }
+      if (expected) {
+        ++num_collisions;
+      }
+    }
+  }
+
+  Debug::check_assertion(num_collisions > 0, "No collision was tested");
+}
+
+}
+
+/**
+ * \brief Tests pixel-precise collisions.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+
+  test_random_images();
+
+  return 0;
+}
+
@@ -18,6 +18,7 @@
 #include "solarus/lowlevel/Debug.h"
 #include "solarus/lowlevel/Rectangle.h"
 #include "test_tools/TestEnvironment.h"
+#include <algorithm>
 #include <memory>
 #include <sstream>
 
@@ -183,6 +184,62 @@ void test_add_limit(TestEnvironment& /* env */, Quadtree<ElementPtr>& quadtree)
   add_expect_fail(quadtree, Rectangle(-160, 0, 16, 960));
 }
 
+/**
+ * \brief Tests that an element overlapping several cells is found once.
+ */
+void test_no_duplicates(TestEnvironment& /* env */, Quadtree<ElementPtr>& quadtree) {
+
+  ElementPtr big_element = add(quadtree, Rectangle(0, 0, 1280, 960));
+
+  std::vector<ElementPtr> found_elements;
+  quadtree.get_elements(quadtree.get_space(), found_elements);
+  Debug::check_assertion(
+      std::count(found_elements.begin(), found_elements.end(), big_element) == 1,
+      "Element found several times"
+  );
+
+  int num_visits = 0;
+  quadtree.for_each_element(Rectangle(100, 100, 500, 500), [&](const ElementPtr& element) {
+    if (element == big_element) {
+      ++num_visits;
+    }
+  });
+  Debug::check_assertion(num_visits == 1, "Element visited several times");
+
+  Debug::check_assertion(quadtree.any_element(Rectangle(600, 600, 8, 8), [&](const ElementPtr& element) {
+    return element == big_element;
+  }), "Element not found by any_element()");
+
+  remove(quadtree, big_element);
+}
+
+/**
+ * \brief Tests moving elements, including outside the space and back.
+ */
+void test_move(TestEnvironment& /* env */, Quadtree<ElementPtr>& quadtree) {
+
+  ElementPtr element = add(quadtree, Rectangle(32, 32, 16, 16));
+
+  Debug::check_assertion(quadtree.move(element, Rectangle(640, 480, 16, 16)), "Failed to move element");
+  std::vector<ElementPtr> found_elements;
+  quadtree.get_elements(Rectangle(32, 32, 16, 16), found_elements);
+  Debug::check_assertion(
+      std::find(found_elements.begin(), found_elements.end(), element) == found_elements.end(),
+      "Element found at its old position"
+  );
+  found_elements.clear();
+  quadtree.get_elements(Rectangle(640, 480, 16, 16), found_elements);
+  check_found(found_elements, element);
+
+  Debug::check_assertion(!quadtree.move(element, Rectangle(-500, -500, 16, 16)), "Element moved outside the space");
+  Debug::check_assertion(quadtree.move(element, Rectangle(64, 64, 16, 16)), "Failed to move element back");
+  found_elements.clear();
+  quadtree.get_elements(Rectangle(64, 64, 16, 16), found_elements);
+  check_found(found_elements, element);
+
+  remove(quadtree, element);
+}
+
 }
 
 /**
@@ -201,6 +258,8 @@ int main(int argc, char** argv) {
   test_add_big_size(env, quadtree);
   test_add_limit(env, quadtree);
   test_remove(env, quadtree);
+  test_no_duplicates(env, quadtree);
+  test_move(env, quadtree);
 
   return 0;
 }
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/CustomEntity.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/movements/StraightMovement.h"
+#include "test_tools/TestEnvironment.h"
+#include <memory>
+
+using namespace Solarus;
+
+namespace {
+
+/**
+ * \brief Tests that a projectile far from other entities can make
+ * several steps at once, but only one step when an entity is close
+ * to its way.
+ */
+void projectile_free_distance_test(TestEnvironment& env) {
+
+  CustomEntity& projectile = *env.make_entity<CustomEntity>();
+  projectile.set_top_left_xy(16, 32);
+
+  std::shared_ptr<StraightMovement> m =
+      std::make_shared<StraightMovement>(false, false);
+  m->set_speed(100);
+  m->set_angle(0);
+  projectile.set_movement(m);
+
+  Debug::check_assertion(m->get_free_distance(Point(1, 0), 64) == 64,
+      "Unexpected free distance in 'projectile_free_distance_test #1'");
+
+  // An entity beside the way could be detected from intermediate positions.
+  CustomEntity& target = *env.make_entity<CustomEntity>();
+  target.set_top_left_xy(64, 48);
+
+  Debug::check_assertion(m->get_free_distance(Point(1, 0), 64) == 1,
+      "Unexpected free distance in 'projectile_free_distance_test #2'");
+
+  projectile.clear_movement();
+}
+
+}
+
+/**
+ * \brief Tests for the straight movement.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+
+  projectile_free_distance_test(env);
+
+  return 0;
+}
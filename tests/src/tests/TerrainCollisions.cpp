@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2006-2015 Christopho, Solarus - http://www.solarus-games.org
+ *
+ * Solarus is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Solarus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "solarus/entities/CustomEntity.h"
+#include "solarus/entities/Ground.h"
+#include "solarus/entities/Hero.h"
+#include "solarus/lowlevel/Debug.h"
+#include "solarus/lowlevel/Rectangle.h"
+#include "solarus/Map.h"
+#include "test_tools/TestEnvironment.h"
+#include <sstream>
+
+using namespace Solarus;
+
+namespace {
+
+/**
+ * \brief Tests the terrain point by point like the engine did before
+ * ground bitmaps, then the obstacle entities.
+ *
+ * Both extremities of each 8-pixel segment of the border are checked,
+ * and all points of the border if a diagonal wall is involved.
+ */
+bool test_collision_point_by_point(
+    Map& map, Layer layer, const Rectangle& collision_box, Entity& entity) {
+
+  const int x1 = collision_box.get_x();
+  const int x2 = x1 + collision_box.get_width() - 1;
+  const int y1 = collision_box.get_y();
+  const int y2 = y1 + collision_box.get_height() - 1;
+
+  bool found_diagonal_wall = false;
+  for (int x = x1; x <= x2; x += 8) {
+    if (map.test_collision_with_ground(layer, x, y1, entity, found_diagonal_wall)
+        || map.test_collision_with_ground(layer, x, y2, entity, found_diagonal_wall)
+        || map.test_collision_with_ground(layer, x + 7, y1, entity, found_diagonal_wall)
+        || map.test_collision_with_ground(layer, x + 7, y2, entity, found_diagonal_wall)) {
+      return true;
+    }
+  }
+
+  for (int y = y1; y <= y2; y += 8) {
+    if (map.test_collision_with_ground(layer, x1, y, entity, found_diagonal_wall)
+        || map.test_collision_with_ground(layer, x2, y, entity, found_diagonal_wall)
+        || map.test_collision_with_ground(layer, x1, y + 7, entity, found_diagonal_wall)
+        || map.test_collision_with_ground(layer, x2, y + 7, entity, found_diagonal_wall)) {
+      return true;
+    }
+  }
+
+  if (found_diagonal_wall) {
+    for (int x = x1; x <= x2; ++x) {
+      if (map.test_collision_with_ground(layer, x, y1, entity, found_diagonal_wall)
+          || map.test_collision_with_ground(layer, x, y2, entity, found_diagonal_wall)) {
+        return true;
+      }
+    }
+
+    for (int y = y1; y <= y2; ++y) {
+      if (map.test_collision_with_ground(layer, x1, y, entity, found_diagonal_wall)
+          || map.test_collision_with_ground(layer, x2, y, entity, found_diagonal_wall)) {
+        return true;
+      }
+    }
+  }
+
+  return map.test_collision_with_entities(layer, collision_box, entity);
+}
+
+/**
+ * \brief Compares Map::test_collision_with_obstacles() with the point by
+ * point check for boxes of a size at positions all over the map.
+ */
+void check_boxes(Map& map, Entity& entity, const Size& size) {
+
+  const Layer layer = entity.get_layer();
+
+  // Points up to 7 pixels past the box are tested: stay inside the map.
+  const int x_max = map.get_width() - size.width - 7;
+  const int y_max = map.get_height() - size.height - 7;
+  for (int y = 0; y <= y_max; y += 3) {
+    for (int x = 0; x <= x_max; x += 3) {
+      const Rectangle box(x, y, size.width, size.height);
+      const bool expected = test_collision_point_by_point(map, layer, box, entity);
+      if (map.test_collision_with_obstacles(layer, box, entity) != expected) {
+        std::ostringstream oss;
+        oss << "Wrong terrain collision for box " << box
+            << ": expected " << expected;
+        Debug::die(oss.str());
+      }
+    }
+  }
+}
+
+/**
+ * \brief Checks boxes of several sizes for an entity.
+ */
+void check_entity(Map& map, Entity& entity) {
+
+  check_boxes(map, entity, Size(16, 16));
+  check_boxes(map, entity, Size(8, 8));
+  check_boxes(map, entity, Size(24, 16));
+  check_boxes(map, entity, Size(13, 10));
+}
+
+}
+
+/**
+ * \brief Checks that the ground bitmaps give the same collisions with the
+ * terrain as the point by point check.
+ *
+ * The map has all kinds of grounds, diagonal walls and dynamic tiles
+ * that modify the ground over tiles.
+ */
+int main(int argc, char** argv) {
+
+  TestEnvironment env(argc, argv);
+  env.start_map("ground_tests");
+  Map& map = env.get_map();
+
+  // The hero: low walls and deep water are obstacles.
+  check_entity(map, env.get_hero());
+
+  // A custom entity with other obstacle grounds.
+  CustomEntity& entity = *env.make_entity<CustomEntity>();
+  entity.set_can_traverse_ground(Ground::HOLE, false);
+  entity.set_can_traverse_ground(Ground::LAVA, false);
+  entity.set_can_traverse_ground(Ground::LOW_WALL, true);
+  check_entity(map, entity);
+
+  // A custom entity that modifies the ground over tiles.
+  CustomEntity& ground_modifier = *env.make_entity<CustomEntity>(Point(48, 45));
+  ground_modifier.set_modified_ground(Ground::DEEP_WATER);
+  check_entity(map, env.get_hero());
+  check_entity(map, entity);
+
+  return 0;
+}
+
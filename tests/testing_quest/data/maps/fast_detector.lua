@@ -0,0 +1,36 @@
+local map = ...
+
+-- A detector moving several pixels per simulated tick must still
+-- notice the hero when it goes through it.
+function map:on_started()
+
+  local hero = map:get_hero()
+  local _, y, layer = hero:get_position()
+  local detector = map:create_custom_entity({
+    x = 16,
+    y = y,
+    layer = layer,
+    width = 8,
+    height = 8,
+    direction = 0,
+  })
+  detector:set_origin(4, 4)
+  detector:set_can_traverse("hero", true)
+
+  local collided = false
+  detector:add_collision_test("overlapping", function(entity, other)
+    if other == hero then
+      collided = true
+    end
+  end)
+
+  -- 4000 pixels per second: 40 pixels per simulated tick.
+  local movement = sol.movement.create("straight")
+  movement:set_speed(4000)
+  movement:set_angle(0)
+  movement:set_max_distance(256)
+  movement:start(detector, function()
+    assert(collided, "The fast detector went through the hero without colliding")
+    sol.main.exit()
+  end)
+end
@@ -0,0 +1,57 @@
+local map = ...
+
+-- A projectile moving several pixels per simulated tick can skip
+-- positions far from other entities, but it must still notice
+-- each entity it reaches from the first pixel that overlaps it.
+function map:on_started()
+
+  local _, _, layer = map:get_hero():get_position()
+  local projectile = map:create_custom_entity({
+    x = 16,
+    y = 48,
+    layer = layer,
+    width = 8,
+    height = 8,
+    direction = 0,
+  })
+  projectile:set_origin(4, 4)
+  projectile:set_can_traverse("custom_entity", true)
+  projectile:set_can_traverse("enemy", true)
+
+  local target = map:create_custom_entity({
+    x = 160,
+    y = 56,
+    layer = layer,
+    width = 16,
+    height = 16,
+    direction = 0,
+  })
+  local enemy = map:create_enemy({
+    breed = "test_enemy",
+    x = 240,
+    y = 56,
+    layer = layer,
+    direction = 0,
+  })
+
+  local reached = {}
+  projectile:add_collision_test("overlapping", function(entity, other)
+    if (other == target or other == enemy) and reached[other] == nil then
+      local x, _, width = entity:get_bounding_box()
+      local other_x = other:get_bounding_box()
+      reached[other] = true
+      assert(x + width == other_x + 1, "The projectile skipped its first position on an entity")
+    end
+  end)
+
+  -- 1000 pixels per second: 10 pixels per simulated tick.
+  local movement = sol.movement.create("straight")
+  movement:set_speed(1000)
+  movement:set_angle(0)
+  movement:set_max_distance(280)
+  movement:start(projectile, function()
+    assert(reached[target], "The projectile went through the custom entity without colliding")
+    assert(reached[enemy], "The projectile went through the enemy without colliding")
+    sol.main.exit()
+  end)
+end
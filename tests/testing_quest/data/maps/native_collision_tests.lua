@@ -0,0 +1,71 @@
+local map = ...
+
+-- Tests custom_entity:add_collision_test() with a table of native conditions.
+function map:on_started()
+
+  local hero = map:get_hero()
+  local _, y, layer = hero:get_position()
+
+  -- A custom entity looking to the west.
+  local watcher = map:create_custom_entity({
+    x = 100,
+    y = y,
+    layer = layer,
+    width = 16,
+    height = 16,
+    direction = 2,
+  })
+
+  local num_near_calls = 0
+  local hero_near = false
+  watcher:add_collision_test({
+    radius = 32,
+    entity_types = { "hero" },
+    batched = true,
+  }, function(entity, entities)
+    assert_equal(entity, watcher)
+    num_near_calls = num_near_calls + 1
+    for _, other in ipairs(entities) do
+      if other == hero then
+        hero_near = true
+      end
+    end
+  end)
+
+  local wrong_type_detected = false
+  watcher:add_collision_test({
+    radius = 100,
+    entity_types = { "enemy" },
+  }, function(entity, other)
+    if other == hero then
+      wrong_type_detected = true
+    end
+  end)
+
+  local behind_detected = false
+  watcher:add_collision_test({
+    radius = 100,
+    facing_cone = math.pi / 2,
+  }, function(entity, other)
+    if other == hero then
+      behind_detected = true
+    end
+  end)
+
+  -- 70 pixels to the east: too far for the first test.
+  hero:set_position(170, y, layer)
+  sol.timer.start(map, 100, function()
+    assert_equal(num_near_calls, 0)
+    assert(not hero_near, "The hero was detected too far")
+
+    -- 20 pixels to the east.
+    hero:set_position(120, y, layer)
+    sol.timer.start(map, 100, function()
+      assert(num_near_calls > 0, "The batched callback was not called")
+      assert(hero_near, "The hero was not in the batch")
+      assert(not wrong_type_detected, "An entity of another type was detected")
+      assert(not behind_detected, "An entity outside the facing cone was detected")
+      sol.main.exit()
+    end)
+  end)
+end
@@ -0,0 +1,45 @@
+local map = ...
+
+-- Changing the origin of an obstacle moves its bounding box:
+-- collision tests must see the new box right away.
+function map:on_started()
+
+  local _, _, layer = map:get_hero():get_position()
+  local obstacle = map:create_custom_entity({
+    x = 160,
+    y = 61,
+    layer = layer,
+    width = 16,
+    height = 16,
+    direction = 0,
+  })
+  obstacle:set_origin(8, 13)
+  obstacle:set_traversable_by(false)
+
+  local entity = map:create_custom_entity({
+    x = 160,
+    y = 101,
+    layer = layer,
+    width = 16,
+    height = 16,
+    direction = 0,
+  })
+  entity:set_origin(8, 13)
+  assert(not entity:test_obstacles(), "Unexpected obstacle")
+
+  -- Move the box of the obstacle 40 pixels down, onto the entity.
+  obstacle:set_origin(8, -27)
+  local _, obstacle_y = obstacle:get_bounding_box()
+  assert_equal(obstacle_y, 88)
+  assert(entity:test_obstacles(), "The obstacle was not found after changing its origin")
+
+  -- And back.
+  obstacle:set_origin(8, 13)
+  assert(not entity:test_obstacles(), "The obstacle was found at its old box")
+
+  -- Changing the origin of the entity itself also moves its box.
+  entity:set_origin(8, 53)
+  assert(entity:test_obstacles(), "The obstacle was not found after changing the origin of the entity")
+
+  sol.main.exit()
+end
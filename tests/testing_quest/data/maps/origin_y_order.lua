@@ -0,0 +1,46 @@
+local map = ...
+
+-- Entities drawn in Y order are sorted by the bottom of their bounding
+-- box, which changes when their origin changes.
+function map:on_started()
+
+  local _, _, layer = map:get_hero():get_position()
+  local drawn = {}
+
+  local function create_entity(name, y)
+    local entity = map:create_custom_entity({
+      name = name,
+      x = 100,
+      y = y,
+      layer = layer,
+      width = 16,
+      height = 16,
+      direction = 0,
+    })
+    entity:set_drawn_in_y_order(true)
+    function entity:on_pre_draw()
+      drawn[#drawn + 1] = name
+    end
+    return entity
+  end
+
+  create_entity("first", 100)
+  local second = create_entity("second", 120)
+
+  sol.timer.start(map, 100, function()
+    assert(#drawn >= 2, "The entities were not drawn")
+    assert_equal(drawn[#drawn - 1], "first")
+    assert_equal(drawn[#drawn], "second")
+
+    -- Move the box of the second entity 40 pixels up, above the first one.
+    second:set_origin(8, 53)
+    drawn = {}
+
+    sol.timer.start(map, 100, function()
+      assert(#drawn >= 2, "The entities were not drawn")
+      assert_equal(drawn[#drawn - 1], "second")
+      assert_equal(drawn[#drawn], "first")
+      sol.main.exit()
+    end)
+  end)
+end
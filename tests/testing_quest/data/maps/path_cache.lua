@@ -0,0 +1,62 @@
+local map = ...
+
+local function get_path_cache_stats()
+
+  local path_cache = map:get_performance_stats().path_cache
+  assert(path_cache ~= nil, "Missing path_cache field")
+  assert_equal(type(path_cache.hits), "number")
+  assert_equal(type(path_cache.misses), "number")
+  assert_equal(path_cache.hits, math.floor(path_cache.hits))
+  assert_equal(path_cache.misses, math.floor(path_cache.misses))
+  return path_cache.hits, path_cache.misses
+end
+
+-- Paths searched by path finding movements are counted in
+-- map:get_performance_stats().path_cache.
+-- Chasers of the same type searching the same path share it.
+function map:on_started()
+
+  local hits, misses = get_path_cache_stats()
+  assert_equal(hits, 0)
+  assert_equal(misses, 0)
+
+  local _, _, layer = map:get_hero():get_position()
+
+  -- Walls all around the 16x16 box at (32, 24), so that the chasers
+  -- stay where they are and search their first path at the same time.
+  local walls = {
+    { x = 24, y = 16, width = 32, height = 8 },
+    { x = 24, y = 40, width = 32, height = 8 },
+    { x = 24, y = 24, width = 8, height = 16 },
+    { x = 48, y = 24, width = 8, height = 16 },
+  }
+  for _, properties in ipairs(walls) do
+    properties.layer = layer
+    properties.direction = 0
+    local wall = map:create_custom_entity(properties)
+    wall:set_origin(0, 0)
+    wall:set_traversable_by(false)
+  end
+
+  local num_chasers = 4
+  for i = 1, num_chasers do
+    local chaser = map:create_custom_entity({
+      x = 40,
+      y = 37,
+      layer = layer,
+      width = 16,
+      height = 16,
+      direction = 0,
+    })
+    local movement = sol.movement.create("path_finding")
+    movement:start(chaser)
+  end
+
+  sol.timer.start(map, 1000, function()
+    -- Only the first chaser searched the path.
+    local hits, misses = get_path_cache_stats()
+    assert_equal(misses, 1)
+    assert_equal(hits, num_chasers - 1)
+    sol.main.exit()
+  end)
+end